@@ -0,0 +1,331 @@
+#include <cstddef>    // import std::size_t
+#include <functional> // import std::multiplies, std::plus
+#include <memory>   // import std::shared_ptr
+#include <optional> // import std::optional
+#include <span>     // import std::span
+#include <string>   // import std::u8string
+#include <type_traits> // import std::is_same_v
+#include <utility>     // import std::pair
+#include <vector>   // import std::vector
+
+#include "harness.hpp" // interface
+
+#include <artccel/core/compute/collection.hpp> // import compute::Compute_collection, compute::Dirty_range
+#include <artccel/core/compute/compute.hpp> // import compute::Compute_constant, compute::Compute_function, compute::Compute_function_constant, compute::Compute_io, compute::Compute_node, compute::Compute_option, compute::Compute_value, compute::Lock_inline, compute::Lock_none, compute::Lock_spin, compute::Lock_striped
+#include <artccel/core/compute/evaluator.hpp> // import compute::Compute_evaluator
+#include <artccel/core/compute/expression.hpp> // import compute::expression_of, compute::f::fuse
+#include <artccel/core/compute/handle.hpp> // import compute::Compute_handle, compute::Compute_variant_handle
+#include <artccel/core/compute/shared_value.hpp> // import compute::Compute_shared_value
+#include <artccel/core/util/enum_bitset.hpp> // import util::Enum_bitset, util::operators::enum_bitset
+
+namespace artccel::core::bench {
+using compute::Compute_collection;
+using compute::Compute_constant;
+using compute::Compute_function;
+using compute::Compute_function_constant;
+using compute::Compute_option;
+using compute::Compute_shared_value;
+using compute::Compute_value;
+// NOLINTNEXTLINE(google-build-using-namespace)
+using namespace util::operators::enum_bitset;
+
+namespace detail {
+using Function = Compute_function<int(int)>;
+
+static auto plus_one(int value) noexcept { return value + 1; }
+static auto scale() noexcept { return 3; }
+// (2 + scale()) * scale(), composed without nodes
+constexpr auto fused{compute::f::fuse(
+    std::multiplies<>{},
+    compute::f::fuse(std::plus<>{},
+                     compute::expression_of<Compute_constant<int, 2>>,
+                     compute::expression_of<
+                         Compute_function_constant<int, scale>>),
+    compute::expression_of<Compute_function_constant<int, scale>>)};
+
+static void value_benchmarks(Runner const &runner) {
+  for (auto const &[suffix, options] :
+       {std::pair{u8"concurrent", util::Enum_bitset{} |
+                                      Compute_option::concurrent},
+        std::pair{u8"snapshot",
+                  util::Enum_bitset{} | Compute_option::snapshot}}) {
+    auto const value{Compute_value<int>::create(options, 0)};
+    for (auto const threads : Runner::thread_counts()) {
+      runner.run(std::u8string{u8"value/read/"} + suffix, threads,
+                 [&value](std::size_t) { return (*value)(); });
+    }
+    for (auto const threads : Runner::thread_counts()) {
+      runner.run(std::u8string{u8"value/write/"} + suffix, threads,
+                 [&value](std::size_t index) {
+                   return *value << static_cast<int>(index);
+                 });
+    }
+  }
+  {
+    auto const value{
+        Compute_value<int>::create(util::Enum_bitset{} | Compute_option::empty,
+                                   0)};
+    runner.run(u8"value/read/empty", 1,
+               [&value](std::size_t) { return (*value)(); });
+    runner.run(u8"value/write/empty", 1, [&value](std::size_t index) {
+      return *value << static_cast<int>(index);
+    });
+  }
+  {
+    auto const value{Compute_value<int>::create(0)};
+    auto const dependent{Function::create(plus_one, value)};
+    runner.run(u8"value/write+invalidate", 1, [&value](std::size_t index) {
+      return *value << static_cast<int>(index);
+    });
+    runner.run(u8"value/write+invalidate+compute", 1,
+               [&value, &dependent](std::size_t index) {
+                 *value << static_cast<int>(index);
+                 return (*dependent)();
+               });
+  }
+}
+
+// reads, writes and computations under a lock policy other than the default
+template <typename Lock>
+static void lock_benchmarks(Runner const &runner, char8_t const *suffix) {
+  auto const value{Compute_value<int, Lock>::create(0)};
+  auto const function{
+      Compute_function<int(int), 0, Lock>::create(plus_one, value)};
+  constexpr auto multithreaded{!std::is_same_v<Lock, compute::Lock_none>};
+  for (auto const threads : Runner::thread_counts()) {
+    if (threads == 1 || multithreaded) {
+      runner.run(std::u8string{u8"value/read/"} + suffix, threads,
+                 [&value](std::size_t) { return (*value)(); });
+    }
+  }
+  runner.run(std::u8string{u8"value/write+invalidate/"} + suffix, 1,
+             [&value](std::size_t index) {
+               return *value << static_cast<int>(index);
+             });
+  for (auto const threads : Runner::thread_counts()) {
+    if (threads == 1 || multithreaded) {
+      runner.run(std::u8string{u8"function/compute/"} + suffix, threads,
+                 [&function](std::size_t) { return (*function)(); });
+    }
+  }
+}
+
+static void function_benchmarks(Runner const &runner) {
+  for (auto const &[suffix, options] :
+       {std::pair{u8"deferred", util::Enum_bitset{} |
+                                    Compute_option::concurrent |
+                                    Compute_option::defer},
+        std::pair{u8"eager",
+                  util::Enum_bitset{} | Compute_option::concurrent}}) {
+    auto const value{Compute_value<int>::create(0)};
+    auto const function{Function::create(options, plus_one, value)};
+    for (auto const threads : Runner::thread_counts()) {
+      runner.run(std::u8string{u8"function/compute/"} + suffix, threads,
+                 [&function](std::size_t) { return (*function)(); });
+    }
+    // deferred computes on the next read, eager within the reset or bind
+    auto const defer{(options & Compute_option::defer).any()};
+    auto const reset_options{defer ? util::Enum_bitset{} | Compute_option::defer
+                                   : util::Enum_bitset{} |
+                                         Compute_option::empty};
+    runner.run(std::u8string{u8"function/reset/"} + suffix, 1,
+               [&function, &reset_options](std::size_t) {
+                 static_cast<void>(function->reset(reset_options));
+                 return (*function)();
+               });
+    runner.run(std::u8string{u8"function/bind/"} + suffix, 1,
+               [&function, &reset_options](std::size_t index) {
+                 static_cast<void>(
+                     function->bind(reset_options, static_cast<int>(index)));
+                 return (*function)();
+               });
+  }
+}
+
+static void clone_benchmarks(Runner const &runner) {
+  for (auto const &[suffix, options] :
+       {std::pair{u8"empty", util::Enum_bitset{} | Compute_option::empty},
+        std::pair{u8"concurrent",
+                  util::Enum_bitset{} | Compute_option::concurrent}}) {
+    auto const value{Compute_value<int>::create(0)};
+    auto const function{Function::create(plus_one, value)};
+    runner.run(std::u8string{u8"value/clone/"} + suffix, 1,
+               [&value, &options](std::size_t) {
+                 return value->clone(options) != nullptr;
+               });
+    runner.run(std::u8string{u8"function/clone/"} + suffix, 1,
+               [&function, &options](std::size_t) {
+                 return function->clone(options) != nullptr;
+               });
+  }
+}
+
+static void collection_benchmarks(Runner const &runner) {
+  constexpr static std::size_t size{std::size_t{1} << 20U};
+  {
+    auto const value{Compute_value<std::vector<float>>::create(
+        std::vector<float>(size))};
+    runner.run(u8"collection/write-one/value", 1,
+               [&value](std::size_t index) {
+                 auto values{(*value)()};
+                 values[index % size] += 1.0F;
+                 static_cast<void>(*value << std::move(values));
+               });
+  }
+  {
+    auto const collection{
+        Compute_collection<float>::create(std::vector<float>(size))};
+    auto since{collection->revision()};
+    auto sum{0.0F};
+    runner.run(
+        u8"collection/write-one/incremental", 1,
+        [&collection, &since, &sum](std::size_t index) {
+          collection->modify(index % size, index % size + 1,
+                             [](std::span<float> values) {
+                               values.front() += 1.0F;
+                             });
+          since = collection->read_changes(
+              since,
+              [&sum](std::span<float const> values,
+                     std::optional<std::vector<compute::Dirty_range>> const
+                         &changes) {
+                for (auto const &range : *changes) {
+                  for (auto index{range.begin_}; index < range.end_; ++index) {
+                    sum += values[index];
+                  }
+                }
+              });
+          return sum;
+        });
+  }
+}
+
+static void expression_benchmarks(Runner const &runner) {
+  auto const node{Compute_function_constant<int, fused>::create()};
+  compute::Compute_io<int> const &io{*node};
+  runner.run(u8"expression/node", 1, [&io](std::size_t) { return io(); });
+  runner.run(u8"expression/fused", 1, [](std::size_t) { return fused(); });
+}
+
+static void handle_benchmarks(Runner const &runner) {
+  constexpr static std::size_t size{64};
+  auto const options{util::Enum_bitset{} | Compute_option::empty};
+  std::vector<std::shared_ptr<Compute_value<int>>> values{};
+  std::vector<std::shared_ptr<Function>> functions{};
+  for (std::size_t index{0}; index < size; ++index) {
+    values.emplace_back(
+        Compute_value<int>::create(options, static_cast<int>(index)));
+    functions.emplace_back(Function::create(plus_one, values.back()));
+  }
+  std::vector<std::shared_ptr<compute::Compute_io<int> const>> nodes{};
+  std::vector<compute::Compute_handle<Compute_value<int>>> handles{};
+  std::vector<compute::Compute_variant_handle<Compute_value<int>, Function>>
+      variants{};
+  for (std::size_t index{0}; index < size; ++index) {
+    nodes.emplace_back(values[index]);
+    nodes.emplace_back(functions[index]);
+    handles.emplace_back(*values[index]);
+    variants.emplace_back(compute::Compute_handle{*values[index]});
+    variants.emplace_back(compute::Compute_handle{*functions[index]});
+  }
+  runner.run(u8"handle/value/virtual", 1, [&values](std::size_t) {
+    auto sum{0};
+    for (auto const &value : values) {
+      compute::Compute_io<int> const &io{*value};
+      sum += io();
+    }
+    return sum;
+  });
+  runner.run(u8"handle/value/static", 1, [&handles](std::size_t) {
+    auto sum{0};
+    for (auto const &handle : handles) {
+      sum += handle();
+    }
+    return sum;
+  });
+  // dispatch cost alone, the concrete operator() being trivial
+  auto const constant{Compute_constant<int, 1>::create()};
+  std::vector<std::shared_ptr<compute::Compute_io<int> const>> constants(
+      size, constant);
+  std::vector<compute::Compute_handle<Compute_constant<int, 1>>>
+      constant_handles(size, compute::Compute_handle{*constant});
+  runner.run(u8"handle/constant/virtual", 1, [&constants](std::size_t) {
+    auto sum{0};
+    for (auto const &node : constants) {
+      sum += (*node)();
+    }
+    return sum;
+  });
+  runner.run(u8"handle/constant/static", 1, [&constant_handles](std::size_t) {
+    auto sum{0};
+    for (auto const &handle : constant_handles) {
+      sum += handle();
+    }
+    return sum;
+  });
+  runner.run(u8"handle/mixed/virtual", 1, [&nodes](std::size_t) {
+    auto sum{0};
+    for (auto const &node : nodes) {
+      sum += (*node)();
+    }
+    return sum;
+  });
+  runner.run(u8"handle/mixed/variant", 1, [&variants](std::size_t) {
+    auto sum{0};
+    for (auto const &variant : variants) {
+      sum += variant();
+    }
+    return sum;
+  });
+}
+
+static void evaluator_benchmarks(Runner const &runner) {
+  constexpr static std::size_t width{64};
+  auto const value{Compute_value<int>::create(0)};
+  std::vector<std::shared_ptr<compute::Compute_node const>> targets{};
+  targets.reserve(width);
+  for (std::size_t index{0}; index != width; ++index) {
+    targets.emplace_back(Function::create(plus_one, value));
+  }
+  for (auto const &[suffix, concurrency] :
+       {std::pair{u8"inline", std::size_t{0}},
+        std::pair{u8"workers", Runner::thread_counts().back()}}) {
+    compute::Compute_evaluator evaluator{concurrency};
+    runner.run(std::u8string{u8"evaluator/fan-out/"} + suffix, 1,
+               [&value, &targets, &evaluator](std::size_t index) {
+                 *value << static_cast<int>(index);
+                 evaluator.evaluate(targets);
+               });
+  }
+}
+
+static void shared_value_benchmarks(Runner const &runner) {
+  constexpr static std::size_t size{std::size_t{1} << 20U};
+  auto const value{Compute_value<std::u8string>::create(
+      std::u8string(size, u8'\0'))};
+  auto const shared{Compute_shared_value<std::u8string>::create(
+      std::u8string(size, u8'\0'))};
+  for (auto const threads : Runner::thread_counts()) {
+    runner.run(u8"shared/read/value", threads,
+               [&value](std::size_t) { return (*value)().size(); });
+    runner.run(u8"shared/read/shared", threads,
+               [&shared](std::size_t) { return (*shared)()->size(); });
+  }
+}
+} // namespace detail
+
+void compute_benchmarks(Runner const &runner) {
+  detail::value_benchmarks(runner);
+  detail::lock_benchmarks<compute::Lock_none>(runner, u8"lock_none");
+  detail::lock_benchmarks<compute::Lock_inline>(runner, u8"lock_inline");
+  detail::lock_benchmarks<compute::Lock_spin>(runner, u8"lock_spin");
+  detail::lock_benchmarks<compute::Lock_striped>(runner, u8"lock_striped");
+  detail::function_benchmarks(runner);
+  detail::clone_benchmarks(runner);
+  detail::collection_benchmarks(runner);
+  detail::expression_benchmarks(runner);
+  detail::handle_benchmarks(runner);
+  detail::evaluator_benchmarks(runner);
+  detail::shared_value_benchmarks(runner);
+}
+} // namespace artccel::core::bench
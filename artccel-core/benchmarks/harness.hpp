@@ -0,0 +1,108 @@
+#pragma once
+#ifndef GUARD_4F8B1E27_6C3D_4A90_B7E5_2D9C0A6F1B83
+#define GUARD_4F8B1E27_6C3D_4A90_B7E5_2D9C0A6F1B83
+
+#include <atomic>      // import std::atomic, std::memory_order_relaxed
+#include <chrono>      // import std::chrono::milliseconds, std::chrono::nanoseconds, std::chrono::steady_clock
+#include <cstddef>     // import std::ptrdiff_t, std::size_t
+#include <latch>       // import std::latch
+#include <string_view> // import std::u8string_view
+#include <thread>      // import std::jthread
+#include <type_traits> // import std::is_void_v
+#include <vector>      // import std::vector
+
+namespace artccel::core::bench {
+class Runner;
+struct Sample;
+
+// counted by the replaced global operator new of the benchmark executable
+extern constinit std::atomic<std::size_t> allocations;
+
+template <typename Type> void keep(Type const &value) noexcept {
+#if defined __GNUC__ || defined __clang__
+  asm volatile("" : : "g"(&value) : "memory");
+#else
+  static Type const *volatile sink{};
+  sink = &value;
+#endif
+}
+
+struct Sample {
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::size_t threads_;
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::size_t iterations_; // per thread
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::chrono::nanoseconds elapsed_;
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::size_t allocations_;
+};
+
+class Runner {
+private:
+  constexpr static auto name_width_{40};
+  std::u8string_view filter_;
+  std::chrono::nanoseconds min_time_{std::chrono::milliseconds{100}};
+
+public:
+  // runs the benchmarks whose name contains filter
+  explicit Runner(std::u8string_view filter) noexcept : filter_{filter} {}
+
+  // 1, 2, 4, ... up to the hardware concurrency, which is always included
+  static auto thread_counts [[nodiscard]] () -> std::vector<std::size_t>;
+  void print_header() const;
+
+  // operation(index) is called iterations times on each of threads threads,
+  // doubling the iterations until the run lasts at least the minimum time
+  template <typename Operation>
+  void run(std::u8string_view name, std::size_t threads,
+           Operation const &operation) const {
+    if (name.find(filter_) == std::u8string_view::npos) {
+      return;
+    }
+    for (std::size_t iterations{1};; iterations *= 2) {
+      if (auto const sample{measure(threads, iterations, operation)};
+          sample.elapsed_ >= min_time_) {
+        report(name, sample);
+        return;
+      }
+    }
+  }
+
+private:
+  void report(std::u8string_view name, Sample const &sample) const;
+  template <typename Operation>
+  static auto measure [[nodiscard]] (std::size_t threads,
+                                     std::size_t iterations,
+                                     Operation const &operation) -> Sample {
+    std::latch start{static_cast<std::ptrdiff_t>(threads) + 1};
+    std::vector<std::jthread> workers{};
+    workers.reserve(threads);
+    for (std::size_t thread{0}; thread < threads; ++thread) {
+      workers.emplace_back([&start, iterations, &operation] {
+        start.arrive_and_wait();
+        for (std::size_t index{0}; index < iterations; ++index) {
+          if constexpr (std::is_void_v<decltype(operation(index))>) {
+            operation(index);
+          } else {
+            keep(operation(index));
+          }
+        }
+      });
+    }
+    // thread creation is excluded from both the time and the allocations
+    auto const allocations_begin{allocations.load(std::memory_order_relaxed)};
+    start.arrive_and_wait();
+    auto const begin{std::chrono::steady_clock::now()};
+    workers.clear();
+    auto const elapsed{std::chrono::steady_clock::now() - begin};
+    return {threads, iterations, elapsed,
+            allocations.load(std::memory_order_relaxed) - allocations_begin};
+  }
+};
+
+void compute_benchmarks(Runner const &runner);
+void queue_benchmarks(Runner const &runner);
+} // namespace artccel::core::bench
+
+#endif
@@ -0,0 +1,150 @@
+#include <algorithm> // import std::max, std::ranges::for_each
+#include <atomic>    // import std::atomic, std::memory_order_relaxed
+#include <chrono>    // import std::chrono::duration
+#include <cstddef>   // import std::size_t
+#include <cstdlib> // import EXIT_SUCCESS, std::aligned_alloc, std::free, std::malloc
+#include <exception> // import std::rethrow_exception
+#include <iomanip>   // import std::left, std::right, std::setprecision, std::setw
+#include <iostream>  // import std::cout, std::fixed, std::flush
+#include <memory>    // import std::make_shared
+#include <new>       // import std::align_val_t, std::bad_alloc
+#include <string_view> // import std::u8string_view
+#include <thread>      // import std::thread::hardware_concurrency
+#include <vector>      // import std::vector
+
+#ifdef _WIN32
+#include <malloc.h> // import ::_aligned_free, ::_aligned_malloc
+#endif
+
+#pragma warning(push)
+#pragma warning(disable : 4626 4820)
+#include <gsl/gsl> // import gsl::final_action, gsl::wzstring, gsl::zstring
+#pragma warning(pop)
+
+#include "harness.hpp" // interface
+
+#include <artccel/core/main_hooks.hpp> // import Main_program, Raw_arguments, artccel::core::f::safe_main
+#include <artccel/core/util/encoding.hpp> // import util::f::utf8_as_utf8_compat, util::literals::encoding::operator""_as_utf8_compat, util::operators::utf8_compat::ostream::operator<<
+
+namespace artccel::core::bench {
+using util::literals::encoding::operator""_as_utf8_compat;
+using util::operators::utf8_compat::ostream::operator<<;
+
+constinit std::atomic<std::size_t> allocations{0};
+
+auto Runner::thread_counts() -> std::vector<std::size_t> {
+  auto const hardware{std::max(std::thread::hardware_concurrency(), 1U)};
+  std::vector<std::size_t> ret{};
+  for (std::size_t threads{1}; threads < hardware; threads *= 2) {
+    ret.emplace_back(threads);
+  }
+  ret.emplace_back(hardware);
+  return ret;
+}
+
+void Runner::print_header() const {
+  std::cout << std::left << std::setw(name_width_)
+            << u8"benchmark"_as_utf8_compat << std::right << std::setw(8)
+            << u8"threads"_as_utf8_compat << std::setw(12)
+            << u8"ns/op"_as_utf8_compat << std::setw(12)
+            << u8"Mop/s"_as_utf8_compat << std::setw(12)
+            << u8"allocs/op"_as_utf8_compat << u8'\n'_as_utf8_compat
+            << std::flush;
+}
+
+void Runner::report(std::u8string_view name, Sample const &sample) const {
+  auto const operations{static_cast<double>(sample.threads_) *
+                        static_cast<double>(sample.iterations_)};
+  auto const elapsed{std::chrono::duration<double>{sample.elapsed_}.count()};
+  // per-thread latency, scaling shows in the aggregate throughput
+  auto const ns_per_op{elapsed * 1e9 /
+                       static_cast<double>(sample.iterations_)};
+  std::cout << std::left << std::setw(name_width_) << name << std::right
+            << std::setw(8) << sample.threads_ << std::fixed
+            << std::setprecision(2) << std::setw(12) << ns_per_op
+            << std::setw(12) << operations / elapsed / 1e6 << std::setw(12)
+            << static_cast<double>(sample.allocations_) / operations
+            << u8'\n'_as_utf8_compat << std::flush;
+}
+
+static auto main_0(Raw_arguments arguments) -> int {
+  auto const program_dtor_excs{std::make_shared<
+      typename Main_program::destructor_exceptions_out_type>()};
+  gsl::final_action const rethrower{[&program_dtor_excs] {
+    std::ranges::for_each(*program_dtor_excs, std::rethrow_exception);
+  }};
+  Main_program const program{arguments, program_dtor_excs};
+  auto const args{program.arguments()};
+  std::u8string_view filter{};
+  if (args.size() > 1) {
+    if (auto const utf8{args[1].utf8()}) {
+      filter = *utf8;
+    }
+  }
+  Runner const runner{filter};
+  runner.print_header();
+  compute_benchmarks(runner);
+  queue_benchmarks(runner);
+  return EXIT_SUCCESS;
+}
+} // namespace artccel::core::bench
+
+// counts every allocation, including those made inside the library unless it
+// is a DLL, which on Windows binds to the operator new of its own runtime
+auto operator new(std::size_t size) -> void * {
+  artccel::core::bench::allocations.fetch_add(1, std::memory_order_relaxed);
+  // NOLINTNEXTLINE(cppcoreguidelines-no-malloc,hicpp-no-malloc)
+  if (auto *const ret{std::malloc(size == 0 ? 1 : size)}) {
+    return ret;
+  }
+  throw std::bad_alloc{};
+}
+void operator delete(void *ptr) noexcept {
+  // NOLINTNEXTLINE(cppcoreguidelines-no-malloc,hicpp-no-malloc)
+  std::free(ptr);
+}
+void operator delete(void *ptr, std::size_t size [[maybe_unused]]) noexcept {
+  // NOLINTNEXTLINE(cppcoreguidelines-no-malloc,hicpp-no-malloc)
+  std::free(ptr);
+}
+auto operator new(std::size_t size, std::align_val_t alignment) -> void * {
+  artccel::core::bench::allocations.fetch_add(1, std::memory_order_relaxed);
+  auto const align{static_cast<std::size_t>(alignment)};
+#ifdef _WIN32
+  auto *const ret{::_aligned_malloc(std::max(size, std::size_t{1}), align)};
+#else
+  // std::aligned_alloc takes multiples of the alignment only
+  // NOLINTNEXTLINE(cppcoreguidelines-no-malloc,hicpp-no-malloc)
+  auto *const ret{std::aligned_alloc(
+      align, (std::max(size, std::size_t{1}) + align - 1) / align * align)};
+#endif
+  if (ret != nullptr) {
+    return ret;
+  }
+  throw std::bad_alloc{};
+}
+void operator delete(void *ptr, std::align_val_t alignment
+                     [[maybe_unused]]) noexcept {
+#ifdef _WIN32
+  ::_aligned_free(ptr);
+#else
+  // NOLINTNEXTLINE(cppcoreguidelines-no-malloc,hicpp-no-malloc)
+  std::free(ptr);
+#endif
+}
+void operator delete(void *ptr, std::size_t size [[maybe_unused]],
+                     std::align_val_t alignment) noexcept {
+  operator delete(ptr, alignment);
+}
+
+#ifdef _WIN32
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wmissing-prototypes"
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays,hicpp-avoid-c-arrays,modernize-avoid-c-arrays)
+auto wmain(int argc, gsl::wzstring argv[]) -> int {
+#pragma clang diagnostic pop
+#else
+auto main(int argc, gsl::zstring argv[]) -> int {
+#endif
+  return artccel::core::f::safe_main(artccel::core::bench::main_0, argc, argv);
+}
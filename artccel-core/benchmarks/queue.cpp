@@ -0,0 +1,97 @@
+#include <array>   // import std::array
+#include <cstddef> // import std::size_t
+#include <thread>  // import std::jthread
+#include <vector>  // import std::vector
+
+#include "harness.hpp" // interface
+
+#include <artccel/core/util/queue.hpp> // import util::Mpmc_queue, util::Spsc_ring
+
+namespace artccel::core::bench {
+namespace detail {
+constexpr std::size_t queue_capacity{1024};
+constexpr std::size_t queue_batch{64};
+// tells a consumer to return, never pushed by a benchmark
+constexpr auto queue_stop{~std::size_t{0}};
+
+// the benchmark threads produce, other threads consume
+static void spsc_benchmarks(Runner const &runner) {
+  {
+    util::Spsc_ring<std::size_t> ring{queue_capacity};
+    std::jthread const consumer{[&ring] {
+      for (auto stop{false}; !stop;) {
+        ring.pop_some(queue_batch, [&stop](std::size_t value) {
+          stop = value == queue_stop;
+        });
+      }
+    }};
+    runner.run(u8"queue/spsc/throughput", 1,
+               [&ring](std::size_t index) { ring.push(index); });
+    std::array<std::size_t, queue_batch> batch{};
+    std::size_t size{0};
+    runner.run(u8"queue/spsc/throughput/batch", 1,
+               [&ring, &batch, &size](std::size_t index) {
+                 batch.at(size++) = index;
+                 if (size == batch.size()) {
+                   ring.push_all(batch);
+                   size = 0;
+                 }
+               });
+    ring.push(queue_stop);
+  }
+  {
+    // round trips through an echoing thread
+    util::Spsc_ring<std::size_t> ping{queue_capacity};
+    util::Spsc_ring<std::size_t> pong{queue_capacity};
+    std::jthread const echo{[&ping, &pong] {
+      for (auto value{ping.pop()}; value != queue_stop; value = ping.pop()) {
+        pong.push(value);
+      }
+    }};
+    runner.run(u8"queue/spsc/latency", 1, [&ping, &pong](std::size_t index) {
+      ping.push(index);
+      return pong.pop();
+    });
+    ping.push(queue_stop);
+  }
+}
+
+static void mpmc_benchmarks(Runner const &runner) {
+  for (auto const threads : Runner::thread_counts()) {
+    // as many consumers as producers
+    util::Mpmc_queue<std::size_t> queue{queue_capacity};
+    std::vector<std::jthread> consumers{};
+    for (std::size_t thread{0}; thread < threads; ++thread) {
+      consumers.emplace_back([&queue] {
+        while (queue.pop() != queue_stop) {
+        }
+      });
+    }
+    runner.run(u8"queue/mpmc/throughput", threads,
+               [&queue](std::size_t index) { queue.push(index); });
+    for (std::size_t thread{0}; thread < threads; ++thread) {
+      queue.push(queue_stop);
+    }
+  }
+  {
+    util::Mpmc_queue<std::size_t> ping{queue_capacity};
+    util::Mpmc_queue<std::size_t> pong{queue_capacity};
+    std::jthread const echo{[&ping, &pong] {
+      for (auto value{ping.pop()}; value != queue_stop; value = ping.pop()) {
+        pong.push(value);
+      }
+    }};
+    runner.run(u8"queue/mpmc/latency", 1, [&ping, &pong](std::size_t index) {
+      ping.push(index);
+      return pong.pop();
+    });
+    ping.push(queue_stop);
+  }
+}
+} // namespace detail
+
+void queue_benchmarks(Runner const &runner) {
+  detail::spsc_benchmarks(runner);
+  detail::mpmc_benchmarks(runner);
+}
+} // namespace artccel::core::bench
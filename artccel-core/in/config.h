@@ -9,4 +9,9 @@
 // NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
 #define ARTCCEL_CORE_VERSION_PATCH /* clang-format off */@PROJECT_VERSION_PATCH@ /* clang-format on */
 
+// collect runtime metrics of compute nodes and instrumented locks, see
+// compute/metrics.hpp and util::Instrumented_lockable
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#cmakedefine01 ARTCCEL_METRICS
+
 #endif
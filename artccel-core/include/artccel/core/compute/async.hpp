@@ -0,0 +1,203 @@
+#pragma once
+#ifndef GUARD_2B7E5F90_D43C_4C18_9A6E_E1F08B3D7C24
+#define GUARD_2B7E5F90_D43C_4C18_9A6E_E1F08B3D7C24
+
+#include <atomic>    // import std::atomic, std::memory_order_acquire, std::memory_order_release
+#include <coroutine> // import std::coroutine_handle, std::suspend_never
+#include <cstddef>   // import std::size_t
+#include <exception> // import std::current_exception, std::exception_ptr, std::rethrow_exception
+#include <memory>    // import std::make_shared, std::shared_ptr, std::unique_ptr
+#include <mutex>     // import std::lock_guard, std::mutex
+#include <optional>  // import std::optional
+#include <type_traits> // import std::conditional_t, std::is_void_v
+#include <utility>     // import std::exchange, std::forward, std::move
+#include <variant>     // import std::monostate
+#include <vector>      // import std::vector
+
+#include <artccel/core/export.h> // import ARTCCEL_CORE_EXPORT
+
+namespace artccel::core::compute {
+class ARTCCEL_CORE_EXPORT Compute_scheduler;
+template <typename Ret> class Compute_future;
+
+class Compute_scheduler {
+private:
+  class Impl;
+#pragma warning(suppress : 4251)
+  std::unique_ptr<Impl> impl_;
+
+public:
+  // uses std::thread::hardware_concurrency() workers
+  Compute_scheduler();
+  explicit Compute_scheduler(std::size_t concurrency);
+  // resumes the coroutines still queued before joining the workers
+  ~Compute_scheduler() noexcept;
+  Compute_scheduler(Compute_scheduler const &) = delete;
+  auto operator=(Compute_scheduler const &) = delete;
+  Compute_scheduler(Compute_scheduler &&) = delete;
+  auto operator=(Compute_scheduler &&) = delete;
+
+  auto concurrency [[nodiscard]] () const noexcept -> std::size_t;
+  void post(std::coroutine_handle<> handle);
+  // co_await moves the awaiting coroutine onto a worker
+  auto schedule [[nodiscard]] () noexcept {
+    struct Awaiter {
+      Compute_scheduler *scheduler_;
+
+      constexpr auto await_ready [[nodiscard]] () const noexcept {
+        return false;
+      }
+      void await_suspend(std::coroutine_handle<> handle) const {
+        scheduler_->post(handle);
+      }
+      constexpr void await_resume() const noexcept {}
+    };
+    return Awaiter{this};
+  }
+};
+
+namespace detail {
+template <typename Ret> class Future_state {
+public:
+  using value_type =
+      std::conditional_t<std::is_void_v<Ret>, std::monostate, Ret>;
+
+private:
+  std::mutex mutex_{};
+  std::vector<std::coroutine_handle<>> continuations_{};
+  std::optional<value_type> value_{};
+  std::exception_ptr exception_{};
+  std::atomic<bool> ready_{false};
+
+public:
+  auto ready [[nodiscard]] () const noexcept {
+    return ready_.load(std::memory_order_acquire);
+  }
+  // returns false if already ready, then the caller resumes itself
+  auto add_continuation [[nodiscard]] (std::coroutine_handle<> handle) {
+    std::lock_guard const guard{mutex_};
+    if (ready()) {
+      return false;
+    }
+    continuations_.emplace_back(handle);
+    return true;
+  }
+  void set_value(value_type value) {
+    value_.emplace(std::move(value));
+    complete();
+  }
+  void set_exception(std::exception_ptr exception) noexcept {
+    exception_ = std::move(exception);
+    complete();
+  }
+  auto get [[nodiscard]] () const -> value_type const & {
+    ready_.wait(false, std::memory_order_acquire);
+    if (exception_) {
+      std::rethrow_exception(exception_);
+    }
+    return *value_;
+  }
+
+private:
+  void complete() noexcept {
+    auto continuations{[this] {
+      std::lock_guard const guard{mutex_};
+      ready_.store(true, std::memory_order_release);
+      return std::exchange(continuations_, {});
+    }()};
+    ready_.notify_all();
+    for (auto const continuation : continuations) {
+      continuation.resume();
+    }
+  }
+#pragma warning(suppress : 4820)
+};
+
+template <typename Ret> class Future_promise_base {
+protected:
+  std::shared_ptr<Future_state<Ret>> state_{
+      std::make_shared<Future_state<Ret>>()};
+
+public:
+  auto get_return_object [[nodiscard]] () {
+    return Compute_future<Ret>{state_};
+  }
+  // eager: runs until the first suspension point on the calling thread
+  constexpr auto initial_suspend [[nodiscard]] () const noexcept {
+    return std::suspend_never{};
+  }
+  // the frame destroys itself, results live on in the shared state
+  constexpr auto final_suspend [[nodiscard]] () const noexcept {
+    return std::suspend_never{};
+  }
+  void unhandled_exception() noexcept {
+    state_->set_exception(std::current_exception());
+  }
+};
+template <typename Ret>
+class Future_promise : public Future_promise_base<Ret> {
+public:
+  void return_value(Ret value) { this->state_->set_value(std::move(value)); }
+};
+template <> class Future_promise<void> : public Future_promise_base<void> {
+public:
+  void return_void() { this->state_->set_value({}); }
+};
+} // namespace detail
+
+// shared result of an asynchronous evaluation, both awaitable and blocking
+template <typename Ret> class Compute_future {
+public:
+  using promise_type = detail::Future_promise<Ret>;
+
+private:
+  std::shared_ptr<detail::Future_state<Ret>> state_;
+
+public:
+  explicit Compute_future(std::shared_ptr<detail::Future_state<Ret>> state)
+      : state_{std::move(state)} {}
+  // already completed with value
+  template <typename... Args>
+  requires(!std::is_void_v<Ret> && sizeof...(Args) == 1) ||
+          (std::is_void_v<Ret> && sizeof...(Args) == 0)
+  static auto ready [[nodiscard]] (Args &&...args) {
+    auto state{std::make_shared<detail::Future_state<Ret>>()};
+    state->set_value(typename detail::Future_state<Ret>::value_type{
+        std::forward<Args>(args)...});
+    return Compute_future{std::move(state)};
+  }
+
+  auto is_ready [[nodiscard]] () const noexcept { return state_->ready(); }
+  // blocks until completed, rethrowing its exception if any
+  auto get [[nodiscard]] () const -> decltype(auto) {
+    if constexpr (std::is_void_v<Ret>) {
+      static_cast<void>(state_->get());
+    } else {
+      return state_->get();
+    }
+  }
+
+  auto operator co_await [[nodiscard]] () const noexcept {
+    struct Awaiter {
+      std::shared_ptr<detail::Future_state<Ret>> state_;
+
+      auto await_ready [[nodiscard]] () const noexcept {
+        return state_->ready();
+      }
+      auto await_suspend(std::coroutine_handle<> handle) const {
+        return state_->add_continuation(handle);
+      }
+      auto await_resume() const -> Ret {
+        if constexpr (std::is_void_v<Ret>) {
+          static_cast<void>(state_->get());
+        } else {
+          return state_->get();
+        }
+      }
+    };
+    return Awaiter{state_};
+  }
+};
+} // namespace artccel::core::compute
+
+#endif
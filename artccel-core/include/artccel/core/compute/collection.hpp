@@ -0,0 +1,275 @@
+#pragma once
+#ifndef GUARD_A3C85E1F_7D29_4B64_9F0A_C2E6187B5D34
+#define GUARD_A3C85E1F_7D29_4B64_9F0A_C2E6187B5D34
+
+#include <algorithm>  // import std::ranges::copy
+#include <cassert>    // import assert
+#include <concepts>   // import std::copyable, std::invocable
+#include <cstddef>    // import std::size_t
+#include <cstdint>    // import std::uint_fast64_t
+#include <functional> // import std::invoke
+#include <memory>     // import std::unique_ptr
+#include <mutex>      // import std::scoped_lock
+#include <optional>   // import std::nullopt, std::optional
+#include <shared_mutex> // import std::shared_mutex
+#include <span>         // import std::span
+#include <tuple>        // import std::tuple
+#include <type_traits>  // import std::remove_cv_t
+#include <utility>      // import std::exchange, std::forward, std::move, std::swap
+#include <vector>       // import std::vector
+
+#pragma warning(push)
+#pragma warning(disable : 4626 4820)
+#include <gsl/gsl> // import gsl::finally, gsl::owner
+#pragma warning(pop)
+
+#include "../util/bitset_extras.hpp" // import util::Check_bitset
+#include "../util/clone.hpp" // import util::Cloneable_bases, util::Cloneable_impl
+#include "../util/concurrent.hpp"    // import util::Nullable_lockable
+#include "../util/enum_bitset.hpp" // import util::Enum_bitset, util::operators::enum_bitset
+#include "compute.hpp" // import Compute_in, Compute_option, Compute_options, detail::make_mutex, detail::make_node
+#include <artccel/core/export.h> // import ARTCCEL_CORE_EXPORT
+
+namespace artccel::core {
+namespace compute {
+struct Dirty_range;
+template <std::copyable Element> class Compute_collection;
+} // namespace compute
+
+namespace util {
+template <std::copyable Element>
+struct Cloneable_bases<compute::Compute_collection<Element>> {
+  using self_type = compute::Compute_collection<Element>;
+  using type = std::tuple<compute::Compute_in<self_type, std::vector<Element>>>;
+  using impl_type = std::tuple<>;
+};
+} // namespace util
+
+namespace compute {
+// half-open index range [begin_, end_)
+struct Dirty_range {
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::size_t begin_;
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::size_t end_;
+
+  friend constexpr auto operator==(Dirty_range const &left,
+                                   Dirty_range const &right) noexcept
+      -> bool = default;
+};
+
+namespace detail {
+// sorts by begin_ and merges overlapping or adjacent ranges
+ARTCCEL_CORE_EXPORT void coalesce(std::vector<Dirty_range> &ranges);
+} // namespace detail
+
+// vector-valued node whose writes may touch a slice only, recording which
+// index ranges changed so that dependents can recompute incrementally
+template <std::copyable Element>
+// NOLINTNEXTLINE(fuchsia-multiple-inheritance)
+class Compute_collection
+    : public virtual util::Cloneable_impl<Compute_collection<Element>>,
+      public Compute_in<Compute_collection<Element>, std::vector<Element>> {
+  friend util::Cloneable_impl<Compute_collection>;
+
+private:
+  enum struct Friend : bool {};
+
+public:
+  using return_type = typename Compute_collection::return_type;
+  using revision_type = std::uint_fast64_t;
+  constexpr static std::size_t default_log_capacity{64};
+  template <typename... Args>
+  explicit Compute_collection(
+      Friend tag [[maybe_unused]],
+      Args &&...args) noexcept(noexcept(Compute_collection(std::
+                                                               forward<Args>(
+                                                                   args)...)))
+      : Compute_collection(std::forward<Args>(args)...) {}
+
+private:
+  util::Nullable_lockable</* mutable */ std::shared_mutex> const mutex_;
+  std::vector<Element> values_;
+  // ring of the latest changes, revision r at index r % log_.size()
+  std::vector<Dirty_range> log_;
+  revision_type revision_{0};
+  // changes up to this revision are unknown, e.g. after a resize
+  revision_type known_since_{0};
+
+protected:
+  explicit Compute_collection(std::vector<Element> values)
+      : Compute_collection(util::Enum_bitset{} | Compute_option::concurrent,
+                           std::move(values)) {}
+  explicit Compute_collection(Compute_options const &options,
+                              std::vector<Element> values,
+                              std::size_t log_capacity = default_log_capacity)
+      : mutex_{detail::make_mutex(
+            (options & Compute_option::concurrent).any())},
+        values_{std::move(values)}, log_(log_capacity) {
+    constexpr static util::Check_bitset valid_options{
+        Compute_option::concurrent};
+    valid_options(options);
+  }
+
+private:
+  void record(Dirty_range range) noexcept {
+    ++revision_;
+    if (log_.empty()) {
+      known_since_ = revision_;
+      return;
+    }
+    log_[revision_ % log_.size()] = range;
+  }
+  auto changes_since [[nodiscard]] (revision_type since) const
+      -> std::optional<std::vector<Dirty_range>> {
+    if (since < known_since_ || since > revision_ ||
+        revision_ - since > log_.size()) {
+      return std::nullopt;
+    }
+    std::vector<Dirty_range> ret{};
+    ret.reserve(revision_ - since);
+    for (auto revision{since + 1}; revision <= revision_; ++revision) {
+      ret.emplace_back(log_[revision % log_.size()]);
+    }
+    detail::coalesce(ret);
+    return ret;
+  }
+
+public:
+  template <typename... Args>
+  static auto create [[nodiscard]] (Args &&...args) {
+    return detail::make_node<Compute_collection>(Friend{},
+                                                std::forward<Args>(args)...);
+  }
+
+  // copies the whole collection, prefer read or read_changes
+  auto operator() [[nodiscard]] () const -> std::vector<Element> override {
+    this->metrics_evaluated();
+    auto const guard{this->shared_guard(mutex_)};
+    return values_;
+  }
+  auto size [[nodiscard]] () const -> std::size_t {
+    auto const guard{this->shared_guard(mutex_)};
+    return values_.size();
+  }
+  auto revision [[nodiscard]] () const -> revision_type {
+    auto const guard{this->shared_guard(mutex_)};
+    return revision_;
+  }
+  template <std::invocable<std::span<Element const>> Func>
+  auto read(Func &&func) const -> decltype(auto) {
+    this->metrics_evaluated();
+    auto const guard{this->shared_guard(mutex_)};
+    return std::invoke(std::forward<Func>(func),
+                       std::span<Element const>{values_});
+  }
+  // calls func(values, changes) under the read lock, changes being the merged
+  // ranges written after revision since, or std::nullopt if those are no
+  // longer known and everything must be treated as changed; returns the
+  // revision to pass next time
+  template <std::invocable<std::span<Element const>,
+                           std::optional<std::vector<Dirty_range>> const &>
+                Func>
+  auto read_changes(revision_type since, Func &&func) const -> revision_type {
+    this->metrics_evaluated();
+    auto const guard{this->shared_guard(mutex_)};
+    std::invoke(std::forward<Func>(func), std::span<Element const>{values_},
+                changes_since(since));
+    return revision_;
+  }
+
+  // copies values over [offset, offset + values.size())
+  void assign(std::size_t offset, std::span<Element const> values) {
+    {
+      auto const guard{this->exclusive_guard(mutex_)};
+      assert(offset <= values_.size() &&
+             values.size() <= values_.size() - offset &&
+             u8"Range is out of bounds");
+      std::ranges::copy(values,
+                        std::span<Element>{values_}.subspan(offset).begin());
+      record({offset, offset + values.size()});
+    }
+    this->invalidate_dependents();
+  }
+  // calls func(std::span<Element>) to modify [begin, end) in place; if func
+  // throws, the range still counts as changed, as it may be in part
+  template <std::invocable<std::span<Element>> Func>
+  void modify(std::size_t begin, std::size_t end, Func &&func) {
+    auto const invalidate{
+        gsl::finally([this] { this->invalidate_dependents(); })};
+    auto const guard{this->exclusive_guard(mutex_)};
+    assert(begin <= end && end <= values_.size() &&
+           u8"Range is out of bounds");
+    auto const finally{
+        gsl::finally([this, begin, end] { record({begin, end}); })};
+    std::invoke(std::forward<Func>(func),
+                std::span<Element>{values_}.subspan(begin, end - begin));
+  }
+  friend auto operator<<(Compute_collection &left, std::vector<Element> values)
+      -> std::vector<Element> {
+    auto ret{[&left, &values] {
+      auto const guard{left.exclusive_guard(left.mutex_)};
+      if (values.size() == left.values_.size()) {
+        left.record({0, values.size()});
+      } else {
+        left.known_since_ = ++left.revision_;
+      }
+      return std::exchange(left.values_, std::move(values));
+    }()};
+    left.invalidate_dependents();
+    return ret;
+  }
+
+  using util::Cloneable_impl<Compute_collection>::clone;
+  auto clone [[nodiscard]] (Compute_options const &options) const {
+    return std::unique_ptr<Compute_collection>{clone_impl_options(options)};
+  }
+  ~Compute_collection() noexcept override = default;
+
+protected:
+  void swap(Compute_collection &other) noexcept {
+    std::scoped_lock const guard{mutex_, other.mutex_};
+    using std::swap;
+    swap(values_, other.values_);
+    swap(log_, other.log_);
+    // revisions stay monotonic, the history of either is meaningless now
+    known_since_ = ++revision_;
+    other.known_since_ = ++other.revision_;
+  }
+  Compute_collection(Compute_collection const &other)
+      : Compute_collection(other,
+                           detail::make_mutex(bool{other.mutex_.value_})) {}
+  auto operator=(Compute_collection const &right) -> Compute_collection & {
+    Compute_collection{right}.swap(*this);
+    return *this;
+  }
+  Compute_collection(Compute_collection &&other) noexcept
+      : mutex_{detail::make_mutex(bool{other.mutex_.value_})},
+        values_{std::move(other.values_)}, log_(other.log_.size()) {}
+  auto operator=(Compute_collection &&right) noexcept
+      -> Compute_collection & {
+    Compute_collection{std::move(right)}.swap(*this);
+    return *this;
+  }
+
+  explicit Compute_collection(Compute_collection const &other,
+                              std::remove_cv_t<decltype(mutex_)> &&mutex)
+      : mutex_{std::move(mutex)}, values_{other.read([](auto values) {
+          return std::vector<Element>(values.begin(), values.end());
+        })},
+        log_(other.log_.size()) {}
+
+private:
+  auto clone_impl_options [[nodiscard]] (Compute_options const &options) const
+      -> gsl::owner<Compute_collection *> override {
+    Compute_collection::clone_valid_options(options);
+    return new Compute_collection{
+        *this,
+        detail::make_mutex((options & Compute_option::concurrent).any())};
+  }
+#pragma warning(suppress : 4250)
+};
+} // namespace compute
+} // namespace artccel::core
+
+#endif
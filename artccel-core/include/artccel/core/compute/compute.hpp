@@ -2,29 +2,49 @@
 #ifndef GUARD_678654BB_B008_4FDC_84E6_9F0BC12F324F
 #define GUARD_678654BB_B008_4FDC_84E6_9F0BC12F324F
 
-#include <concepts>   // import std::copyable, std::derived_from
-#include <cstdint>    // import std::uint_fast8_t
-#include <functional> // import std::function, std::invoke
-#include <memory> // import std::enable_shared_from_this, std::make_shared, std::make_unique, std::unique_ptr, std::weak_ptr
-#include <mutex>  // import std::lock_guard, std::scoped_lock
-#include <optional>     // import std::nullopt, std::optional
-#include <shared_mutex> // import std::shared_lock, std::shared_mutex
-#include <tuple>        // import std::tuple
-#include <type_traits>  // import std::remove_cv_t
-#include <utility> // import std::exchange, std::forward, std::move, std::swap
+#include <array>  // import std::array
+#include <atomic> // import std::atomic, std::memory_order_acq_rel, std::memory_order_acquire, std::memory_order_relaxed, std::memory_order_release, std::memory_order_seq_cst
+#include <chrono> // import std::chrono::time_point
+#include <concepts> // import std::convertible_to, std::copyable, std::derived_from, std::invocable
+#include <condition_variable> // import std::condition_variable
+#include <cstddef>            // import std::max_align_t, std::size_t
+#include <cstdint> // import std::uint_fast32_t, std::uint_fast64_t, std::uint_fast8_t, std::uintptr_t
+#include <functional>         // import std::function, std::invoke
+#include <memory> // import std::addressof, std::allocate_shared, std::enable_shared_from_this, std::make_shared, std::make_unique, std::shared_ptr, std::unique_ptr, std::weak_ptr
+#include <memory_resource> // import std::pmr::memory_resource, std::pmr::polymorphic_allocator
+#include <mutex> // import std::adopt_lock, std::lock_guard, std::mutex, std::scoped_lock, std::try_to_lock, std::unique_lock
+#include <new>      // import std::align_val_t
+#include <optional> // import std::nullopt, std::optional
+#include <shared_mutex> // import std::shared_lock, std::shared_mutex, std::shared_timed_mutex
+#include <span>         // import std::span
+#include <stop_token> // import std::stop_source, std::stop_token
+#include <string_view> // import std::u8string_view
+#include <thread>     // import std::this_thread::yield
+#include <tuple> // import std::apply, std::make_from_tuple, std::tuple
+#include <type_traits> // import std::conditional_t, std::invoke_result_t, std::remove_cv_t, std::remove_cvref_t
+#include <utility> // import std::exchange, std::forward, std::move, std::pair, std::swap
+#include <vector>  // import std::vector
 
 #pragma warning(push)
 #pragma warning(disable : 4626 4820)
-#include <gsl/gsl> // import gsl::owner
+#include <gsl/gsl> // import gsl::finally, gsl::owner
 #pragma warning(pop)
 
 #include "../util/bitset_extras.hpp" // import util::Check_bitset
 #include "../util/clone.hpp" // import util::Cloneable, util::Cloneable_bases, util::Cloneable_impl
-#include "../util/concepts_extras.hpp" // import util::Invocable_r
-#include "../util/concurrent.hpp" // import util::Nullable_lockable, util::Semiregular_once_flag
+#include "../util/concepts_extras.hpp" // import util::Hashable, util::Invocable_r
+#include "../util/concurrent.hpp" // import util::Nullable_lockable, util::Result_cell, util::Semiregular_once_flag, util::Snapshot_cell, util::Striped_shared_mutex, util::f::make_lockable
+#include "../util/conversions.hpp" // import util::f::int_unsigned_cast
 #include "../util/enum_bitset.hpp" // import util::Bitset_of, util::Enum_bitset, util::empty_bitmask, util::f::next_bitmask, util::operators::enum_bitset
-#include "../util/polyfill.hpp"    // import util::f::unreachable
+#include "../util/inline_function.hpp" // import util::Inline_function
+#include "../util/memo_cache.hpp" // import util::Cache_stats, util::Clock_cache, util::Tuple_hash
+#include "../util/polyfill.hpp" // import util::f::to_underlying, util::f::unreachable
+#include "../util/reflect.hpp"  // import util::f::type_name
 #include "../util/utility_extras.hpp" // import util::f::forward_apply
+#include "async.hpp" // import Compute_future, Compute_scheduler
+#include "metrics.hpp" // import detail::Metrics
+#include "trace.hpp"   // import detail::Trace_scope
+#include <artccel/core/export.h>      // import ARTCCEL_CORE_EXPORT
 
 namespace artccel::core {
 namespace compute {
@@ -32,8 +52,11 @@ enum struct Compute_option : std::uint_fast8_t {
   empty = util::empty_bitmask,
   concurrent = util::f::next_bitmask(empty),
   defer = util::f::next_bitmask(concurrent),
+  snapshot = util::f::next_bitmask(defer),
+  async = util::f::next_bitmask(snapshot),
 };
 using Compute_options = util::Bitset_of<Compute_option>;
+class ARTCCEL_CORE_EXPORT Compute_node;
 template <std::copyable Ret> class Compute_io;
 template <typename Derived, std::copyable Ret> class Compute_in;
 template <std::copyable Ret> class Compute_out;
@@ -41,8 +64,21 @@ template <std::copyable Ret, Ret Val> class Compute_constant;
 template <std::copyable Ret, auto Func>
 requires util::Invocable_r<decltype(Func), Ret>
 class Compute_function_constant;
-template <std::copyable Ret> class Compute_value;
-template <typename Signature> class Compute_function;
+struct Lock_nullable;
+struct Lock_none;
+struct Lock_inline;
+struct Lock_spin;
+struct Lock_striped;
+template <typename Policy = Lock_nullable> struct Lock_instrumented;
+template <std::copyable Ret, typename Lock = Lock_nullable> class Compute_value;
+// with a zero Capacity, the callable and the bound arguments are heap
+// allocated; otherwise each is stored inline in Capacity bytes
+template <typename Signature, std::size_t Capacity = 0,
+          typename Lock = Lock_nullable>
+class Compute_function;
+class ARTCCEL_CORE_EXPORT Compute_transaction;
+class ARTCCEL_CORE_EXPORT Compute_snapshot;
+class ARTCCEL_CORE_EXPORT Compute_snapshot_writer;
 enum struct Reset_t : bool {};
 enum struct Extract_t : bool {};
 enum struct Out_t : bool {};
@@ -54,6 +90,221 @@ concept Compute_in_c =
 template <typename Type>
 concept Compute_in_any_c =
     Compute_in_c<Type, typename std::remove_cv_t<Type>::return_type>;
+template <typename Type>
+concept Compute_in_ptr_c = requires(Type const &ptr) {
+  requires Compute_in_any_c<
+      typename std::remove_cvref_t<Type>::element_type>;
+  { ptr } -> std::convertible_to<std::shared_ptr<
+      typename std::remove_cvref_t<Type>::element_type const>>;
+};
+template <typename Arg, typename Param>
+concept Compute_dependency_c =
+    Compute_in_ptr_c<Arg> && !std::convertible_to<Arg, Param>;
+
+template <typename Arg, typename Param> struct Compute_argument {
+  using type = Arg;
+};
+template <typename Arg, typename Param>
+requires Compute_dependency_c<Arg, Param>
+struct Compute_argument<Arg, Param> {
+  using type =
+      typename std::remove_cvref_t<Arg>::element_type::return_type;
+};
+template <typename Arg, typename Param>
+using Compute_argument_t = typename Compute_argument<Arg, Param>::type;
+
+namespace detail {
+template <typename Func, typename Signature, typename... Args>
+constexpr inline auto compute_bindable_v{false};
+template <typename Func, typename Ret, typename... Params, typename... Args>
+requires(sizeof...(Params) == sizeof...(Args))
+constexpr inline auto compute_bindable_v<Func, Ret(Params...), Args...>{
+    util::Invocable_r<Func, Ret, Compute_argument_t<Args, Params>...>};
+} // namespace detail
+
+template <typename Func, typename Signature, typename... Args>
+concept Compute_bindable_c =
+    detail::compute_bindable_v<Func, Signature, Args...>;
+
+namespace detail {
+// Compute_transaction sequences commits per stripe of their targets, so that
+// readers of other values never wait on them; a sequence counts the commits
+// applying their writes in the low bits, those invalidating dependents
+// afterwards in the middle ones and those applied in the high ones
+constexpr inline std::size_t commit_stripes{32};
+constexpr inline std::uint_fast64_t commit_applying{1};
+constexpr inline std::uint_fast64_t commit_invalidating{
+    std::uint_fast64_t{1} << 16U};
+constexpr inline std::uint_fast64_t commit_applied{std::uint_fast64_t{1}
+                                                   << 32U};
+constexpr inline std::uint_fast64_t commit_counter_mask{0xFFFF};
+ARTCCEL_CORE_EXPORT auto commit_sequence
+    [[nodiscard]] (std::size_t stripe) noexcept
+    -> std::atomic<std::uint_fast64_t> &;
+inline auto commit_stripe
+    [[nodiscard]] (Compute_node const &target) noexcept -> std::size_t {
+  // Fibonacci hashing, nodes are at least as aligned as std::max_align_t
+  constexpr static std::uint_fast64_t multiplier{0x9E3779B97F4A7C15};
+  auto const address{
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      static_cast<std::uint_fast64_t>(reinterpret_cast<std::uintptr_t>(
+          std::addressof(target))) /
+      alignof(std::max_align_t)};
+  return static_cast<std::size_t>((address * multiplier) >> 32U) %
+         commit_stripes;
+}
+// set by Compute_graph while it creates or clones nodes on this thread
+ARTCCEL_CORE_EXPORT auto graph_resource [[nodiscard]] () noexcept
+    -> std::pmr::memory_resource *&;
+
+template <typename Node, typename... Args>
+auto make_node [[nodiscard]] (Args &&...args) {
+  if (auto *const resource{graph_resource()}) {
+    return std::allocate_shared<Node>(
+        std::pmr::polymorphic_allocator<>{resource},
+        std::forward<Args>(args)...);
+  }
+  return std::make_shared<Node>(std::forward<Args>(args)...);
+}
+template <typename Mutex = std::shared_mutex>
+auto make_mutex [[nodiscard]] (bool concurrent) ->
+    typename util::Nullable_lockable<Mutex>::type {
+  if (!concurrent) {
+    return nullptr;
+  }
+  return util::f::make_lockable<Mutex>(graph_resource());
+}
+// thrown through the once flag of a Compute_function computation whose
+// result went stale while computing, leaving the flag unset
+struct Compute_cancelled {};
+// thrown by f::read_consistent within a Compute_function computation instead
+// of waiting for a commit invalidating dependents, which may be waiting for
+// the lock the computation holds; unwinds every computation on the thread,
+// the outermost one waits for the sequence to move on without the lock and
+// retries
+struct Compute_retry {
+  std::size_t stripe_;
+  std::uint_fast64_t sequence_;
+};
+// set by Compute_function while it computes on this thread
+ARTCCEL_CORE_EXPORT auto running_stop_token [[nodiscard]] () noexcept
+    -> std::stop_token &;
+// the number of Compute_function computations running on this thread
+ARTCCEL_CORE_EXPORT auto computing [[nodiscard]] () noexcept -> std::size_t &;
+
+// the sequences of the stripes of the nodes read by f::read_consistent
+class ARTCCEL_CORE_EXPORT Commit_reads {
+private:
+  std::uint_fast32_t stripes_{0};
+  std::array<std::uint_fast64_t, commit_stripes> sequences_{};
+
+public:
+  // waits while a commit applies to the stripe of a node; while one
+  // invalidates the dependents of one, throws Compute_retry within a
+  // Compute_function computation, or else waits
+  explicit Commit_reads(std::span<Compute_node const *const> nodes);
+  auto consistent [[nodiscard]] () const noexcept -> bool;
+};
+// call with the sequence of the stripe of a value before reading it, so that
+// a reader seeing one write of a commit sees all of them
+inline void
+await_applied(std::atomic<std::uint_fast64_t> const &sequence) noexcept {
+  for (auto current{sequence.load(std::memory_order_seq_cst)};
+       (current & commit_counter_mask) != 0;
+       current = sequence.load(std::memory_order_seq_cst)) {
+    sequence.wait(current, std::memory_order_seq_cst);
+  }
+}
+// call holding no lock of a node, after a Compute_retry
+ARTCCEL_CORE_EXPORT void await_commit(Compute_retry const &retry) noexcept;
+} // namespace detail
+
+// how Compute_value and Compute_function lock, fixed at compile time; only
+// with Lock_nullable does Compute_option::concurrent decide whether to lock,
+// the others lock always or never, whatever the options
+struct Lock_nullable {
+  // a separately allocated mutex, null unless concurrent
+  template <typename Mutex> using type = util::Nullable_lockable<Mutex>;
+  template <typename Mutex>
+  static auto make [[nodiscard]] (bool concurrent) -> type<Mutex> {
+    return detail::make_mutex<Mutex>(concurrent);
+  }
+};
+struct Lock_none {
+  // for graphs used by one thread only, compiles to no lock code
+  template <typename Mutex> using type = util::Null_lockable;
+  template <typename Mutex>
+  static constexpr auto make
+      [[nodiscard]] (bool concurrent [[maybe_unused]]) noexcept {
+    return type<Mutex>{};
+  }
+};
+struct Lock_inline {
+  // the mutex next to the data it guards
+  template <typename Mutex> using type = util::Inline_lockable<Mutex>;
+  template <typename Mutex>
+  static auto make [[nodiscard]] (bool concurrent [[maybe_unused]]) {
+    return type<Mutex>{};
+  }
+};
+struct Lock_spin {
+  // like Lock_inline with a spin lock, for short uncontended sections
+  template <typename Mutex>
+  using type = util::Inline_lockable<util::Spin_shared_mutex>;
+  template <typename Mutex>
+  static auto make [[nodiscard]] (bool concurrent [[maybe_unused]]) noexcept {
+    return type<Mutex>{};
+  }
+};
+struct Lock_striped {
+  // like Lock_nullable with util::Striped_shared_mutex, for read-mostly nodes
+  // read from many cores at once
+  template <typename Mutex>
+  using type = util::Nullable_lockable<util::Striped_shared_mutex>;
+  template <typename Mutex>
+  static auto make [[nodiscard]] (bool concurrent) -> type<Mutex> {
+    return detail::make_mutex<util::Striped_shared_mutex>(concurrent);
+  }
+};
+template <typename Policy> struct Lock_instrumented {
+  // the mutex of Policy, Lock_nullable or Lock_inline, profiled with
+  // ARTCCEL_METRICS, see util::Instrumented_lockable
+  template <typename Mutex>
+  using type =
+      typename Policy::template type<util::Instrumented_lockable<Mutex>>;
+  template <typename Mutex>
+  static auto make [[nodiscard]] (bool concurrent) -> type<Mutex> {
+    return Policy::template make<util::Instrumented_lockable<Mutex>>(
+        concurrent);
+  }
+};
+
+namespace f {
+// stop is requested once a reset, bind or invalidation makes the result of
+// the Compute_function computation running on this thread stale, so that it
+// may return early, its result being discarded; no stop is possible outside
+// of a computation
+inline auto current_stop_token [[nodiscard]] () noexcept -> std::stop_token {
+  return detail::running_stop_token();
+}
+
+// reruns func, reading nodes, until no Compute_transaction committed to one
+// of them while it ran, so that everything it read comes from the same side
+// of every commit; within a Compute_function computation, throws
+// detail::Compute_retry instead of waiting for a commit invalidating
+// dependents of one of them
+template <std::invocable Func>
+auto read_consistent(std::span<Compute_node const *const> nodes, Func &&func)
+    -> std::invoke_result_t<Func &> {
+  for (;;) {
+    detail::Commit_reads const reads{nodes};
+    auto ret{std::invoke(func)};
+    if (reads.consistent()) {
+      return ret;
+    }
+  }
+}
+} // namespace f
 } // namespace compute
 
 namespace util {
@@ -77,14 +328,16 @@ struct Cloneable_bases<Compute_function_constant<Ret, Func>> {
   using type = std::tuple<Compute_in<self_type, Ret>>;
   using impl_type = std::tuple<>;
 };
-template <std::copyable Ret> struct Cloneable_bases<Compute_value<Ret>> {
-  using self_type = Compute_value<Ret>;
+template <std::copyable Ret, typename Lock>
+struct Cloneable_bases<Compute_value<Ret, Lock>> {
+  using self_type = Compute_value<Ret, Lock>;
   using type = std::tuple<Compute_in<self_type, Ret>>;
   using impl_type = std::tuple<>;
 };
-template <std::copyable Ret, std::copyable... TArgs>
-struct Cloneable_bases<Compute_function<Ret(TArgs...)>> {
-  using self_type = Compute_function<Ret(TArgs...)>;
+template <std::copyable Ret, std::copyable... TArgs, std::size_t Capacity,
+          typename Lock>
+struct Cloneable_bases<Compute_function<Ret(TArgs...), Capacity, Lock>> {
+  using self_type = Compute_function<Ret(TArgs...), Capacity, Lock>;
   using type = std::tuple<Compute_in<self_type, Ret>>;
   using impl_type = std::tuple<>;
 };
@@ -94,6 +347,74 @@ namespace compute {
 // NOLINTNEXTLINE(google-build-using-namespace)
 using namespace util::operators::enum_bitset;
 
+class Compute_node {
+public:
+  using generation_type = std::uint_fast64_t;
+  using version_type = std::uint_fast64_t;
+  // read from a version cell once its node is destroyed
+  constexpr static auto expired_version{~version_type{0}};
+
+private:
+#pragma warning(push)
+#pragma warning(disable : 4251)
+  mutable std::mutex dependents_mutex_{};
+  mutable std::vector<
+      std::pair<std::weak_ptr<Compute_node const>, generation_type>>
+      dependents_{};
+  mutable std::atomic<version_type> version_{0};
+  // created for the first observer, guarded by dependents_mutex_
+  mutable std::shared_ptr<std::atomic<version_type>> version_cell_{};
+  mutable std::atomic<std::atomic<version_type> *> version_mirror_{nullptr};
+#pragma warning(pop)
+
+public:
+  // edges are held weakly by the upstream node and strongly by the dependent
+  void add_dependent(Compute_node const &dependent,
+                     generation_type generation) const;
+  // drops every edge to dependent, and those to destroyed nodes, so that no
+  // weak reference outlives a Compute_graph the dependent was created in
+  void remove_dependent(Compute_node const &dependent) const noexcept;
+  // push: marks transitive dependents dirty, they recompute on the next pull;
+  // also advances the version, as every change goes through here
+  void invalidate_dependents() const;
+  auto version [[nodiscard]] () const noexcept -> version_type;
+  // lets observers poll or wait on version() with one atomic and without
+  // keeping the node alive
+  auto version_cell [[nodiscard]] () const
+      -> std::shared_ptr<std::atomic<version_type> const>;
+  virtual auto dependencies [[nodiscard]] () const
+      -> std::vector<std::shared_ptr<Compute_node const>>;
+  // computes and caches the value without knowing its type
+  virtual void evaluate() const = 0;
+  // completes once the value is cached, by default evaluates immediately
+  virtual auto evaluate_async(Compute_scheduler &scheduler) const
+      -> Compute_future<void>;
+
+  virtual ~Compute_node() noexcept;
+  Compute_node(Compute_node const &) = delete;
+  auto operator=(Compute_node const &) = delete;
+  Compute_node(Compute_node &&) = delete;
+  auto operator=(Compute_node &&) = delete;
+
+  // places nodes made by clone() in the current Compute_graph, if any
+  static auto operator new(std::size_t size) -> void *;
+  static auto operator new(std::size_t size, std::align_val_t alignment)
+      -> void *;
+  static void operator delete(void *ptr, std::size_t size) noexcept;
+  static void operator delete(void *ptr, std::size_t size,
+                              std::align_val_t alignment) noexcept;
+
+protected:
+  Compute_node() noexcept;
+
+private:
+  virtual auto weak_from_node [[nodiscard]] () const noexcept
+      -> std::weak_ptr<Compute_node const> = 0;
+  // returns false if the edge is stale and should be dropped
+  virtual auto invalidate(generation_type generation) const -> bool;
+#pragma warning(suppress : 4820)
+};
+
 template <std::copyable Ret> class Compute_io {
 public:
   using return_type = Ret;
@@ -112,21 +433,69 @@ protected:
 template <typename Derived, std::copyable Ret>
 // NOLINTNEXTLINE(fuchsia-multiple-inheritance)
 class Compute_in : public virtual util::Cloneable<Compute_in<Derived, Ret>>,
+                   public Compute_node,
                    public Compute_io<Ret>,
                    public std::enable_shared_from_this<Derived> {
 public:
   using return_type = typename Compute_in::return_type;
+  // std::bitset operators are not constexpr until C++23
   constexpr static util::Check_bitset clone_valid_options{
-      Compute_option::concurrent | Compute_option::defer};
+      Compute_options{util::f::to_underlying(Compute_option::concurrent) |
+                      util::f::to_underlying(Compute_option::defer) |
+                      util::f::to_underlying(Compute_option::snapshot) |
+                      util::f::to_underlying(Compute_option::async)}};
   using util::Cloneable<Compute_in>::clone;
   constexpr auto clone [[nodiscard]] (Compute_options const &options) const {
     return std::unique_ptr<Compute_in>{clone_impl_options(options)};
   }
+  void evaluate() const override { static_cast<void>((*this)()); }
+  // names the node in metrics dumps, does nothing without ARTCCEL_METRICS
+  void metrics_label(std::u8string_view label) const {
+    metrics_.label(label);
+  }
 
 protected:
   using Compute_in::Compute_io::Compute_io;
 
+  void metrics_evaluated() const noexcept { metrics_.evaluated(); }
+  template <std::invocable Func> auto metrics_recompute(Func &&func) const {
+    return metrics_.recompute(std::forward<Func>(func));
+  }
+  // traced while tracing is on, see f::start_trace
+  auto trace [[nodiscard]] (char8_t const *name, bool active = true) const
+      noexcept -> detail::Trace_scope {
+    return detail::Trace_scope{name, static_cast<Compute_node const *>(this),
+                               util::f::type_name<Derived>(), active};
+  }
+  // like constructing the guards from mutex, also timing and tracing the wait
+  template <typename Mutex>
+  auto shared_guard [[nodiscard]] (Mutex &mutex) const
+      -> std::shared_lock<Mutex> {
+    {
+      auto const trace{this->trace(u8"lock shared", mutex.locking())};
+      metrics_.lock_shared(mutex);
+    }
+    return std::shared_lock<Mutex>{mutex, std::adopt_lock};
+  }
+  template <typename Mutex>
+  auto exclusive_guard [[nodiscard]] (Mutex &mutex) const
+      -> std::lock_guard<Mutex> {
+    {
+      auto const trace{this->trace(u8"lock exclusive", mutex.locking())};
+      metrics_.lock(mutex);
+    }
+    return std::lock_guard<Mutex>{mutex, std::adopt_lock};
+  }
+
 private:
+  mutable detail::Metrics metrics_
+      [[no_unique_address, msvc::no_unique_address]]{
+          util::f::type_name<Derived>()};
+
+  auto weak_from_node [[nodiscard]] () const noexcept
+      -> std::weak_ptr<Compute_node const> override {
+    return this->weak_from_this();
+  }
   constexpr virtual auto clone_impl_options
       [[nodiscard]] (Compute_options const &options) const
       -> gsl::owner<Compute_in *> = 0;
@@ -140,22 +509,46 @@ public:
 
 private:
   std::weak_ptr<in_type const> c_in_{};
+  std::shared_ptr<std::atomic<Compute_node::version_type> const> version_{};
+  Compute_node::version_type seen_{};
   Ret return_{};
 
 public:
   constexpr Compute_out() noexcept = default;
   explicit Compute_out(Compute_in_c<Ret> auto const &c_in)
-      : c_in_{c_in.weak_from_this()}, return_{c_in()} {}
+      : c_in_{c_in.weak_from_this()}, version_{c_in.version_cell()},
+        // read before computing, a concurrent change then reads as stale
+        seen_{version_->load(std::memory_order_acquire)}, return_{c_in()} {}
 
   auto operator() [[nodiscard]] () const noexcept(noexcept(Ret{return_}))
       -> Ret override {
     return return_;
   }
   auto operator()(Extract_t tag [[maybe_unused]]) -> Ret {
+    update();
+    return return_;
+  }
+  // one atomic load, true also once the upstream node is destroyed
+  auto stale [[nodiscard]] () const noexcept {
+    return version_ && version_->load(std::memory_order_acquire) != seen_;
+  }
+  // pulls from upstream only if stale, returns whether it did
+  auto update() -> bool {
+    if (!stale()) {
+      return false;
+    }
+    auto const version{version_->load(std::memory_order_acquire)};
     if (auto const c_in{c_in_.lock()}) {
-      return_ = *c_in();
+      return_ = (*c_in)();
+    }
+    seen_ = version;
+    return true;
+  }
+  // blocks until stale, never once the upstream node is destroyed
+  void wait() const noexcept {
+    if (version_ && seen_ != Compute_node::expired_version) {
+      version_->wait(seen_, std::memory_order_acquire);
     }
-    return return_;
   }
   friend auto operator>>(Compute_out const &left,
                          Ret &right) noexcept(noexcept(Ret{right = left()}))
@@ -170,6 +563,8 @@ public:
   constexpr void swap(Compute_out &other) noexcept {
     using std::swap;
     swap(c_in_, other.c_in_);
+    swap(version_, other.version_);
+    swap(seen_, other.seen_);
     swap(return_, other.return_);
   }
   friend constexpr void swap(Compute_out &left, Compute_out &right) noexcept {
@@ -177,14 +572,16 @@ public:
   }
   Compute_out(Compute_out const &other) noexcept(
       noexcept(decltype(c_in_){other.c_in_}, decltype(return_){other.return_}))
-      : c_in_{other.c_in_}, return_{other.return_} {}
+      : c_in_{other.c_in_}, version_{other.version_}, seen_{other.seen_},
+        return_{other.return_} {}
   auto operator=(Compute_out const &right) noexcept(
       noexcept(Compute_out{right}.swap(*this), *this)) -> Compute_out & {
     Compute_out{right}.swap(*this);
     return *this;
   }
   Compute_out(Compute_out &&other) noexcept
-      : c_in_{std::move(other.c_in_)}, return_{std::move(other.return_)} {}
+      : c_in_{std::move(other.c_in_)}, version_{std::move(other.version_)},
+        seen_{other.seen_}, return_{std::move(other.return_)} {}
   auto operator=(Compute_out &&right) noexcept -> Compute_out & {
     Compute_out{std::move(right)}.swap(*this);
     return *this;
@@ -219,12 +616,12 @@ public:
 
   template <typename... Args>
   static auto create [[nodiscard]] (Args &&...args) {
-    return std::make_shared<Compute_constant>(Friend{},
+    return detail::make_node<Compute_constant>(Friend{},
                                               std::forward<Args>(args)...);
   }
   template <typename... Args>
   static auto create_const [[nodiscard]] (Args &&...args) {
-    return std::make_shared<Compute_constant const>(
+    return detail::make_node<Compute_constant const>(
         Friend{}, std::forward<Args>(args)...);
   }
   auto operator() [[nodiscard]] () const noexcept(noexcept(Ret{value_}))
@@ -232,7 +629,7 @@ public:
     return value_;
   }
 
-  using Compute_constant::Cloneable_impl::clone;
+  using util::Cloneable_impl<Compute_constant>::clone;
   auto clone [[nodiscard]] (Compute_options const &options) const {
     return std::unique_ptr<Compute_constant>{clone_impl_options(options)};
   }
@@ -279,12 +676,12 @@ public:
 
   template <typename... Args>
   static auto create [[nodiscard]] (Args &&...args) {
-    return std::make_shared<Compute_function_constant>(
+    return detail::make_node<Compute_function_constant>(
         Friend{}, std::forward<Args>(args)...);
   }
   template <typename... Args>
   static auto create_const [[nodiscard]] (Args &&...args) {
-    return std::make_shared<Compute_function_constant const>(
+    return detail::make_node<Compute_function_constant const>(
         Friend{}, std::forward<Args>(args)...);
   }
   auto operator() [[nodiscard]] () const
@@ -316,10 +713,11 @@ private:
 #pragma warning(suppress : 4250)
 };
 
-template <std::copyable Ret>
+template <std::copyable Ret, typename Lock>
 // NOLINTNEXTLINE(fuchsia-multiple-inheritance)
-class Compute_value : public virtual util::Cloneable_impl<Compute_value<Ret>>,
-                      public Compute_in<Compute_value<Ret>, Ret> {
+class Compute_value
+    : public virtual util::Cloneable_impl<Compute_value<Ret, Lock>>,
+      public Compute_in<Compute_value<Ret, Lock>, Ret> {
   friend util::Cloneable_impl<Compute_value>;
 
 private:
@@ -333,20 +731,50 @@ public:
       : Compute_value(std::forward<Args>(args)...) {}
 
 private:
-  util::Nullable_lockable</* mutable */ std::shared_mutex> const mutex_;
+  typename Lock::template type</* mutable */ std::shared_mutex> const mutex_;
   Ret value_;
+  // copy of value_ published for lock-free reads, writers still use mutex_
+  std::unique_ptr<util::Snapshot_cell<Ret>> const snapshot_;
+  // of the commit stripe of the node, read without the lock
+  std::atomic<std::uint_fast64_t> const &commit_sequence_{
+      detail::commit_sequence(detail::commit_stripe(*this))};
+
+  friend class Compute_transaction;
+  friend class Compute_snapshot;
+
+  static auto make_mutex [[nodiscard]] (Compute_options const &options) {
+    return Lock::template make<std::shared_mutex>(
+        (options & (Compute_option::concurrent | Compute_option::snapshot))
+            .any());
+  }
+  static auto make_snapshot
+      [[nodiscard]] (Compute_options const &options, Ret const &value)
+      -> std::remove_cv_t<decltype(snapshot_)> {
+    if ((options & Compute_option::snapshot).any()) {
+      return std::make_unique<util::Snapshot_cell<Ret>>(value);
+    }
+    return nullptr;
+  }
+  auto current_options [[nodiscard]] () const noexcept {
+    Compute_options ret{};
+    if (mutex_.locking()) {
+      ret |= Compute_option::concurrent;
+    }
+    if (snapshot_) {
+      ret |= Compute_option::snapshot;
+    }
+    return ret;
+  }
 
 protected:
   explicit Compute_value(Ret value)
-      : Compute_value{util::Enum_bitset{} | Compute_option::concurrent,
-                      std::move(value)} {}
+      : Compute_value(util::Enum_bitset{} | Compute_option::concurrent,
+                      std::move(value)) {}
   explicit Compute_value(Compute_options const &options, Ret value)
-      : mutex_{(options & Compute_option::concurrent).any()
-                   ? std::make_unique<std::shared_mutex>()
-                   : nullptr},
-        value_{std::move(value)} {
+      : mutex_{make_mutex(options)}, value_{std::move(value)},
+        snapshot_{make_snapshot(options, value_)} {
     constexpr static util::Check_bitset valid_options{
-        Compute_option::concurrent};
+        Compute_option::concurrent | Compute_option::snapshot};
     valid_options(options);
   }
 
@@ -355,7 +783,9 @@ private:
   static auto create_const_0
       [[nodiscard]] (Compute_options const &options, Args &&...args) {
     constexpr static util::Check_bitset valid_options{
-        ~Compute_option::concurrent};
+        Compute_options{util::f::int_unsigned_cast(
+            ~(util::f::to_underlying(Compute_option::concurrent) |
+              util::f::to_underlying(Compute_option::snapshot)))}};
     valid_options(options);
     return create_const_1(options, std::forward<Args>(args)...);
   }
@@ -366,14 +796,14 @@ private:
   }
   template <typename... Args>
   static auto create_const_1 [[nodiscard]] (Args &&...args) {
-    return std::make_shared<Compute_value const>(Friend{},
+    return detail::make_node<Compute_value const>(Friend{},
                                                  std::forward<Args>(args)...);
   }
 
 public:
   template <typename... Args>
   static auto create [[nodiscard]] (Args &&...args) {
-    return std::make_shared<Compute_value>(Friend{},
+    return detail::make_node<Compute_value>(Friend{},
                                            std::forward<Args>(args)...);
   }
   template <typename... Args>
@@ -382,22 +812,39 @@ public:
   }
 
   auto operator() [[nodiscard]] () const -> Ret override {
-    std::shared_lock const guard{mutex_};
+    this->metrics_evaluated();
+    detail::await_applied(commit_sequence_);
+    if (snapshot_) {
+      return snapshot_->load();
+    }
+    auto const guard{this->shared_guard(mutex_)};
     return value_;
   }
   friend auto operator<<(Compute_value &left, Ret const &value) -> Ret {
     return left << Ret{value};
   }
   friend auto operator<<(Compute_value &left, Ret &&value) -> Ret {
-    std::lock_guard const guard{left.mutex_};
-    return std::exchange(left.value_, std::move(value));
+    auto ret{[&left, &value] {
+      auto const guard{left.exclusive_guard(left.mutex_)};
+      auto old{std::exchange(left.value_, std::move(value))};
+      left.publish();
+      return old;
+    }()};
+    left.invalidate_dependents();
+    return ret;
   }
   friend auto operator<<=(Compute_value &left, Ret const &value) -> Ret {
     return left <<= Ret{value};
   }
   friend auto operator<<=(Compute_value &left, Ret &&value) -> Ret {
-    std::lock_guard const guard{left.mutex_};
-    return left.value_ = std::move(value);
+    auto ret{[&left, &value] {
+      auto const guard{left.exclusive_guard(left.mutex_)};
+      left.value_ = std::move(value);
+      left.publish();
+      return left.value_;
+    }()};
+    left.invalidate_dependents();
+    return ret;
   }
 
   using util::Cloneable_impl<Compute_value>::clone;
@@ -411,51 +858,63 @@ protected:
     std::scoped_lock const guard{mutex_, other.mutex_};
     using std::swap;
     swap(value_, other.value_);
+    publish();
+    other.publish();
   }
-  Compute_value(Compute_value const &other) noexcept(noexcept(Compute_value{
-      other,
-      other.mutex_.value_ ? std::make_unique<std::shared_mutex>() : nullptr}))
-      : Compute_value(other, other.mutex_.value_
-                                 ? std::make_unique<std::shared_mutex>()
-                                 : nullptr) {}
+  Compute_value(Compute_value const &other)
+      : Compute_value(other, other.current_options()) {}
   auto operator=(Compute_value const &right) noexcept(
       noexcept(Compute_value{right}.swap(*this), *this)) -> Compute_value & {
     Compute_value{right}.swap(*this);
     return *this;
   }
   Compute_value(Compute_value &&other) noexcept
-      : mutex_{other.mutex_.value_ ? std::make_unique<std::shared_mutex>()
-                                   : nullptr},
-        value_{std::move(other.value_)} {}
+      : mutex_{make_mutex(other.current_options())},
+        value_{std::move(other.value_)},
+        snapshot_{make_snapshot(other.current_options(), value_)} {}
   auto operator=(Compute_value &&right) noexcept -> Compute_value & {
     Compute_value{std::move(right)}.swap(*this);
     return *this;
   }
 
-  explicit Compute_value(
-      Compute_value const &other,
-      std::remove_cv_t<decltype(mutex_)>
-          &&mutex) noexcept(noexcept(decltype(mutex_){std::move(mutex)}, void(),
-                                     decltype(value_){other.value_}))
-      : mutex_{std::move(mutex)}, value_{other.value_} {}
+  explicit Compute_value(Compute_value const &other,
+                         Compute_options const &options)
+      : mutex_{make_mutex(options)}, value_{other.value_},
+        snapshot_{make_snapshot(options, value_)} {}
 
 private:
+  void publish() {
+    if (snapshot_) {
+      snapshot_->store(value_);
+    }
+  }
+  void restore(Ret value) {
+    {
+      auto const guard{this->exclusive_guard(mutex_)};
+      value_ = std::move(value);
+      publish();
+    }
+    this->invalidate_dependents();
+  }
   auto clone_impl_options [[nodiscard]] (Compute_options const &options) const
       -> gsl::owner<Compute_value *> override {
     Compute_value::clone_valid_options(options);
-    return new Compute_value{*this, (options | Compute_option::concurrent).any()
-                                        ? std::make_unique<std::shared_mutex>()
-                                        : nullptr};
+    return new Compute_value{*this, options & (Compute_option::concurrent |
+                                               Compute_option::snapshot)};
   }
 #pragma warning(suppress : 4250)
 };
 
-template <std::copyable Ret, std::copyable... TArgs>
+template <std::copyable Ret, std::copyable... TArgs, std::size_t Capacity,
+          typename Lock>
 // NOLINTNEXTLINE(fuchsia-multiple-inheritance)
-class Compute_function<Ret(TArgs...)>
-    : public virtual util::Cloneable_impl<Compute_function<Ret(TArgs...)>>,
-      public Compute_in<Compute_function<Ret(TArgs...)>, Ret> {
+class Compute_function<Ret(TArgs...), Capacity, Lock>
+    : public virtual util::Cloneable_impl<
+          Compute_function<Ret(TArgs...), Capacity, Lock>>,
+      public Compute_in<Compute_function<Ret(TArgs...), Capacity, Lock>, Ret> {
   friend util::Cloneable_impl<Compute_function>;
+  friend class Compute_snapshot;
+  friend class Compute_snapshot_writer;
 
 private:
   enum struct Friend : bool {};
@@ -472,49 +931,189 @@ public:
       : Compute_function(std::forward<Args>(args)...) {}
 
 protected:
-  enum struct Bound_action : bool { compute, reset };
+  enum struct Bound_action : std::uint_fast8_t {
+    compute,
+    reset,
+    peek,
+    restore,
+    fresh
+  };
+  template <typename Signature>
+  using function_type_for =
+      std::conditional_t<Capacity == 0, std::function<Signature>,
+                         util::Inline_function<Signature, Capacity>>;
+  using function_type = function_type_for<signature_type>;
+  // the node is passed in rather than captured, so copies share no state
+  using bound_type = function_type_for<std::optional<Ret>(
+      Bound_action, Compute_function const &)>;
+  using memo_key_type = std::tuple<std::remove_cv_t<TArgs>...>;
+  constexpr static auto memoizable_{
+      (util::Hashable<std::remove_cv_t<TArgs>> && ...)};
 
 private:
-  util::Nullable_lockable</* mutable */ std::shared_mutex> const mutex_;
-  std::function<signature_type> function_;
-  std::function<std::optional<Ret>(Bound_action)> bound_;
+  typename Lock::template type</* mutable */ std::shared_timed_mutex> const
+      mutex_;
+  function_type function_;
+  std::vector<std::weak_ptr<Compute_node const>> dependencies_;
+  struct Memo {
+    using cache_type =
+        util::Clock_cache<memo_key_type, Ret, util::Tuple_hash<memo_key_type>>;
+    mutable std::mutex mutex_{};
+    cache_type cache_;
+
+    explicit Memo(cache_type cache) : cache_{std::move(cache)} {}
+  };
+  // non-null after memoize, declared before bound_ which computes with it
+  std::unique_ptr<Memo> memo_{};
+  struct Stop {
+    std::mutex mutex_{};
+    std::condition_variable changed_{};
+    // replaced once stopped, under both mutex_ and the exclusive lock
+    std::stop_source source_{};
+    std::uint_fast64_t renewals_{0};
+    std::atomic<std::size_t> running_{0};
+    std::atomic<std::size_t> waiting_{0};
+  };
+  // declared before bound_ which computes with it
+  mutable Stop stop_{};
+  // the current result, read without the lock; declared before bound_ which
+  // publishes to it
+  mutable util::Result_cell<Ret> ready_{};
+  bound_type bound_;
+  Compute_node::generation_type generation_{0};
+  mutable std::atomic<bool> tracked_{false};
+  struct In_flight {
+    std::mutex mutex_{};
+    std::optional<Compute_future<Ret>> future_{};
+  };
+  // non-null with Compute_option::async
+  std::unique_ptr<In_flight> in_flight_;
+
+  // timed, for operator() with a deadline
+  static auto make_mutex [[nodiscard]] (bool concurrent) {
+    return Lock::template make<std::shared_timed_mutex>(concurrent);
+  }
+  static auto make_in_flight [[nodiscard]] (bool async)
+      -> std::unique_ptr<In_flight> {
+    return async ? std::make_unique<In_flight>() : nullptr;
+  }
+  // the state a copy takes from other, read under one shared lock of other;
+  // without the result, so that the copy computes its own once it tracks its
+  // dependencies
+  struct Copied {
+    function_type function_;
+    std::vector<std::weak_ptr<Compute_node const>> dependencies_;
+    std::unique_ptr<Memo> memo_;
+    bound_type bound_;
+  };
+  static auto copy_of [[nodiscard]] (Compute_function const &other)
+      -> Copied {
+    std::shared_lock const guard{other.mutex_};
+    Copied ret{other.function_, other.dependencies_,
+               copy_memo(other.memo_.get()), other.bound_};
+    ret.bound_(Bound_action::reset, other);
+    return ret;
+  }
+  static auto copy_memo [[nodiscard]] (Memo const *memo)
+      -> std::unique_ptr<Memo> {
+    if constexpr (memoizable_) {
+      if (memo != nullptr) {
+        std::lock_guard const guard{memo->mutex_};
+        return std::make_unique<Memo>(memo->cache_);
+      }
+    }
+    return nullptr;
+  }
 
 protected:
-  template <typename... Args, util::Invocable_r<Ret, Args...> Func>
+  template <typename... Args,
+            Compute_bindable_c<signature_type, Args...> Func>
   explicit Compute_function(Func &&function, Args &&...args)
       : Compute_function(Compute_option::concurrent | Compute_option::defer,
                          std::forward<Func>(function),
                          std::forward<Args>(args)...) {}
-  template <typename... Args, util::Invocable_r<Ret, Args...> Func>
+  template <typename... Args,
+            Compute_bindable_c<signature_type, Args...> Func>
   explicit Compute_function(Compute_options const &options, Func &&function,
                             Args &&...args)
-      : mutex_{(options & Compute_option::concurrent).any()
-                   ? std::make_unique<std::shared_mutex>()
-                   : nullptr},
+      : mutex_{make_mutex((options & Compute_option::concurrent).any())},
         function_{std::forward<Func>(function)},
-        bound_{bind((options & Compute_option::defer).none(), function_,
-                    std::forward<Args>(args)...)} {
-    constexpr static util::Check_bitset valid_options{
-        Compute_option::concurrent | Compute_option::defer};
+        dependencies_{dependencies_of(args...)},
+        bound_{bind((options & Compute_option::defer).none(), *this,
+                    std::forward<Args>(args)...)},
+        in_flight_{make_in_flight((options & Compute_option::async).any())} {
+    constexpr static util::Check_bitset valid_options{Compute_options{
+        util::f::to_underlying(Compute_option::concurrent) |
+        util::f::to_underlying(Compute_option::defer) |
+        util::f::to_underlying(Compute_option::async)}};
     valid_options(options);
   }
+  template <typename Param, typename Arg>
+  static auto pull(Arg &arg) -> decltype(auto) {
+    if constexpr (Compute_dependency_c<Arg &, Param>) {
+      return (*arg)();
+    } else {
+      return static_cast<Arg &>(arg);
+    }
+  }
+  template <typename Param, typename Arg>
+  static auto read_node [[nodiscard]] (Arg const &arg) noexcept
+      -> Compute_node const * {
+    if constexpr (Compute_dependency_c<Arg const &, Param>) {
+      return std::addressof(*arg);
+    } else {
+      return nullptr;
+    }
+  }
+  template <typename Param, typename Arg>
+  static void add_dependency(decltype(dependencies_) &dependencies,
+                             Arg const &arg) {
+    if constexpr (Compute_dependency_c<Arg const &, Param>) {
+      dependencies.emplace_back(arg);
+    }
+  }
   template <typename... Args>
-  requires util::Invocable_r<decltype(function_), Ret, Args...>
-  static auto bind(bool invoke, decltype(function_) const &function,
+  static auto dependencies_of [[nodiscard]] (Args const &...args) {
+    decltype(dependencies_) ret{};
+    (add_dependency<TArgs>(ret, args), ...);
+    return ret;
+  }
+  template <typename... Args>
+  requires Compute_bindable_c<decltype(function_), signature_type, Args...>
+  static auto bind(bool invoke, Compute_function const &self,
                    Args &&...args) {
-    auto bound{[flag{util::Semiregular_once_flag{}}, ret{std::optional<Ret>{}},
-                function, ... args{std::forward<Args>(args)}](
-                   Bound_action action) mutable {
+    // the result lives in ready_ only, published once per flag
+    auto bound{[flag{util::Semiregular_once_flag{}},
+                ... args{std::forward<Args>(args)}](
+                   Bound_action action, Compute_function const &self) mutable {
       switch (action) {
       case Bound_action::compute:
-        flag.call_once([&ret, &function, &args...]() noexcept(noexcept(
-                           ret = function(std::forward<Args>(args)...))) {
-          ret = function(std::forward<Args>(args)...);
-        });
-        return ret;
+        try {
+          // bound arguments are reused by later recomputations, never forward
+          flag.call_once(
+              [&self, &args...] { self.publish(self.compute(args...)); });
+        } catch (detail::Compute_cancelled const &) {
+          return std::optional<Ret>{};
+        }
+        return self.ready_.load();
       case Bound_action::reset:
+        // call after retract()
         flag = {};
         return std::optional<Ret>{};
+      case Bound_action::peek:
+        // a computation may be publishing under a shared lock
+        return self.ready_.load();
+      case Bound_action::restore:
+        // the result is published before, the flag then counts as computed
+        flag.call_once([]() noexcept {});
+        return std::optional<Ret>{};
+      case Bound_action::fresh:
+        // computes without caching, leaving the flag as it is
+        try {
+          return std::optional<Ret>{self.compute(args...)};
+        } catch (detail::Compute_cancelled const &) {
+          return std::optional<Ret>{};
+        }
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wcovered-switch-default"
       default:
@@ -523,12 +1122,89 @@ protected:
       }
     }};
     if (invoke) {
-      bound(Bound_action::compute);
+      try {
+        bound(Bound_action::compute, self);
+      } catch (detail::Compute_retry const &) {
+        // computed on the next call instead, after the commit
+      }
     }
     return bound;
   }
 
 private:
+  // call with the lock held; may throw detail::Compute_retry
+  template <typename... Args> auto compute(Args &...args) const -> Ret {
+    ++detail::computing();
+    auto const finally{gsl::finally([] { --detail::computing(); })};
+    std::array<Compute_node const *, sizeof...(Args)> const nodes{
+        read_node<TArgs>(args)...};
+    return apply(f::read_consistent(nodes, [&args...] {
+      return std::tuple<decltype(pull<TArgs>(args))...>{pull<TArgs>(args)...};
+    }));
+  }
+  template <typename Tuple> auto apply(Tuple &&t_args) const -> Ret {
+    if constexpr (memoizable_) {
+      if (memo_) {
+        auto key{
+            std::make_from_tuple<memo_key_type>(std::forward<Tuple>(t_args))};
+        {
+          std::lock_guard const guard{memo_->mutex_};
+          if (auto const *const cached{memo_->cache_.find(key)}) {
+            return *cached;
+          }
+        }
+        auto ret{run(key)};
+        std::lock_guard const guard{memo_->mutex_};
+        memo_->cache_.insert(std::move(key), ret);
+        return ret;
+      }
+    }
+    return run(std::forward<Tuple>(t_args));
+  }
+  // throws detail::Compute_cancelled if a reset, bind or invalidation made
+  // the result stale before or while computing
+  template <typename Tuple> auto run(Tuple &&t_args) const -> Ret {
+    stop_.running_.fetch_add(1, std::memory_order_seq_cst);
+    auto const token{stop_.source_.get_token()};
+    auto const previous{std::exchange(detail::running_stop_token(), token)};
+    auto const finally{gsl::finally([this, &previous] {
+      detail::running_stop_token() = previous;
+      stop_.running_.fetch_sub(1, std::memory_order_seq_cst);
+      if (stop_.waiting_.load(std::memory_order_seq_cst) != 0) {
+        std::lock_guard const guard{stop_.mutex_};
+        stop_.changed_.notify_all();
+      }
+    })};
+    if (token.stop_requested()) {
+      throw detail::Compute_cancelled{};
+    }
+    auto const trace{this->trace(u8"compute")};
+    auto ret{this->metrics_recompute([this, &t_args] {
+      return std::apply(function_, std::forward<Tuple>(t_args));
+    })};
+    if (token.stop_requested()) {
+      throw detail::Compute_cancelled{};
+    }
+    return ret;
+  }
+  static auto evaluate_now(Compute_function const &self)
+      -> Compute_future<Ret> {
+    co_return self();
+  }
+  static auto evaluate_on(std::shared_ptr<Compute_function const> self,
+                          Compute_scheduler &scheduler)
+      -> Compute_future<Ret> {
+    co_await scheduler.schedule();
+    // start every upstream node before waiting on any of them
+    std::vector<Compute_future<void>> upstream{};
+    for (auto const &dependency : self->dependencies()) {
+      upstream.emplace_back(dependency->evaluate_async(scheduler));
+    }
+    for (auto const &future : upstream) {
+      co_await future;
+    }
+    co_return (*self)();
+  }
   template <typename... Args>
   static auto create_const_0
       [[nodiscard]] (Compute_options const &options, Args &&...args) {
@@ -544,15 +1220,162 @@ private:
   }
   template <typename... Args>
   static auto create_const_1 [[nodiscard]] (Args &&...args) {
-    return std::make_shared<Compute_function const>(
-        Friend{}, std::forward<Args>(args)...);
+    auto ret{detail::make_node<Compute_function const>(
+        Friend{}, std::forward<Args>(args)...)};
+    ret->track_dependencies();
+    return ret;
+  }
+
+  // returns false while no std::shared_ptr owns the node, so that no
+  // invalidation can reach it yet; retried on the next pull
+  auto track_dependencies() const -> bool {
+    if (tracked_.load(std::memory_order_acquire)) {
+      return true;
+    }
+    if (this->weak_from_this().expired()) {
+      return false;
+    }
+    if (tracked_.exchange(true, std::memory_order_acq_rel)) {
+      return true;
+    }
+    for (auto const &dependency : dependencies_) {
+      if (auto const locked{dependency.lock()}) {
+        locked->add_dependent(*this, generation_);
+      }
+    }
+    return true;
+  }
+  // call with the exclusive lock held, or while destroying, before
+  // dependencies_ changes
+  void untrack_dependencies() const noexcept {
+    if (!tracked_.exchange(false, std::memory_order_acq_rel)) {
+      return;
+    }
+    for (auto const &dependency : dependencies_) {
+      if (auto const locked{dependency.lock()}) {
+        locked->remove_dependent(*this);
+      }
+    }
+  }
+  // call with the exclusive lock held; empty if cancelled or retried, the
+  // caller then computes again without the lock
+  auto compute_exclusive [[nodiscard]] () const -> std::optional<Ret> {
+    try {
+      return bound_(Bound_action::compute, *this);
+    } catch (detail::Compute_retry const &) {
+      return std::nullopt;
+    }
+  }
+  // call with the shared lock held; empty if cancelled, may throw
+  // detail::Compute_retry
+  auto compute_shared [[nodiscard]] () const -> std::optional<Ret> {
+    if (!track_dependencies() && !dependencies_.empty()) {
+      // a cached result would go stale unnoticed, such as in a clone not
+      // yet moved into a std::shared_ptr
+      return bound_(Bound_action::fresh, *this);
+    }
+    return bound_(Bound_action::compute, *this);
+  }
+  // call in the once flag of bound_, or with the exclusive lock held, after
+  // retract()
+  void publish(Ret value) const { ready_.publish(std::move(value)); }
+  // call with the exclusive lock held, readers of the previous result go on;
+  // later async() calls start an evaluation of their own instead of joining
+  // one that may complete with the previous result
+  void retract() const {
+    ready_.retract();
+    if (in_flight_) {
+      std::lock_guard const guard{in_flight_->mutex_};
+      in_flight_->future_.reset();
+    }
+  }
+  // call with the exclusive lock held, after retract(); bound_ is empty once
+  // moved from
+  void reset_bound() const noexcept {
+    if (bound_) {
+      bound_(Bound_action::reset, *this);
+    }
+  }
+  // takes no lock and writes no shared memory; a result that is not
+  // trivially copyable is copied in an Epoch_guard, so the first read on a
+  // thread may throw std::bad_alloc
+  auto peek_ready [[nodiscard]] () const -> std::optional<Ret> {
+    return ready_.load();
+  }
+  // call before taking the exclusive lock, which a running computation holds
+  // shared, so that it may return early
+  void cancel() const {
+    if (stop_.running_.load(std::memory_order_seq_cst) != 0) {
+      std::lock_guard const guard{stop_.mutex_};
+      stop_.source_.request_stop();
+    }
+  }
+  // call with the exclusive lock held, after every cancel
+  void renew() const {
+    std::lock_guard const guard{stop_.mutex_};
+    if (stop_.source_.stop_requested()) {
+      stop_.source_ = std::stop_source{};
+      ++stop_.renewals_;
+      stop_.changed_.notify_all();
+    }
+  }
+  // without computing; exclusive, so no computation is writing the result
+  auto cached [[nodiscard]] () const -> std::optional<Ret> {
+    if (auto ret{peek_ready()}) {
+      return ret;
+    }
+    std::lock_guard const guard{mutex_};
+    return bound_(Bound_action::peek, *this);
+  }
+  // installs a result of an earlier run as if computed from the current
+  // arguments
+  void restore(Ret value) {
+    cancel();
+    {
+      auto const guard{this->exclusive_guard(mutex_)};
+      renew();
+      retract();
+      bound_(Bound_action::reset, *this);
+      publish(std::move(value));
+      bound_(Bound_action::restore, *this);
+      track_dependencies();
+    }
+    this->invalidate_dependents();
+  }
+  // call without the lock, after a computation was cancelled
+  void await_renewal(std::uint_fast64_t renewals) const {
+    std::unique_lock lock{stop_.mutex_};
+    stop_.changed_.wait(
+        lock, [this, renewals] { return stop_.renewals_ != renewals; });
+  }
+  auto invalidate(Compute_node::generation_type generation) const
+      -> bool override {
+    cancel();
+    {
+      auto const guard{this->exclusive_guard(mutex_)};
+      renew();
+      if (generation != generation_) {
+        return false;
+      }
+      auto const computed{ready_.ready()};
+      retract();
+      bound_(Bound_action::reset, *this);
+      if (!computed) {
+        // never computed since the last invalidation, dependents are dirty
+        return true;
+      }
+    }
+    this->invalidate_dependents();
+    return true;
   }
 
 public:
   template <typename... Args>
   static auto create [[nodiscard]] (Args &&...args) {
-    return std::make_shared<Compute_function>(Friend{},
-                                              std::forward<Args>(args)...);
+    auto ret{detail::make_node<Compute_function>(Friend{},
+                                                std::forward<Args>(args)...)};
+    ret->track_dependencies();
+    return ret;
   }
   template <typename... Args>
   static auto create_const [[nodiscard]] (Args &&...args) {
@@ -560,31 +1383,194 @@ public:
   }
 
   template <typename... Args>
-  requires util::Invocable_r<decltype(function_), Ret, Args...>
+  requires Compute_bindable_c<decltype(function_), signature_type, Args...>
   auto bind(Compute_options const &options, Args &&...args)
       -> std::optional<Ret> {
     constexpr static util::Check_bitset valid_options{Compute_option::defer};
     valid_options(options);
     auto const invoke{(options & Compute_option::defer).none()};
-    std::lock_guard const guard{mutex_};
-    bound_ = bind(invoke, function_, std::forward<Args>(args)...);
-    return invoke ? bound_(Bound_action::compute) : std::nullopt;
+    auto const trace{this->trace(u8"bind")};
+    cancel();
+    auto ret{[this, invoke, &args...] {
+      auto const guard{this->exclusive_guard(mutex_)};
+      renew();
+      retract();
+      untrack_dependencies();
+      dependencies_ = dependencies_of(args...);
+      bound_ = bind(invoke, *this, std::forward<Args>(args)...);
+      ++generation_; // edges registered for the previous arguments are stale
+      track_dependencies();
+      return invoke ? compute_exclusive() : std::nullopt;
+    }()};
+    this->invalidate_dependents();
+    if (invoke && !ret) {
+      // cancelled by a concurrent writer
+      ret = (*this)();
+    }
+    return ret;
   }
   auto reset(Compute_options const &options) -> std::optional<Ret> {
     constexpr static util::Check_bitset valid_options{Compute_option::defer};
     valid_options(options);
     auto const invoke{(options & Compute_option::defer).none()};
-    std::lock_guard const guard{mutex_};
-    bound_(Bound_action::reset);
-    return invoke ? bound_(Bound_action::compute) : std::nullopt;
+    auto const trace{this->trace(u8"reset")};
+    cancel();
+    auto ret{[this, invoke] {
+      auto const guard{this->exclusive_guard(mutex_)};
+      renew();
+      retract();
+      bound_(Bound_action::reset, *this);
+      return invoke ? compute_exclusive() : std::nullopt;
+    }()};
+    this->invalidate_dependents();
+    if (invoke && !ret) {
+      // cancelled by a concurrent writer
+      ret = (*this)();
+    }
+    return ret;
+  }
+
+  // caches up to capacity results keyed by the argument values, evicting
+  // approximately the least recently used; assumes the function is pure,
+  // a zero capacity disables caching
+  void memoize(std::size_t capacity) requires memoizable_ {
+    auto const guard{this->exclusive_guard(mutex_)};
+    memo_ = capacity == 0 ? nullptr
+                          : std::make_unique<Memo>(
+                                typename Memo::cache_type{capacity});
+  }
+  auto memo_stats [[nodiscard]] () const -> util::Cache_stats {
+    auto const guard{this->shared_guard(mutex_)};
+    if (!memo_) {
+      return {};
+    }
+    std::lock_guard const memo_guard{memo_->mutex_};
+    return memo_->cache_.stats();
   }
 
   auto operator()() const -> Ret override {
-    std::shared_lock const guard{mutex_};
-    return *bound_(Bound_action::compute);
+    this->metrics_evaluated();
+    if (auto ret{peek_ready()}) {
+      return *std::move(ret);
+    }
+    for (;;) {
+      std::optional<std::uint_fast64_t> renewals{};
+      std::optional<detail::Compute_retry> retry{};
+      {
+        auto const guard{this->shared_guard(mutex_)};
+        try {
+          // concurrent first callers park in call_once on one computation
+          if (auto ret{compute_shared()}) {
+            return *std::move(ret);
+          }
+          renewals = stop_.renewals_;
+        } catch (detail::Compute_retry const &caught) {
+          if (detail::computing() != 0) {
+            throw;
+          }
+          retry = caught;
+        }
+      }
+      if (renewals) {
+        // cancelled, retry after the writer that cancelled it
+        await_renewal(*renewals);
+      } else {
+        detail::await_commit(*retry);
+      }
+    }
+  }
+  // like operator(), but gives up at deadline while waiting for a writer or
+  // for a computation running on another thread; a computation started by
+  // this call runs to completion
+  template <typename Clock, typename Duration>
+  auto operator()(std::chrono::time_point<Clock, Duration> const &deadline)
+      const -> std::optional<Ret> {
+    for (;;) {
+      if (auto ret{peek_ready()}) {
+        return ret;
+      }
+      std::shared_lock guard{mutex_, deadline};
+      if (!guard.owns_lock()) {
+        return std::nullopt;
+      }
+      auto const renewals{stop_.renewals_};
+      auto const busy{stop_.running_.load(std::memory_order_seq_cst) != 0};
+      if (!busy) {
+        try {
+          if (auto ret{compute_shared()}) {
+            return ret;
+          }
+        } catch (detail::Compute_retry const &retry) {
+          if (detail::computing() != 0) {
+            throw;
+          }
+          guard.unlock();
+          while (detail::commit_sequence(retry.stripe_)
+                     .load(std::memory_order_seq_cst) == retry.sequence_) {
+            if (Clock::now() >= deadline) {
+              return peek_ready();
+            }
+            std::this_thread::yield();
+          }
+          continue;
+        }
+      }
+      guard.unlock();
+      std::unique_lock lock{stop_.mutex_};
+      stop_.waiting_.fetch_add(1, std::memory_order_seq_cst);
+      auto const changed{
+          stop_.changed_.wait_until(lock, deadline, [this, renewals, busy] {
+            return stop_.renewals_ != renewals ||
+                   (busy &&
+                    stop_.running_.load(std::memory_order_seq_cst) == 0);
+          })};
+      stop_.waiting_.fetch_sub(1, std::memory_order_seq_cst);
+      if (!changed) {
+        return peek_ready();
+      }
+    }
+  }
+  // with Compute_option::async, awaits the upstream nodes and then computes
+  // on the scheduler, concurrent calls sharing one evaluation; otherwise
+  // computes on the calling thread; the node must be owned by a shared_ptr
+  auto async(Compute_scheduler &scheduler) const -> Compute_future<Ret> {
+    if (auto ret{peek_ready()}) {
+      return Compute_future<Ret>::ready(*std::move(ret));
+    }
+    if (std::shared_lock const guard{mutex_, std::try_to_lock}) {
+      // shared, so no reset or bind is in progress
+      if (auto ret{bound_(Bound_action::peek, *this)}) {
+        return Compute_future<Ret>::ready(*std::move(ret));
+      }
+    }
+    if (!in_flight_) {
+      return evaluate_now(*this);
+    }
+    std::lock_guard const guard{in_flight_->mutex_};
+    if (!in_flight_->future_ || in_flight_->future_->is_ready()) {
+      in_flight_->future_.emplace(
+          evaluate_on(this->shared_from_this(), scheduler));
+    }
+    return *in_flight_->future_;
+  }
+  auto evaluate_async(Compute_scheduler &scheduler) const
+      -> Compute_future<void> override {
+    co_await async(scheduler);
+  }
+  auto dependencies [[nodiscard]] () const
+      -> std::vector<std::shared_ptr<Compute_node const>> override {
+    auto const guard{this->shared_guard(mutex_)};
+    std::vector<std::shared_ptr<Compute_node const>> ret{};
+    ret.reserve(dependencies_.size());
+    for (auto const &dependency : dependencies_) {
+      if (auto locked{dependency.lock()}) {
+        ret.emplace_back(std::move(locked));
+      }
+    }
+    return ret;
   }
   template <template <typename...> typename Tuple, typename... Args>
-  requires util::Invocable_r<decltype(function_), Ret, Args...>
+  requires Compute_bindable_c<decltype(function_), signature_type, Args...>
   friend void operator<<(Compute_function &left, Tuple<Args &&...> &&t_args) {
     util::f::forward_apply(
         [&left](Args &&...args) {
@@ -594,7 +1580,7 @@ public:
         std::forward<Tuple<Args &&...>>(t_args));
   }
   template <template <typename...> typename Tuple, typename... Args>
-  requires util::Invocable_r<decltype(function_), Ret, Args...>
+  requires Compute_bindable_c<decltype(function_), signature_type, Args...>
   friend auto operator<<=(Compute_function &left, Tuple<Args &&...> &&t_args)
       -> Ret {
     return util::f::forward_apply(
@@ -616,54 +1602,68 @@ public:
   auto clone [[nodiscard]] (Compute_options const &options) const {
     return std::unique_ptr<Compute_function>{clone_impl_options(options)};
   }
-  ~Compute_function() noexcept override = default;
+  ~Compute_function() noexcept override {
+    untrack_dependencies();
+  }
 
 protected:
   void swap(Compute_function &other) noexcept {
     std::scoped_lock const guard{mutex_, other.mutex_};
+    untrack_dependencies();
+    other.untrack_dependencies();
     using std::swap;
     swap(function_, other.function_);
+    swap(dependencies_, other.dependencies_);
+    swap(memo_, other.memo_);
     swap(bound_, other.bound_);
+    swap(in_flight_, other.in_flight_);
+    ++generation_;
+    ++other.generation_;
+    // recomputed once tracked again
+    retract();
+    other.retract();
+    reset_bound();
+    other.reset_bound();
   }
-  Compute_function(Compute_function const &other) noexcept(noexcept(
-      Compute_function{other, other.mutex_.value_
-                                  ? std::make_unique<std::shared_mutex>()
-                                  : nullptr}))
-      : Compute_function(other, other.mutex_.value_
-                                    ? std::make_unique<std::shared_mutex>()
-                                    : nullptr) {}
+  Compute_function(Compute_function const &other)
+      : Compute_function(other, other.mutex_.locking(),
+                         other.in_flight_ != nullptr) {}
   auto operator=(Compute_function const &right) noexcept(
       noexcept(this == &right, swap(right), *this)) -> Compute_function & {
     Compute_function{right}.swap(*this);
     return *this;
   }
   Compute_function(Compute_function &&other) noexcept
-      : mutex_{other.mutex_.value_ ? std::make_unique<std::shared_mutex>()
-                                   : nullptr},
-        function_{std::move(other.function_)}, bound_{std::move(other.bound_)} {
+      : mutex_{make_mutex(other.mutex_.locking())},
+        function_{std::move(other.function_)},
+        dependencies_{std::move(other.dependencies_)},
+        memo_{std::move(other.memo_)}, bound_{std::move(other.bound_)},
+        in_flight_{make_in_flight(other.in_flight_ != nullptr)} {
+    // the result stays with other
+    reset_bound();
   }
   auto operator=(Compute_function &&right) noexcept -> Compute_function & {
     Compute_function{std::move(right)}.swap(*this);
     return *this;
   }
 
-  explicit Compute_function(
-      Compute_function const &other,
-      std::remove_cv_t<decltype(mutex_)>
-          &&mutex) noexcept(noexcept(decltype(mutex_){std::move(mutex)}, void(),
-                                     decltype(function_){other.function_},
-                                     void(), decltype(bound_){other.bound_}))
-      : mutex_{std::move(mutex)}, function_{other.function_},
-        bound_{other.bound_} {}
+  explicit Compute_function(Compute_function const &other, bool concurrent,
+                            bool async)
+      : Compute_function(copy_of(other), concurrent, async) {}
 
 private:
+  explicit Compute_function(Copied &&copied, bool concurrent, bool async)
+      : mutex_{make_mutex(concurrent)},
+        function_{std::move(copied.function_)},
+        dependencies_{std::move(copied.dependencies_)},
+        memo_{std::move(copied.memo_)}, bound_{std::move(copied.bound_)},
+        in_flight_{make_in_flight(async)} {}
   auto clone_impl_options [[nodiscard]] (Compute_options const &options) const
       -> gsl::owner<Compute_function *> override {
     Compute_function::clone_valid_options(options);
-    return new Compute_function{*this,
-                                (options | Compute_option::concurrent).any()
-                                    ? std::make_unique<std::shared_mutex>()
-                                    : nullptr};
+    return new Compute_function{
+        *this, (options & Compute_option::concurrent).any(),
+        (options & Compute_option::async).any()};
   }
 #pragma warning(suppress : 4250)
 };
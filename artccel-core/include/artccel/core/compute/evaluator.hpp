@@ -0,0 +1,39 @@
+#pragma once
+#ifndef GUARD_3F1C8E2A_6B4D_4E7A_9C15_8D2B7A0E6F43
+#define GUARD_3F1C8E2A_6B4D_4E7A_9C15_8D2B7A0E6F43
+
+#include <cstddef> // import std::size_t
+#include <memory>  // import std::shared_ptr, std::unique_ptr
+#include <span>    // import std::span
+
+#include "compute.hpp"           // import Compute_node
+#include <artccel/core/export.h> // import ARTCCEL_CORE_EXPORT
+
+namespace artccel::core::compute {
+class ARTCCEL_CORE_EXPORT Compute_evaluator;
+
+class Compute_evaluator {
+private:
+  class Impl;
+#pragma warning(suppress : 4251)
+  std::unique_ptr<Impl> impl_;
+
+public:
+  // uses std::thread::hardware_concurrency() workers
+  Compute_evaluator();
+  // with zero workers, evaluation happens on the calling thread
+  explicit Compute_evaluator(std::size_t concurrency);
+  ~Compute_evaluator() noexcept;
+  Compute_evaluator(Compute_evaluator const &) = delete;
+  auto operator=(Compute_evaluator const &) = delete;
+  Compute_evaluator(Compute_evaluator &&) = delete;
+  auto operator=(Compute_evaluator &&) = delete;
+
+  auto concurrency [[nodiscard]] () const noexcept -> std::size_t;
+  // evaluates the targets and their transitive dependencies, each node after
+  // all of its dependencies, rethrowing the first exception after the run
+  void evaluate(std::span<std::shared_ptr<Compute_node const> const> targets);
+};
+} // namespace artccel::core::compute
+
+#endif
@@ -0,0 +1,132 @@
+#pragma once
+#ifndef GUARD_E7B20C95_4A1F_4D83_8C6E_19F3D5A04B72
+#define GUARD_E7B20C95_4A1F_4D83_8C6E_19F3D5A04B72
+
+#include <concepts> // import std::convertible_to, std::copyable, std::invocable
+#include <cstddef>     // import std::size_t
+#include <functional>  // import std::invoke
+#include <type_traits> // import std::bool_constant, std::invoke_result_t, std::remove_cv_t
+#include <utility> // import std::index_sequence, std::index_sequence_for, std::move
+
+#include "../util/concepts_extras.hpp" // import util::Invocable_r
+#include "compute.hpp" // import Compute_constant, Compute_function_constant
+
+namespace artccel::core::compute {
+template <std::copyable Ret, Ret Val> struct Constant_expression;
+template <std::copyable Ret, auto Func>
+requires util::Invocable_r<decltype(Func), Ret>
+struct Function_constant_expression;
+template <typename Func, typename... Exprs> struct Fused_expression;
+
+// evaluated without virtual dispatch or allocation, structural so that it can
+// be a template argument, e.g. of Compute_function_constant to rejoin a graph
+template <typename Type>
+concept Compute_expression_c = std::copyable<Type> &&
+    requires(Type const &expr) {
+  typename Type::return_type;
+  { expr() } -> std::convertible_to<typename Type::return_type>;
+};
+
+template <std::copyable Ret, Ret Val> struct Constant_expression {
+  using return_type = Ret;
+  constexpr auto operator() [[nodiscard]] () const
+      noexcept(noexcept(Ret{Val})) -> Ret {
+    return Val;
+  }
+};
+template <std::copyable Ret, auto Func>
+requires util::Invocable_r<decltype(Func), Ret>
+struct Function_constant_expression {
+  using return_type = Ret;
+  constexpr auto operator() [[nodiscard]] () const
+      noexcept(noexcept(Ret{std::invoke(Func)})) -> Ret {
+    return std::invoke(Func);
+  }
+};
+
+namespace detail {
+// matches the node type only, never instantiating it
+template <typename Node> struct Expression_of;
+template <std::copyable Ret, Ret Val>
+struct Expression_of<Compute_constant<Ret, Val>> {
+  using type = Constant_expression<Ret, Val>;
+};
+template <std::copyable Ret, auto Func>
+requires util::Invocable_r<decltype(Func), Ret>
+struct Expression_of<Compute_function_constant<Ret, Func>> {
+  using type = Function_constant_expression<Ret, Func>;
+};
+} // namespace detail
+
+template <typename Node>
+constexpr typename detail::Expression_of<Node>::type expression_of{};
+
+namespace detail {
+// public members keep Fused_expression structural, unlike std::tuple
+template <std::size_t Index, Compute_expression_c Expr> struct Operand {
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  Expr operand_;
+};
+template <typename Indices, typename... Exprs> struct Operands;
+template <std::size_t... Indices, typename... Exprs>
+struct Operands<std::index_sequence<Indices...>, Exprs...>
+    : Operand<Indices, Exprs>... {
+  template <typename Func>
+  constexpr auto apply(Func const &func) const -> decltype(auto) {
+    return std::invoke(func, static_cast<Operand<Indices, Exprs> const &>(*this)
+                                 .operand_()...);
+  }
+};
+} // namespace detail
+
+// func applied to the results of the operands, inlined into one callable
+template <typename Func, typename... Exprs>
+struct Fused_expression
+    : detail::Operands<std::index_sequence_for<Exprs...>, Exprs...> {
+  using return_type =
+      std::invoke_result_t<Func const &, typename Exprs::return_type...>;
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  Func function_;
+
+  constexpr auto operator() [[nodiscard]] () const -> return_type {
+    return this->apply(function_);
+  }
+};
+
+namespace f {
+// func should be pure, the result may be computed at compile time
+template <typename Func, Compute_expression_c... Exprs>
+requires std::copyable<Func> &&
+    std::invocable<Func const &, typename Exprs::return_type...>
+constexpr auto fuse [[nodiscard]] (Func function, Exprs... operands) {
+  return Fused_expression<Func, Exprs...>{{{std::move(operands)}...},
+                                          std::move(function)};
+}
+} // namespace f
+
+template <auto Expr>
+concept Constant_foldable_c =
+    Compute_expression_c<std::remove_cv_t<decltype(Expr)>> &&
+    requires {
+  typename std::bool_constant<(static_cast<void>(Expr()), true)>;
+};
+
+namespace f {
+// replaces the expression by its value if that is a constant expression and
+// can be a template argument
+template <auto Expr>
+requires Compute_expression_c<std::remove_cv_t<decltype(Expr)>>
+constexpr auto fold [[nodiscard]] () noexcept {
+  using return_type = typename decltype(Expr)::return_type;
+  if constexpr (Constant_foldable_c<Expr> && requires {
+                  typename Constant_expression<return_type, Expr()>;
+                }) {
+    return Constant_expression<return_type, Expr()>{};
+  } else {
+    return Expr;
+  }
+}
+} // namespace f
+} // namespace artccel::core::compute
+
+#endif
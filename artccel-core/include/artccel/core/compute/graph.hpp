@@ -0,0 +1,75 @@
+#pragma once
+#ifndef GUARD_9A41C7E3_52D8_4B0F_8E6A_31F7D0C94B25
+#define GUARD_9A41C7E3_52D8_4B0F_8E6A_31F7D0C94B25
+
+#include <cstddef>         // import std::size_t
+#include <memory>          // import std::unique_ptr
+#include <memory_resource> // import std::pmr::memory_resource
+#include <utility>         // import std::exchange, std::forward
+
+#include "compute.hpp" // import Compute_options, detail::graph_resource
+#include <artccel/core/export.h> // import ARTCCEL_CORE_EXPORT
+
+namespace artccel::core::compute {
+class ARTCCEL_CORE_EXPORT Compute_graph;
+
+// owns an arena that nodes, their locks and shared_ptr control blocks are
+// carved from; everything, including weak references, must be released
+// before the graph is destroyed, which then frees the arena at once
+//
+// nodes in the graph may depend on nodes outside of it, which forget them on
+// destruction; nodes outside depending on nodes in it keep those alive, so
+// they must be destroyed before the graph as well
+class Compute_graph {
+private:
+  class Impl;
+#pragma warning(suppress : 4251)
+  std::unique_ptr<Impl> impl_;
+
+  class Scope {
+  private:
+    std::pmr::memory_resource *previous_;
+
+  public:
+    explicit Scope(Compute_graph &graph) noexcept
+        : previous_{std::exchange(detail::graph_resource(),
+                                  &graph.resource())} {}
+    ~Scope() noexcept { detail::graph_resource() = previous_; }
+    Scope(Scope const &) = delete;
+    auto operator=(Scope const &) = delete;
+    Scope(Scope &&) = delete;
+    auto operator=(Scope &&) = delete;
+  };
+
+public:
+  Compute_graph();
+  // reserves initial_size bytes up front
+  explicit Compute_graph(std::size_t initial_size);
+  ~Compute_graph() noexcept;
+  Compute_graph(Compute_graph const &) = delete;
+  auto operator=(Compute_graph const &) = delete;
+  Compute_graph(Compute_graph &&) = delete;
+  auto operator=(Compute_graph &&) = delete;
+
+  // thread-safe, deallocation is a no-op until the graph is destroyed
+  auto resource [[nodiscard]] () noexcept -> std::pmr::memory_resource &;
+
+  template <typename Node, typename... Args>
+  auto create [[nodiscard]] (Args &&...args) {
+    Scope const scope{*this};
+    return Node::create(std::forward<Args>(args)...);
+  }
+  template <typename Node, typename... Args>
+  auto create_const [[nodiscard]] (Args &&...args) {
+    Scope const scope{*this};
+    return Node::create_const(std::forward<Args>(args)...);
+  }
+  template <typename Node>
+  auto clone [[nodiscard]] (Node const &node, Compute_options const &options) {
+    Scope const scope{*this};
+    return node.clone(options);
+  }
+};
+} // namespace artccel::core::compute
+
+#endif
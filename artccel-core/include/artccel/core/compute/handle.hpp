@@ -0,0 +1,68 @@
+#pragma once
+#ifndef GUARD_6B1D9F43_E25A_4C7E_93B8_0F4A7C2E5D16
+#define GUARD_6B1D9F43_E25A_4C7E_93B8_0F4A7C2E5D16
+
+#include <concepts>    // import std::copyable, std::same_as
+#include <type_traits> // import std::common_type_t
+#include <variant>     // import std::variant, std::visit
+
+#include "compute.hpp" // import Compute_in
+
+namespace artccel::core::compute {
+template <typename Derived> class Compute_handle;
+template <typename... Derived> class Compute_variant_handle;
+
+// non-owning, calls the concrete operator() of Derived directly so that it
+// can be inlined; the node must outlive the handle and be exactly a Derived
+template <typename Derived> class Compute_handle {
+public:
+  using return_type = typename Derived::return_type;
+
+private:
+  Derived const *node_;
+
+public:
+  explicit constexpr Compute_handle(
+      Compute_in<Derived, return_type> const &node) noexcept
+      : node_{&static_cast<Derived const &>(node)} {}
+
+  auto operator()() const -> return_type {
+    // qualified, so not a virtual call
+    return node_->Derived::operator()();
+  }
+  constexpr auto node [[nodiscard]] () const noexcept -> Derived const & {
+    return *node_;
+  }
+  friend constexpr auto operator==(Compute_handle const &left,
+                                   Compute_handle const &right) noexcept
+      -> bool = default;
+};
+template <typename Derived, std::copyable Ret>
+Compute_handle(Compute_in<Derived, Ret> const &) -> Compute_handle<Derived>;
+
+// closed set of node types, for heterogeneous batches without a vtable
+template <typename... Derived> class Compute_variant_handle {
+public:
+  using return_type = std::common_type_t<typename Derived::return_type...>;
+
+private:
+  std::variant<Compute_handle<Derived>...> handle_;
+
+public:
+  template <typename Node>
+  requires(std::same_as<Node, Derived> || ...)
+  // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+  constexpr Compute_variant_handle(Compute_handle<Node> handle) noexcept
+      : handle_{handle} {}
+
+  auto operator()() const -> return_type {
+    return std::visit(
+        [](auto const &handle) -> return_type { return handle(); }, handle_);
+  }
+  constexpr auto index [[nodiscard]] () const noexcept {
+    return handle_.index();
+  }
+};
+} // namespace artccel::core::compute
+
+#endif
@@ -0,0 +1,176 @@
+#pragma once
+#ifndef GUARD_A3C7E1D5_6F29_4B80_9E14_D25B8F07C6A3
+#define GUARD_A3C7E1D5_6F29_4B80_9E14_D25B8F07C6A3
+
+#include <algorithm>   // import std::min
+#include <array>       // import std::array
+#include <atomic>      // import std::atomic, std::memory_order_relaxed
+#include <bit>         // import std::bit_width
+#include <chrono>      // import std::chrono::duration_cast, std::chrono::nanoseconds, std::chrono::steady_clock
+#include <concepts>    // import std::invocable
+#include <cstddef>     // import std::size_t
+#include <cstdint>     // import std::uint_fast64_t
+#include <functional>  // import std::invoke
+#include <string>      // import std::u8string
+#include <string_view> // import std::u8string_view
+#include <type_traits> // import std::conditional_t
+#include <utility>     // import std::forward
+#include <vector>      // import std::vector
+
+#include <artccel/core/config.h> // import ARTCCEL_METRICS
+#include <artccel/core/export.h> // import ARTCCEL_CORE_EXPORT
+
+namespace artccel::core::compute {
+struct Compute_metrics_sample;
+
+constexpr inline auto metrics_enabled{ARTCCEL_METRICS != 0};
+// bucket 0 holds 0 ns, bucket i holds [2^(i-1), 2^i) ns, the last one the rest
+constexpr inline std::size_t metrics_latency_buckets{32};
+
+struct Compute_metrics_sample {
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::uint_fast64_t id_{};
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::u8string type_{};
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::u8string label_{};
+  // false for the totals of the destroyed nodes of type_, id_ is then 0
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  bool live_{};
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::uint_fast64_t evaluations_{};
+  // evaluations that did not run the function on the calling thread
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::uint_fast64_t hits_{};
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::uint_fast64_t recomputes_{};
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::array<std::uint_fast64_t, metrics_latency_buckets> latency_{};
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::uint_fast64_t shared_locks_{};
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::chrono::nanoseconds shared_wait_{};
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::uint_fast64_t exclusive_locks_{};
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::chrono::nanoseconds exclusive_wait_{};
+};
+
+namespace detail {
+class ARTCCEL_CORE_EXPORT Node_metrics;
+
+// counters of one node, registered in the process-wide registry for its
+// lifetime; relaxed, so a sample taken while the node is in use may be torn
+// between counters
+class Node_metrics {
+public:
+  using clock_type = std::chrono::steady_clock;
+  using counter_type = std::atomic<std::uint_fast64_t>;
+
+private:
+  std::u8string_view type_;
+  // guarded by the registry mutex
+  std::u8string label_{};
+  std::uint_fast64_t id_{};
+#pragma warning(push)
+#pragma warning(disable : 4251)
+  counter_type evaluations_{0};
+  counter_type recomputes_{0};
+  std::array<counter_type, metrics_latency_buckets> latency_{};
+  counter_type shared_locks_{0};
+  counter_type shared_wait_{0};
+  counter_type exclusive_locks_{0};
+  counter_type exclusive_wait_{0};
+#pragma warning(pop)
+
+  friend class Metrics_registry;
+
+  // call with the registry mutex held
+  auto sample [[nodiscard]] () const -> Compute_metrics_sample;
+  // adds the counters to those of total
+  void accumulate(Compute_metrics_sample &total) const noexcept;
+  static void add(counter_type &counter, std::uint_fast64_t value) noexcept {
+    counter.fetch_add(value, std::memory_order_relaxed);
+  }
+  static auto since [[nodiscard]] (clock_type::time_point start) noexcept {
+    return static_cast<std::uint_fast64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() -
+                                                             start)
+            .count());
+  }
+
+public:
+  // type must have static storage duration
+  explicit Node_metrics(std::u8string_view type);
+  ~Node_metrics() noexcept;
+  Node_metrics(Node_metrics const &) = delete;
+  auto operator=(Node_metrics const &) = delete;
+  Node_metrics(Node_metrics &&) = delete;
+  auto operator=(Node_metrics &&) = delete;
+
+  void label(std::u8string_view label);
+
+  void evaluated() noexcept { add(evaluations_, 1); }
+  template <std::invocable Func> auto recompute(Func &&func) {
+    auto const start{clock_type::now()};
+    auto ret{std::invoke(std::forward<Func>(func))};
+    auto const elapsed{since(start)};
+    add(recomputes_, 1);
+    add(latency_[std::min(static_cast<std::size_t>(std::bit_width(elapsed)),
+                          metrics_latency_buckets - 1)],
+        1);
+    return ret;
+  }
+  // timed only if the node is concurrent, that is mutex is not null
+  template <typename Mutex> void lock_shared(Mutex &mutex) {
+    if (!mutex.locking()) {
+      mutex.lock_shared();
+      return;
+    }
+    auto const start{clock_type::now()};
+    mutex.lock_shared();
+    add(shared_wait_, since(start));
+    add(shared_locks_, 1);
+  }
+  template <typename Mutex> void lock(Mutex &mutex) {
+    if (!mutex.locking()) {
+      mutex.lock();
+      return;
+    }
+    auto const start{clock_type::now()};
+    mutex.lock();
+    add(exclusive_wait_, since(start));
+    add(exclusive_locks_, 1);
+  }
+};
+// compiled in without ARTCCEL_METRICS, takes no space and records nothing
+struct No_metrics {
+  explicit constexpr No_metrics(std::u8string_view type
+                                [[maybe_unused]]) noexcept {}
+
+  constexpr void label(std::u8string_view label [[maybe_unused]]) noexcept {}
+  constexpr void evaluated() noexcept {}
+  template <std::invocable Func> auto recompute(Func &&func) {
+    return std::invoke(std::forward<Func>(func));
+  }
+  template <typename Mutex> static void lock_shared(Mutex &mutex) {
+    mutex.lock_shared();
+  }
+  template <typename Mutex> static void lock(Mutex &mutex) { mutex.lock(); }
+};
+using Metrics = std::conditional_t<metrics_enabled, Node_metrics, No_metrics>;
+} // namespace detail
+
+namespace f {
+// live nodes ordered by id, then the totals of destroyed nodes by type;
+// empty without ARTCCEL_METRICS
+ARTCCEL_CORE_EXPORT auto metrics_samples [[nodiscard]] ()
+    -> std::vector<Compute_metrics_sample>;
+// skip the samples that recorded nothing; list the instrumented locks after
+// the nodes, see util::Instrumented_lockable
+ARTCCEL_CORE_EXPORT auto metrics_text [[nodiscard]] () -> std::u8string;
+ARTCCEL_CORE_EXPORT auto metrics_json [[nodiscard]] () -> std::u8string;
+} // namespace f
+} // namespace artccel::core::compute
+
+#endif
@@ -0,0 +1,212 @@
+#pragma once
+#ifndef GUARD_0C5E8A36_B94D_4F17_A2D8_6E31F7B90C4A
+#define GUARD_0C5E8A36_B94D_4F17_A2D8_6E31F7B90C4A
+
+#include <cassert>      // import assert
+#include <concepts>     // import std::copyable, std::invocable
+#include <functional>   // import std::invoke
+#include <memory>       // import std::make_shared, std::shared_ptr, std::unique_ptr
+#include <mutex>        // import std::scoped_lock
+#include <shared_mutex> // import std::shared_mutex
+#include <tuple>        // import std::tuple
+#include <type_traits>  // import std::remove_cv_t
+#include <utility>      // import std::forward, std::move, std::swap
+
+#pragma warning(push)
+#pragma warning(disable : 4626 4820)
+#include <gsl/gsl> // import gsl::owner
+#pragma warning(pop)
+
+#include "../util/bitset_extras.hpp" // import util::Check_bitset
+#include "../util/clone.hpp" // import util::Cloneable_bases, util::Cloneable_impl
+#include "../util/concepts_extras.hpp" // import util::Invocable_r
+#include "../util/concurrent.hpp"      // import util::Nullable_lockable
+#include "../util/enum_bitset.hpp" // import util::Enum_bitset, util::operators::enum_bitset
+#include "compute.hpp" // import Compute_in, Compute_option, Compute_options, detail::make_mutex, detail::make_node
+
+namespace artccel::core {
+namespace compute {
+template <std::copyable Value> class Compute_shared_value;
+} // namespace compute
+
+namespace util {
+template <std::copyable Value>
+struct Cloneable_bases<compute::Compute_shared_value<Value>> {
+  using self_type = compute::Compute_shared_value<Value>;
+  using type =
+      std::tuple<compute::Compute_in<self_type, std::shared_ptr<Value const>>>;
+  using impl_type = std::tuple<>;
+};
+} // namespace util
+
+namespace compute {
+// publishes immutable snapshots, so a read only copies a std::shared_ptr and so
+// does every dependent or Compute_out storing the result; writers build the
+// next snapshot before locking and release the previous one after unlocking
+template <std::copyable Value>
+// NOLINTNEXTLINE(fuchsia-multiple-inheritance)
+class Compute_shared_value
+    : public virtual util::Cloneable_impl<Compute_shared_value<Value>>,
+      public Compute_in<Compute_shared_value<Value>,
+                        std::shared_ptr<Value const>> {
+  friend util::Cloneable_impl<Compute_shared_value>;
+
+private:
+  enum struct Friend : bool {};
+
+public:
+  using return_type = typename Compute_shared_value::return_type;
+  using value_type = Value;
+  template <typename... Args>
+  explicit Compute_shared_value(
+      Friend tag [[maybe_unused]],
+      Args &&...args) noexcept(noexcept(Compute_shared_value(std::
+                                                                 forward<Args>(
+                                                                     args)...)))
+      : Compute_shared_value(std::forward<Args>(args)...) {}
+
+private:
+  util::Nullable_lockable</* mutable */ std::shared_mutex> const mutex_;
+  std::shared_ptr<Value const> value_; // never null
+
+protected:
+  explicit Compute_shared_value(Value value)
+      : Compute_shared_value(util::Enum_bitset{} | Compute_option::concurrent,
+                             std::move(value)) {}
+  explicit Compute_shared_value(Compute_options const &options, Value value)
+      : Compute_shared_value(options,
+                             std::make_shared<Value const>(std::move(value))) {
+  }
+  explicit Compute_shared_value(Compute_options const &options,
+                                std::shared_ptr<Value const> value)
+      : mutex_{detail::make_mutex(
+            (options & Compute_option::concurrent).any())},
+        value_{std::move(value)} {
+    constexpr static util::Check_bitset valid_options{
+        Compute_option::concurrent};
+    valid_options(options);
+    assert(value_ && u8"value == nullptr");
+  }
+
+private:
+  // returns the previous snapshot, to be released outside the lock
+  auto exchange [[nodiscard]] (std::shared_ptr<Value const> value) {
+    assert(value && u8"value == nullptr");
+    {
+      auto const guard{this->exclusive_guard(mutex_)};
+      using std::swap;
+      swap(value_, value);
+    }
+    this->invalidate_dependents();
+    return value;
+  }
+  template <typename... Args>
+  static auto create_const_0
+      [[nodiscard]] (Compute_options const &options, Args &&...args) {
+    constexpr static util::Check_bitset valid_options{
+        ~Compute_option::concurrent};
+    valid_options(options);
+    return create_const_1(options, std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  static auto create_const_0 [[nodiscard]] (Args &&...args) {
+    return create_const_1(util::Enum_bitset{} | Compute_option::empty,
+                          std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  static auto create_const_1 [[nodiscard]] (Args &&...args) {
+    return detail::make_node<Compute_shared_value const>(
+        Friend{}, std::forward<Args>(args)...);
+  }
+
+public:
+  template <typename... Args>
+  static auto create [[nodiscard]] (Args &&...args) {
+    return detail::make_node<Compute_shared_value>(
+        Friend{}, std::forward<Args>(args)...);
+  }
+  template <typename... Args>
+  static auto create_const [[nodiscard]] (Args &&...args) {
+    return create_const_0(std::forward<Args>(args)...);
+  }
+
+  auto operator() [[nodiscard]] () const -> return_type override {
+    this->metrics_evaluated();
+    auto const guard{this->shared_guard(mutex_)};
+    return value_;
+  }
+  friend auto operator<<(Compute_shared_value &left, Value value)
+      -> return_type {
+    return left.exchange(std::make_shared<Value const>(std::move(value)));
+  }
+  friend auto operator<<(Compute_shared_value &left, return_type value)
+      -> return_type {
+    return left.exchange(std::move(value));
+  }
+  // copy-on-write: publishes func(current), retrying if another writer
+  // published first, so func may be called more than once
+  template <util::Invocable_r<Value, Value const &> Func>
+  auto update(Func &&func) -> return_type {
+    for (auto current{(*this)()};;) {
+      auto next{std::make_shared<Value const>(std::invoke(func, *current))};
+      {
+        auto const guard{this->exclusive_guard(mutex_)};
+        if (value_ == current) {
+          using std::swap;
+          swap(value_, next);
+          break;
+        }
+        current = value_;
+      }
+    }
+    this->invalidate_dependents();
+    return (*this)();
+  }
+
+  using util::Cloneable_impl<Compute_shared_value>::clone;
+  auto clone [[nodiscard]] (Compute_options const &options) const {
+    return std::unique_ptr<Compute_shared_value>{clone_impl_options(options)};
+  }
+  ~Compute_shared_value() noexcept override = default;
+
+protected:
+  void swap(Compute_shared_value &other) noexcept {
+    std::scoped_lock const guard{mutex_, other.mutex_};
+    using std::swap;
+    swap(value_, other.value_);
+  }
+  // shares the snapshot, which is immutable
+  Compute_shared_value(Compute_shared_value const &other)
+      : Compute_shared_value(other,
+                             detail::make_mutex(bool{other.mutex_.value_})) {}
+  auto operator=(Compute_shared_value const &right) -> Compute_shared_value & {
+    Compute_shared_value{right}.swap(*this);
+    return *this;
+  }
+  Compute_shared_value(Compute_shared_value &&other) noexcept
+      : mutex_{detail::make_mutex(bool{other.mutex_.value_})},
+        value_{other.value_} {}
+  auto operator=(Compute_shared_value &&right) noexcept
+      -> Compute_shared_value & {
+    Compute_shared_value{std::move(right)}.swap(*this);
+    return *this;
+  }
+
+  explicit Compute_shared_value(Compute_shared_value const &other,
+                                std::remove_cv_t<decltype(mutex_)> &&mutex)
+      : mutex_{std::move(mutex)}, value_{other()} {}
+
+private:
+  auto clone_impl_options [[nodiscard]] (Compute_options const &options) const
+      -> gsl::owner<Compute_shared_value *> override {
+    Compute_shared_value::clone_valid_options(options);
+    return new Compute_shared_value{
+        *this,
+        detail::make_mutex((options & Compute_option::concurrent).any())};
+  }
+#pragma warning(suppress : 4250)
+};
+} // namespace compute
+} // namespace artccel::core
+
+#endif
@@ -0,0 +1,229 @@
+#pragma once
+#ifndef GUARD_EF86FD68_8EE7_4E22_B23E_FEFE22397926
+#define GUARD_EF86FD68_8EE7_4E22_B23E_FEFE22397926
+
+#include <algorithm>   // import std::ranges::copy
+#include <array>       // import std::array
+#include <bit>         // import std::bit_cast
+#include <concepts>    // import std::copyable, std::default_initializable, std::same_as
+#include <cstddef>     // import std::byte, std::size_t
+#include <cstdint>     // import std::uint64_t, std::uint8_t
+#include <filesystem>  // import std::filesystem::path
+#include <iterator>    // import std::back_inserter
+#include <memory>      // import std::unique_ptr
+#include <optional>    // import std::nullopt, std::optional
+#include <span>        // import std::as_bytes, std::as_writable_bytes, std::span
+#include <string>      // import std::basic_string
+#include <string_view> // import std::u8string_view
+#include <type_traits> // import std::is_member_pointer_v, std::is_null_pointer_v, std::is_pointer_v, std::is_trivially_copyable_v, std::remove_all_extents_t
+#include <utility>     // import std::move
+#include <vector>      // import std::vector
+
+#include "../util/reflect.hpp"   // import util::f::type_name
+#include "compute.hpp"           // import Compute_function, Compute_value
+#include <artccel/core/export.h> // import ARTCCEL_CORE_EXPORT
+
+namespace artccel::core::compute {
+template <typename Type> struct Compute_snapshot_codec;
+class ARTCCEL_CORE_EXPORT Compute_snapshot_writer;
+class ARTCCEL_CORE_EXPORT Compute_snapshot;
+
+namespace detail {
+// copied as bytes, which outlive the process; pointers inside a class cannot
+// be told apart, so trivially copyable classes holding one must specialize
+// Compute_snapshot_codec themselves
+template <typename Type>
+concept Snapshot_bytes_c = std::is_trivially_copyable_v<Type> &&
+    !std::is_pointer_v<std::remove_all_extents_t<Type>> &&
+    !std::is_member_pointer_v<std::remove_all_extents_t<Type>> &&
+    !std::is_null_pointer_v<std::remove_all_extents_t<Type>>;
+} // namespace detail
+
+// specialize to snapshot other types: encode appends the bytes of value, and
+// decode returns std::nullopt for bytes it does not recognize; the bytes
+// outlive the process, so they must not hold addresses
+template <typename Type>
+requires detail::Snapshot_bytes_c<Type>
+struct Compute_snapshot_codec<Type> {
+  static void encode(Type const &value, std::vector<std::byte> &bytes) {
+    std::ranges::copy(std::as_bytes(std::span{&value, 1}),
+                      std::back_inserter(bytes));
+  }
+  static auto decode [[nodiscard]] (std::span<std::byte const> bytes)
+      -> std::optional<Type> {
+    if (bytes.size() != sizeof(Type)) {
+      return std::nullopt;
+    }
+    std::array<std::byte, sizeof(Type)> buffer{};
+    std::ranges::copy(bytes, buffer.begin());
+    return std::bit_cast<Type>(buffer);
+  }
+};
+namespace detail {
+template <typename Container> struct Contiguous_snapshot_codec {
+  using element_type = typename Container::value_type;
+
+  static void encode(Container const &value, std::vector<std::byte> &bytes) {
+    std::ranges::copy(std::as_bytes(std::span{value}),
+                      std::back_inserter(bytes));
+  }
+  static auto decode [[nodiscard]] (std::span<std::byte const> bytes)
+      -> std::optional<Container> {
+    if (bytes.size() % sizeof(element_type) != 0) {
+      return std::nullopt;
+    }
+    Container ret(bytes.size() / sizeof(element_type), element_type{});
+    std::ranges::copy(bytes, std::as_writable_bytes(std::span{ret}).begin());
+    return ret;
+  }
+};
+} // namespace detail
+template <typename Element, typename Allocator>
+requires detail::Snapshot_bytes_c<Element> &&
+    std::default_initializable<Element>
+struct Compute_snapshot_codec<std::vector<Element, Allocator>>
+    : detail::Contiguous_snapshot_codec<std::vector<Element, Allocator>> {};
+template <typename Char, typename Traits, typename Allocator>
+struct Compute_snapshot_codec<std::basic_string<Char, Traits, Allocator>>
+    : detail::Contiguous_snapshot_codec<
+          std::basic_string<Char, Traits, Allocator>> {};
+
+template <typename Type>
+concept Compute_snapshot_c = std::copyable<Type> &&
+    requires(Type const &value, std::vector<std::byte> &bytes,
+             std::span<std::byte const> view) {
+  Compute_snapshot_codec<Type>::encode(value, bytes);
+  {
+    Compute_snapshot_codec<Type>::decode(view)
+    } -> std::same_as<std::optional<Type>>;
+};
+
+namespace detail {
+// FNV-1a of the type name, so a mismatch reads as a miss; names differ
+// between toolchains, which then share no snapshots
+template <typename Type>
+consteval auto snapshot_type [[nodiscard]] () -> std::uint64_t {
+  constexpr std::uint64_t offset_basis{0xCBF29CE484222325};
+  constexpr std::uint64_t prime{0x100000001B3};
+  auto ret{offset_basis};
+  for (auto const chr : util::f::type_name<Type>()) {
+    ret = (ret ^ static_cast<std::uint8_t>(chr)) * prime;
+  }
+  return ret;
+}
+template <Compute_snapshot_c Type>
+auto snapshot_encode [[nodiscard]] (Type const &value) {
+  std::vector<std::byte> ret{};
+  Compute_snapshot_codec<Type>::encode(value, ret);
+  return ret;
+}
+} // namespace detail
+
+// collects the results of nodes under keys that are stable across runs, to
+// be restored by Compute_snapshot, e.g. on the next start
+class Compute_snapshot_writer {
+private:
+  class Impl;
+#pragma warning(suppress : 4251)
+  std::unique_ptr<Impl> impl_;
+
+  void add(std::u8string_view key, std::uint64_t type,
+           std::vector<std::byte> data);
+
+public:
+  // schema identifies the layout of the graph, a mismatch discards the
+  // snapshot when restoring
+  explicit Compute_snapshot_writer(std::uint64_t schema);
+  ~Compute_snapshot_writer() noexcept;
+  Compute_snapshot_writer(Compute_snapshot_writer const &) = delete;
+  auto operator=(Compute_snapshot_writer const &) = delete;
+  Compute_snapshot_writer(Compute_snapshot_writer &&) noexcept;
+  auto operator=(Compute_snapshot_writer &&) noexcept
+      -> Compute_snapshot_writer &;
+
+  // saving under a key again replaces the previous result
+  template <Compute_snapshot_c Ret, typename Lock>
+  void save(std::u8string_view key, Compute_value<Ret, Lock> const &node) {
+    add(key, detail::snapshot_type<Ret>(), detail::snapshot_encode(node()));
+  }
+  // saves nothing and returns false if the node has no result, never
+  // computing it
+  template <Compute_snapshot_c Ret, typename... TArgs, std::size_t Capacity,
+            typename Lock>
+  auto save(std::u8string_view key,
+            Compute_function<Ret(TArgs...), Capacity, Lock> const &node)
+      -> bool {
+    auto const value{node.cached()};
+    if (!value) {
+      return false;
+    }
+    add(key, detail::snapshot_type<Ret>(), detail::snapshot_encode(*value));
+    return true;
+  }
+  // replaces the file at once by renaming a temporary file next to it
+  void write(std::filesystem::path const &path) const;
+};
+
+// maps a file written by Compute_snapshot_writer, restoring copies out of
+// it; restore inputs before the nodes computed from them, as restoring a
+// node invalidates its dependents, and write the inputs that changed since
+// afterwards, so that only what depends on them recomputes
+class Compute_snapshot {
+private:
+  class Impl;
+#pragma warning(suppress : 4251)
+  std::unique_ptr<Impl> impl_;
+
+  auto find [[nodiscard]] (std::u8string_view key, std::uint64_t type) const
+      -> std::optional<std::span<std::byte const>>;
+  template <Compute_snapshot_c Type>
+  auto decode [[nodiscard]] (std::u8string_view key) const
+      -> std::optional<Type> {
+    if (auto const bytes{find(key, detail::snapshot_type<Type>())}) {
+      return Compute_snapshot_codec<Type>::decode(*bytes);
+    }
+    return std::nullopt;
+  }
+
+public:
+  // a missing file, or one of another format or schema, is empty; other
+  // errors throw std::system_error
+  explicit Compute_snapshot(std::filesystem::path const &path,
+                            std::uint64_t schema);
+  ~Compute_snapshot() noexcept;
+  Compute_snapshot(Compute_snapshot const &) = delete;
+  auto operator=(Compute_snapshot const &) = delete;
+  Compute_snapshot(Compute_snapshot &&) noexcept;
+  auto operator=(Compute_snapshot &&) noexcept -> Compute_snapshot &;
+
+  auto size [[nodiscard]] () const noexcept -> std::size_t;
+  // returns false, leaving the node as is, if key is missing or was saved
+  // from another type
+  template <Compute_snapshot_c Ret, typename Lock>
+  auto restore(std::u8string_view key, Compute_value<Ret, Lock> &node) const
+      -> bool {
+    auto value{decode<Ret>(key)};
+    if (!value) {
+      return false;
+    }
+    node.restore(*std::move(value));
+    return true;
+  }
+  // the result is kept until the arguments are invalidated or rebound, as
+  // if computed from the current ones
+  template <Compute_snapshot_c Ret, typename... TArgs, std::size_t Capacity,
+            typename Lock>
+  auto restore(std::u8string_view key,
+               Compute_function<Ret(TArgs...), Capacity, Lock> &node) const
+      -> bool {
+    auto value{decode<Ret>(key)};
+    if (!value) {
+      return false;
+    }
+    node.restore(*std::move(value));
+    return true;
+  }
+};
+} // namespace artccel::core::compute
+
+#endif
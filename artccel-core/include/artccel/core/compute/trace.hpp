@@ -0,0 +1,77 @@
+#pragma once
+#ifndef GUARD_5D18B6F2_C7A4_4E93_8F0B_3E9A26D1C74F
+#define GUARD_5D18B6F2_C7A4_4E93_8F0B_3E9A26D1C74F
+
+#include <atomic>      // import std::atomic, std::memory_order_relaxed
+#include <chrono>      // import std::chrono::steady_clock
+#include <filesystem>  // import std::filesystem::path
+#include <string_view> // import std::u8string_view
+
+#include <artccel/core/export.h> // import ARTCCEL_CORE_EXPORT
+
+namespace artccel::core::compute {
+namespace detail {
+struct Trace_event;
+class Trace_scope;
+
+using trace_clock = std::chrono::steady_clock;
+
+struct Trace_event {
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  char8_t const *name_; // static storage duration
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  void const *node_;
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::u8string_view type_; // static storage duration
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  trace_clock::time_point begin_;
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  trace_clock::time_point end_;
+};
+
+// a variable rather than an accessor, so that checking it takes no call
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+ARTCCEL_CORE_EXPORT extern std::atomic<bool> tracing;
+// ends event now and appends it to the buffer of this thread, dropping it if
+// the buffer is full
+ARTCCEL_CORE_EXPORT void trace(Trace_event &event) noexcept;
+
+// records the time from construction to destruction, checking whether
+// tracing is on only when constructed
+class Trace_scope {
+private:
+  bool active_;
+  Trace_event event_{};
+
+public:
+  explicit Trace_scope(char8_t const *name, void const *node,
+                       std::u8string_view type, bool active = true) noexcept
+      : active_{active && tracing.load(std::memory_order_relaxed)} {
+    if (active_) [[unlikely]] {
+      event_ = {name, node, type, trace_clock::now(), {}};
+    }
+  }
+  ~Trace_scope() noexcept {
+    if (active_) [[unlikely]] {
+      trace(event_);
+    }
+  }
+  Trace_scope(Trace_scope const &) = delete;
+  auto operator=(Trace_scope const &) = delete;
+  Trace_scope(Trace_scope &&) = delete;
+  auto operator=(Trace_scope &&) = delete;
+};
+} // namespace detail
+
+namespace f {
+// events are buffered per thread until written; a thread records at most a
+// fixed number of events between two writes, dropping the rest
+ARTCCEL_CORE_EXPORT void start_trace() noexcept;
+ARTCCEL_CORE_EXPORT void stop_trace() noexcept;
+// moves the buffered events into a Chrome Trace Event file, which Perfetto
+// also opens; throws std::ios_base::failure
+ARTCCEL_CORE_EXPORT void write_trace(std::filesystem::path const &path);
+} // namespace f
+} // namespace artccel::core::compute
+
+#endif
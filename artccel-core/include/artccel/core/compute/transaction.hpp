@@ -0,0 +1,96 @@
+#pragma once
+#ifndef GUARD_5D2E9B47_1C8A_4F36_A0E3_7B64C9D12F58
+#define GUARD_5D2E9B47_1C8A_4F36_A0E3_7B64C9D12F58
+
+#include <concepts>    // import std::copyable
+#include <cstdint>     // import std::uint_fast8_t
+#include <optional>    // import std::optional
+#include <type_traits> // import std::is_nothrow_swappable_v
+#include <utility>     // import std::exchange, std::move, std::swap
+#include <vector>      // import std::vector
+
+#include "../util/concurrent.hpp" // import util::Snapshot_cell
+#include "../util/polyfill.hpp"   // import util::Move_only_function
+#include "compute.hpp"            // import Compute_node, Compute_value
+#include <artccel/core/export.h>  // import ARTCCEL_CORE_EXPORT
+
+namespace artccel::core::compute {
+class Compute_transaction {
+private:
+  // type-erased, as the lock policy of each target may differ
+  struct Mutex {
+    void const *mutex_;
+    void (*lock_)(void const *mutex);
+    void (*unlock_)(void const *mutex) noexcept;
+  };
+  // a write is run once per phase, in order: prepare before the locks are
+  // taken, apply, which must not throw, under them, and retire after them
+  enum struct Phase : std::uint_fast8_t { prepare, apply, retire };
+  struct Write {
+    Compute_node const *target_;
+    Mutex mutex_;
+    util::Move_only_function<void(Phase)> run_;
+  };
+#pragma warning(suppress : 4251)
+  std::vector<Write> writes_{};
+
+public:
+  Compute_transaction() noexcept;
+  ~Compute_transaction() noexcept;
+  Compute_transaction(Compute_transaction const &) = delete;
+  auto operator=(Compute_transaction const &) = delete;
+  Compute_transaction(Compute_transaction &&) noexcept;
+  auto operator=(Compute_transaction &&) noexcept -> Compute_transaction &;
+
+  // the target must outlive the commit, later writes to it win
+  template <std::copyable Ret, typename Lock>
+  requires std::is_nothrow_swappable_v<Ret>
+  void stage(Compute_value<Ret, Lock> &target, Ret value) {
+    using mutex_type = decltype(target.mutex_);
+    using snapshot_type = util::Snapshot_cell<Ret>;
+    writes_.emplace_back(Write{
+        &target,
+        {&target.mutex_,
+         [](void const *mutex) {
+           static_cast<mutex_type *>(mutex)->lock();
+         },
+         [](void const *mutex) noexcept {
+           static_cast<mutex_type *>(mutex)->unlock();
+         }},
+        [&target, value{std::move(value)},
+         prepared{std::optional<typename snapshot_type::prepared_type>{}},
+         retired{static_cast<Ret const *>(nullptr)}](Phase phase) mutable {
+          switch (phase) {
+          case Phase::prepare:
+            if (target.snapshot_) {
+              prepared.emplace(snapshot_type::prepare(value));
+            }
+            break;
+          case Phase::apply:
+            // the previous value is destroyed with the write, after the locks
+            using std::swap;
+            swap(target.value_, value);
+            if (prepared) {
+              retired = target.snapshot_->install(std::move(*prepared));
+            }
+            break;
+          case Phase::retire:
+            if (prepared) {
+              snapshot_type::retire(std::exchange(retired, nullptr));
+            }
+            break;
+          }
+        }});
+  }
+  auto empty [[nodiscard]] () const noexcept -> bool;
+  // publishes every staged write at once: once a reader sees one of them, it
+  // sees all, and readers going through f::read_consistent, including
+  // Compute_function, see no result cached before the commit either;
+  // dependents are invalidated once per target, only readers of values
+  // sharing a commit stripe with a target wait on it; if preparing a write
+  // throws, for example on allocation, nothing is published
+  void commit();
+};
+} // namespace artccel::core::compute
+
+#endif
@@ -6,6 +6,8 @@
 
 namespace artccel::core::platform::windows::f {
 void throw_last_error [[noreturn]] ();
+// for an error saved by ::GetLastError before cleaning up
+void throw_error [[noreturn]] (unsigned long error);
 void print_last_error();
 } // namespace artccel::core::platform::windows::f
 
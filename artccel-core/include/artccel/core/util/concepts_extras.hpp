@@ -2,8 +2,9 @@
 #ifndef GUARD_7E8E1598_4DA2_472F_908C_B6F29BE0389F
 #define GUARD_7E8E1598_4DA2_472F_908C_B6F29BE0389F
 
-#include <concepts>    // import std::derived_from, std::same_as
-#include <cstddef>     // import std::size_t
+#include <concepts> // import std::convertible_to, std::derived_from, std::equality_comparable, std::same_as
+#include <cstddef>    // import std::size_t
+#include <functional> // import std::hash
 #include <span>        // import std::dynamic_extent
 #include <type_traits> // import std::is_arithmetic_v, std::is_enum_v, std::is_invocable_r_v, std::remove_cvref_t
 #include <utility>     // import std::forward
@@ -43,6 +44,11 @@ template <typename Func, typename Ret, typename... ArgTypes>
 concept Invocable_r = std::is_invocable_r_v<Ret, Func, ArgTypes...>;
 template <typename Func, typename Ret, typename... ArgTypes>
 concept Regular_invocable_r = Invocable_r<Func, Ret, ArgTypes...>;
+template <typename Type>
+concept Hashable = std::equality_comparable<Type> &&
+    requires(Type const &value) {
+  { std::hash<Type>{}(value) } -> std::convertible_to<std::size_t>;
+};
 
 template <typename ForwardType, typename ThisType>
 concept Guard_special_constructors =
@@ -2,74 +2,229 @@
 #ifndef GUARD_E4462344_3D02_4011_8109_D2998F468F32
 #define GUARD_E4462344_3D02_4011_8109_D2998F468F32
 
-#include <chrono>   // import std::chrono::duration, std::chrono::time_point
-#include <concepts> // import std::invocable, std::semiregular, std::same_as
-#include <memory>   // import std::make_unique, std::unique_ptr
-#include <mutex> // import std::call_once, std::mutex, std::once_flag, std::recursive_mutex, std::recursive_timed_mutex, std::timed_mutex
+#include <array> // import std::array
+#include <atomic> // import std::atomic, std::atomic_thread_fence, std::memory_order_acquire, std::memory_order_relaxed, std::memory_order_release, std::memory_order_seq_cst
+#include <bit>    // import std::bit_cast
+#include <chrono> // import std::chrono::duration, std::chrono::steady_clock, std::chrono::time_point
+#include <concepts> // import std::copyable, std::invocable, std::semiregular, std::same_as
+#include <cstddef>  // import std::byte, std::size_t
+#include <cstdint> // import std::uint_fast32_t, std::uint_fast64_t, std::uint_fast8_t, std::uintptr_t
+#include <cstring>  // import std::memcpy
+#include <exception>  // import std::exception_ptr
+#include <functional> // import std::invoke
+#include <memory> // import std::construct_at, std::default_delete, std::destroy_at, std::make_unique, std::unique_ptr
+#include <memory_resource> // import std::pmr::memory_resource, std::pmr::polymorphic_allocator
+#include <condition_variable> // import std::condition_variable
+#include <mutex> // import std::mutex, std::recursive_mutex, std::recursive_timed_mutex, std::timed_mutex
+#include <optional> // import std::nullopt, std::optional
 #include <shared_mutex> // import std::shared_mutex, std::shared_timed_mutex
-#include <utility> // import std::declval, std::forward, std::move, std::swap
+#include <span>         // import std::span
+#include <string>       // import std::u8string
+#include <string_view>  // import std::u8string_view
+#include <thread>       // import std::this_thread::yield
+#include <type_traits> // import std::conditional_t, std::is_trivially_copyable_v
+#include <utility> // import std::declval, std::exchange, std::forward, std::move, std::swap
+#include <vector>  // import std::vector
 
+#include "polyfill.hpp"       // import Move_only_function
+#include "reflect.hpp"        // import f::type_name
 #include "utility_extras.hpp" // import Delegate, Initialize_t
+#include <artccel/core/config.h> // import ARTCCEL_METRICS
 #include <artccel/core/export.h> // import ARTCCEL_CORE_EXPORT, ARTCCEL_CORE_EXPORT_DECLARATION
 
 namespace artccel::core::util {
 class ARTCCEL_CORE_EXPORT Semiregular_once_flag;
 struct ARTCCEL_CORE_EXPORT Null_lockable;
+template <typename Lock> struct Lockable_deleter;
 template <typename Lock, typename NullLock = Null_lockable>
 class Nullable_lockable;
+class Spin_shared_mutex;
+class ARTCCEL_CORE_EXPORT Striped_shared_mutex;
+template <typename Lock> class Inline_lockable;
+struct Lock_metrics_sample;
+class ARTCCEL_CORE_EXPORT Epoch_guard;
+template <std::copyable Type> class Snapshot_cell;
+template <std::copyable Type> class Result_cell;
+class Task;
+class ARTCCEL_CORE_EXPORT Task_executor;
+class ARTCCEL_CORE_EXPORT Task_group;
 
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wpadded"
+constexpr inline std::size_t cache_line_size{64};
+
+namespace f {
+// reclaims ptr once no Epoch_guard entered before the call is alive
+ARTCCEL_CORE_EXPORT void epoch_retire(void const *ptr,
+                                      void (*deleter)(void const *) noexcept);
+template <typename Type> void epoch_retire(Type const *ptr) {
+  epoch_retire(static_cast<void const *>(ptr),
+               [](void const *retired) noexcept {
+                 // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+                 delete static_cast<Type const *>(retired);
+               });
+}
+} // namespace f
+
+template <typename Lock> struct Lockable_deleter {
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::pmr::memory_resource *resource_{nullptr}; // nullptr: use delete
+
+  constexpr Lockable_deleter() noexcept = default;
+  explicit constexpr Lockable_deleter(
+      std::pmr::memory_resource *resource) noexcept
+      : resource_{resource} {}
+  // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+  constexpr Lockable_deleter(std::default_delete<Lock> deleter
+                             [[maybe_unused]]) noexcept {}
+  void operator()(Lock *ptr) const noexcept {
+    if (resource_ == nullptr) {
+      // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+      delete ptr;
+      return;
+    }
+    std::pmr::polymorphic_allocator<Lock> allocator{resource_};
+    std::destroy_at(ptr);
+    allocator.deallocate(ptr, 1);
+  }
+};
+
+namespace f {
+template <typename Lock>
+auto make_lockable [[nodiscard]] (std::pmr::memory_resource *resource)
+    -> std::unique_ptr<Lock, Lockable_deleter<Lock>> {
+  if (resource == nullptr) {
+    return std::make_unique<Lock>();
+  }
+  std::pmr::polymorphic_allocator<Lock> allocator{resource};
+  auto *const ptr{allocator.allocate(1)};
+  try {
+    std::construct_at(ptr);
+  } catch (...) {
+    allocator.deallocate(ptr, 1);
+    throw;
+  }
+  return std::unique_ptr<Lock, Lockable_deleter<Lock>>{
+      ptr, Lockable_deleter<Lock>{resource}};
+}
+} // namespace f
+
+// std::once_flag that is copyable and movable, copying whether it was called
+// and resettable by assigning a new one; inline, waiting on the atomic state
 class Semiregular_once_flag {
-#pragma clang diagnostic pop
 private:
-#pragma warning(suppress : 4251)
-  std::unique_ptr</* mutable */ std::once_flag> value_{
-      std::make_unique<std::once_flag>()};
-  bool flag_{false};
+  enum struct State : std::uint_fast32_t { idle, running, waiting, done };
+  // the state in the low bits, under a generation bumped by every assignment,
+  // so that a call outlived by an assignment cannot finish the new one
+  using word_type = std::uint_fast32_t;
+  constexpr static word_type state_mask_{0b11};
+  constexpr static word_type generation_step_{state_mask_ + 1};
+  std::atomic<word_type> word_{static_cast<word_type>(State::idle)};
+
+  constexpr static auto state_of [[nodiscard]] (word_type word) noexcept {
+    return static_cast<State>(word & state_mask_);
+  }
+  constexpr static auto with [[nodiscard]] (word_type word,
+                                            State state) noexcept {
+    return (word & ~state_mask_) | static_cast<word_type>(state);
+  }
+  // running is the word the call was started with
+  void finish(word_type running, State state) noexcept {
+    auto word{running};
+    while (!word_.compare_exchange_weak(word, with(running, state),
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+      if ((word & ~state_mask_) != (running & ~state_mask_)) {
+        return; // assigned meanwhile, which woke the waiting callers
+      }
+    }
+    if (state_of(word) == State::waiting) {
+      word_.notify_all();
+    }
+  }
+  auto load [[nodiscard]] () const noexcept {
+    auto const state{state_of(word_.load(std::memory_order_acquire))};
+    return state == State::done ? State::done : State::idle;
+  }
+  void assign(State state) noexcept {
+    auto word{word_.load(std::memory_order_relaxed)};
+    while (!word_.compare_exchange_weak(
+        word, with(word + generation_step_, state), std::memory_order_acq_rel,
+        std::memory_order_relaxed)) {
+    }
+    if (state_of(word) == State::waiting) {
+      word_.notify_all();
+    }
+  }
 
 public:
   constexpr Semiregular_once_flag() noexcept = default;
+  // if true, what the call wrote happens before
+  auto called [[nodiscard]] () const noexcept {
+    return load() == State::done;
+  }
+  // if func throws, the flag is left uncalled and one waiting caller retries
   template <typename... Args, std::invocable<Args...> Func>
   void call_once(Func &&func, Args &&...args) {
-    std::call_once(
-        *value_, [this, &func, &args...]() noexcept(noexcept(std::invoke(
-                     std::forward<Func>(func), std::forward<Args>(args)...))) {
-          std::invoke(std::forward<Func>(func), std::forward<Args>(args)...);
-          flag_ = true; // after invocation because std::invoke may throw
-        });
+    for (auto word{word_.load(std::memory_order_acquire)};;) {
+      switch (state_of(word)) {
+      case State::done:
+        return;
+      case State::idle:
+        if (auto const running{with(word, State::running)};
+            word_.compare_exchange_weak(word, running,
+                                        std::memory_order_acquire,
+                                        std::memory_order_acquire)) {
+          try {
+            std::invoke(std::forward<Func>(func), std::forward<Args>(args)...);
+          } catch (...) {
+            finish(running, State::idle);
+            throw;
+          }
+          finish(running, State::done);
+          return;
+        }
+        continue;
+      case State::running:
+        if (!word_.compare_exchange_weak(word, with(word, State::waiting),
+                                         std::memory_order_acquire,
+                                         std::memory_order_acquire)) {
+          continue;
+        }
+        word = with(word, State::waiting);
+        break;
+      case State::waiting:
+        break;
+      }
+      word_.wait(word, std::memory_order_acquire);
+      word = word_.load(std::memory_order_acquire);
+    }
   }
 
   ~Semiregular_once_flag() noexcept = default;
+  // not while either is being called
   void swap(Semiregular_once_flag &other) noexcept {
-    using std::swap;
-    swap(value_, other.value_);
-    swap(flag_, other.flag_);
+    auto const state{load()};
+    assign(other.load());
+    other.assign(state);
   }
   friend void swap(Semiregular_once_flag &left,
                    Semiregular_once_flag &right) noexcept {
     left.swap(right);
   }
-  Semiregular_once_flag(Semiregular_once_flag const &other)
-      : flag_{other.flag_} {
-    if (flag_) {
-      std::call_once(*value_, []() noexcept {});
-    }
-  }
-  auto operator=(Semiregular_once_flag const &right) noexcept(noexcept(
-      static_cast<void>(Semiregular_once_flag{right}.swap(*this)), *this))
+  Semiregular_once_flag(Semiregular_once_flag const &other) noexcept
+      : word_{static_cast<word_type>(other.load())} {}
+  // callers waiting on this flag wake up and call again, and a call still
+  // running finishes without touching it
+  auto operator=(Semiregular_once_flag const &right) noexcept
       -> Semiregular_once_flag & {
-    Semiregular_once_flag{right}.swap(*this);
+    assign(right.load());
     return *this;
   }
   Semiregular_once_flag(Semiregular_once_flag &&other) noexcept
-      : value_{std::move(other.value_)}, flag_{other.flag_} {}
+      : Semiregular_once_flag{other} {}
   auto operator=(Semiregular_once_flag &&right) noexcept
       -> Semiregular_once_flag & {
-    Semiregular_once_flag{std::move(right)}.swap(*this);
-    return *this;
+    return *this = right;
   }
-#pragma warning(suppress : 4820)
 };
 static_assert(std::semiregular<Semiregular_once_flag>,
               u8"Implementation error");
@@ -77,6 +232,9 @@ static_assert(std::semiregular<Semiregular_once_flag>,
 struct Null_lockable {
   consteval Null_lockable() noexcept = default;
 
+  // whether locking does anything
+  constexpr static auto locking [[nodiscard]] () noexcept { return false; }
+
   // named requirement: BasicLockable
 
   constexpr void lock() const noexcept {}
@@ -131,7 +289,9 @@ struct Null_lockable {
 
 template <typename Lock, typename NullLock>
 #pragma warning(suppress : 4251)
-class Nullable_lockable : public Delegate<std::unique_ptr</* mutable */ Lock>> {
+class Nullable_lockable
+    : public Delegate<
+          std::unique_ptr</* mutable */ Lock, Lockable_deleter<Lock>>> {
 public:
   using type = typename Nullable_lockable::type;
   using lockable_type = Lock;
@@ -159,6 +319,10 @@ public:
       -> Nullable_lockable & = default;
   constexpr ~Nullable_lockable() noexcept = default;
 
+  constexpr auto locking [[nodiscard]] () const noexcept -> bool {
+    return bool{this->value_};
+  }
+
   // named requirement: BasicLockable
 
   template <typename = void>
@@ -342,6 +506,851 @@ public:
     return null_lockable_.try_lock_shared_until(abs_time);
   }
 };
+
+// reader-writer spin lock small enough to sit next to the data it guards,
+// for short critical sections; a waiting writer holds off new readers
+class Spin_shared_mutex {
+private:
+  using state_type = std::uint_fast32_t;
+  constexpr static state_type writer_{1};
+  constexpr static state_type pending_{2}; // a writer is waiting
+  constexpr static state_type reader_{4};
+  std::atomic<state_type> state_{0};
+
+public:
+  constexpr Spin_shared_mutex() noexcept = default;
+  ~Spin_shared_mutex() noexcept = default;
+  Spin_shared_mutex(Spin_shared_mutex const &) = delete;
+  auto operator=(Spin_shared_mutex const &) = delete;
+  Spin_shared_mutex(Spin_shared_mutex &&) = delete;
+  auto operator=(Spin_shared_mutex &&) = delete;
+
+  // named requirement: BasicLockable <- Lockable <- TimedLockable
+
+  auto try_lock [[nodiscard]] () noexcept {
+    auto state{state_.load(std::memory_order_relaxed)};
+    return (state & ~pending_) == 0 &&
+           state_.compare_exchange_strong(state, writer_,
+                                          std::memory_order_acquire,
+                                          std::memory_order_relaxed);
+  }
+  void lock() noexcept {
+    while (!try_lock()) {
+      state_.fetch_or(pending_, std::memory_order_relaxed);
+      std::this_thread::yield();
+    }
+  }
+  void unlock() noexcept {
+    state_.fetch_sub(writer_, std::memory_order_release);
+  }
+  template <typename Clock, typename Duration>
+  auto try_lock_until
+      [[nodiscard]] (std::chrono::time_point<Clock, Duration> const &abs_time)
+      -> bool {
+    while (!try_lock()) {
+      if (Clock::now() >= abs_time) {
+        return false;
+      }
+      std::this_thread::yield();
+    }
+    return true;
+  }
+  template <typename Rep, typename Period>
+  auto try_lock_for
+      [[nodiscard]] (std::chrono::duration<Rep, Period> const &rel_time)
+      -> bool {
+    return try_lock_until(std::chrono::steady_clock::now() + rel_time);
+  }
+
+  // named requirement: SharedLockable <- SharedTimedLockable
+
+  auto try_lock_shared [[nodiscard]] () noexcept {
+    auto state{state_.load(std::memory_order_relaxed)};
+    while ((state & (writer_ | pending_)) == 0) {
+      if (state_.compare_exchange_weak(state, state + reader_,
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  void lock_shared() noexcept {
+    while (!try_lock_shared()) {
+      std::this_thread::yield();
+    }
+  }
+  void unlock_shared() noexcept {
+    state_.fetch_sub(reader_, std::memory_order_release);
+  }
+  template <typename Clock, typename Duration>
+  auto try_lock_shared_until
+      [[nodiscard]] (std::chrono::time_point<Clock, Duration> const &abs_time)
+      -> bool {
+    while (!try_lock_shared()) {
+      if (Clock::now() >= abs_time) {
+        return false;
+      }
+      std::this_thread::yield();
+    }
+    return true;
+  }
+  template <typename Rep, typename Period>
+  auto try_lock_shared_for
+      [[nodiscard]] (std::chrono::duration<Rep, Period> const &rel_time)
+      -> bool {
+    return try_lock_shared_until(std::chrono::steady_clock::now() + rel_time);
+  }
+};
+
+// reader-writer lock for read-mostly data: a reader counts itself on the
+// cache line of its thread, so that readers on different cores write no
+// shared line, and a writer waits for every line to drain; a waiting writer
+// holds off new readers, and shared locks must be released by the thread that
+// took them, as with std::shared_mutex
+class Striped_shared_mutex {
+private:
+  struct alignas(cache_line_size) Stripe {
+    std::atomic<std::size_t> readers_{0};
+  };
+
+  // serializes the writers, held for the whole exclusive lock
+  std::timed_mutex writer_mutex_{};
+  alignas(cache_line_size) std::atomic<bool> writer_{false};
+  std::size_t mask_;
+#pragma warning(suppress : 4251)
+  std::unique_ptr<Stripe[]> stripes_;
+
+  auto stripe [[nodiscard]] () const noexcept -> Stripe &;
+  auto drained [[nodiscard]] () const noexcept -> bool;
+
+public:
+  // one stripe per hardware thread, up to a fixed maximum
+  Striped_shared_mutex();
+  ~Striped_shared_mutex() noexcept;
+  Striped_shared_mutex(Striped_shared_mutex const &) = delete;
+  auto operator=(Striped_shared_mutex const &) = delete;
+  Striped_shared_mutex(Striped_shared_mutex &&) = delete;
+  auto operator=(Striped_shared_mutex &&) = delete;
+
+  // named requirement: BasicLockable <- Lockable <- TimedLockable
+
+  auto try_lock [[nodiscard]] () -> bool;
+  void lock();
+  void unlock() noexcept;
+  template <typename Clock, typename Duration>
+  auto try_lock_until
+      [[nodiscard]] (std::chrono::time_point<Clock, Duration> const &abs_time)
+      -> bool {
+    if (!writer_mutex_.try_lock_until(abs_time)) {
+      return false;
+    }
+    writer_.store(true, std::memory_order_seq_cst);
+    while (!drained()) {
+      if (Clock::now() >= abs_time) {
+        unlock();
+        return false;
+      }
+      std::this_thread::yield();
+    }
+    return true;
+  }
+  template <typename Rep, typename Period>
+  auto try_lock_for
+      [[nodiscard]] (std::chrono::duration<Rep, Period> const &rel_time)
+      -> bool {
+    return try_lock_until(std::chrono::steady_clock::now() + rel_time);
+  }
+
+  // named requirement: SharedLockable <- SharedTimedLockable
+
+  auto try_lock_shared [[nodiscard]] () noexcept -> bool;
+  void lock_shared() noexcept;
+  void unlock_shared() noexcept;
+  template <typename Clock, typename Duration>
+  auto try_lock_shared_until
+      [[nodiscard]] (std::chrono::time_point<Clock, Duration> const &abs_time)
+      -> bool {
+    while (!try_lock_shared()) {
+      if (Clock::now() >= abs_time) {
+        return false;
+      }
+      std::this_thread::yield();
+    }
+    return true;
+  }
+  template <typename Rep, typename Period>
+  auto try_lock_shared_for
+      [[nodiscard]] (std::chrono::duration<Rep, Period> const &rel_time)
+      -> bool {
+    return try_lock_shared_until(std::chrono::steady_clock::now() + rel_time);
+  }
+#pragma warning(suppress : 4324)
+};
+
+// holds Lock by value and always locks it; const like Nullable_lockable, so
+// that const members of the owner can lock
+template <typename Lock> class Inline_lockable {
+public:
+  using lockable_type = Lock;
+
+private:
+  mutable Lock lock_{};
+
+public:
+  Inline_lockable() = default;
+  ~Inline_lockable() noexcept = default;
+  Inline_lockable(Inline_lockable const &) = delete;
+  auto operator=(Inline_lockable const &) = delete;
+  Inline_lockable(Inline_lockable &&) = delete;
+  auto operator=(Inline_lockable &&) = delete;
+
+  constexpr static auto locking [[nodiscard]] () noexcept { return true; }
+
+  void lock() const { lock_.lock(); }
+  void unlock() const { lock_.unlock(); }
+  auto try_lock [[nodiscard]] () const -> bool { return lock_.try_lock(); }
+  template <typename Clock, typename Duration>
+  auto try_lock_until
+      [[nodiscard]] (std::chrono::time_point<Clock, Duration> const &abs_time)
+      const -> bool {
+    return lock_.try_lock_until(abs_time);
+  }
+  template <typename Rep, typename Period>
+  auto try_lock_for
+      [[nodiscard]] (std::chrono::duration<Rep, Period> const &rel_time) const
+      -> bool {
+    return lock_.try_lock_for(rel_time);
+  }
+
+  void lock_shared() const { lock_.lock_shared(); }
+  void unlock_shared() const { lock_.unlock_shared(); }
+  auto try_lock_shared [[nodiscard]] () const -> bool {
+    return lock_.try_lock_shared();
+  }
+  template <typename Clock, typename Duration>
+  auto try_lock_shared_until
+      [[nodiscard]] (std::chrono::time_point<Clock, Duration> const &abs_time)
+      const -> bool {
+    return lock_.try_lock_shared_until(abs_time);
+  }
+  template <typename Rep, typename Period>
+  auto try_lock_shared_for
+      [[nodiscard]] (std::chrono::duration<Rep, Period> const &rel_time) const
+      -> bool {
+    return lock_.try_lock_shared_for(rel_time);
+  }
+};
+
+constexpr inline auto lock_metrics_enabled{ARTCCEL_METRICS != 0};
+// bucket 0 holds 0 ns, bucket i holds [2^(i-1), 2^i) ns, the last one the rest
+constexpr inline std::size_t lock_histogram_buckets{32};
+
+struct Lock_metrics_sample {
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::uint_fast64_t id_{};
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::u8string type_{};
+  // false for the totals of the destroyed locks of type_, id_ is then 0
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  bool live_{};
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::uint_fast64_t acquisitions_{};
+  // acquisitions that could not take the lock at once
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::uint_fast64_t contended_{};
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::uint_fast64_t shared_acquisitions_{};
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::uint_fast64_t shared_contended_{};
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::array<std::uint_fast64_t, lock_histogram_buckets> wait_{};
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::array<std::uint_fast64_t, lock_histogram_buckets> hold_{};
+};
+
+namespace detail {
+class ARTCCEL_CORE_EXPORT Lock_counters;
+template <typename Lock> class Instrumented_lock;
+
+// counters of one instrumented lock, registered in the process-wide registry
+// for its lifetime; exclusive and shared acquisitions share the histograms
+class Lock_counters {
+public:
+  using clock_type = std::chrono::steady_clock;
+  using counter_type = std::atomic<std::uint_fast64_t>;
+
+private:
+  std::u8string_view type_;
+  std::uint_fast64_t id_{};
+#pragma warning(push)
+#pragma warning(disable : 4251)
+  counter_type acquisitions_{0};
+  counter_type contended_{0};
+  counter_type shared_acquisitions_{0};
+  counter_type shared_contended_{0};
+  std::array<counter_type, lock_histogram_buckets> wait_{};
+  std::array<counter_type, lock_histogram_buckets> hold_{};
+#pragma warning(pop)
+
+  friend class Lock_registry;
+
+  // call with the registry mutex held
+  auto sample [[nodiscard]] () const -> Lock_metrics_sample;
+  // adds the counters to those of total
+  void accumulate(Lock_metrics_sample &total) const noexcept;
+
+public:
+  // type must have static storage duration
+  explicit Lock_counters(std::u8string_view type);
+  ~Lock_counters() noexcept;
+  Lock_counters(Lock_counters const &) = delete;
+  auto operator=(Lock_counters const &) = delete;
+  Lock_counters(Lock_counters &&) = delete;
+  auto operator=(Lock_counters &&) = delete;
+
+  void acquired(clock_type::duration wait, bool contended) noexcept;
+  void released(clock_type::duration hold) noexcept;
+  // the start of a shared hold is remembered by the acquiring thread, so a
+  // shared lock released by another thread, or nested too deep, is not timed
+  void acquired_shared(clock_type::duration wait, bool contended) noexcept;
+  void released_shared() noexcept;
+};
+
+// satisfies the named requirements Lock does, from BasicLockable to
+// SharedTimedLockable, counting acquisitions and timing waits and holds
+template <typename Lock> class Instrumented_lock {
+public:
+  using lockable_type = Lock;
+
+private:
+  using clock_type = Lock_counters::clock_type;
+
+  Lock lock_{};
+  Lock_counters counters_{f::type_name<Lock>()};
+  clock_type::time_point acquired_{}; // written by the exclusive owner only
+
+  // tries first without waiting, to tell whether the lock was contended
+  template <bool Shared, typename TryAcquire, typename Acquire>
+  auto instrument(TryAcquire const &try_acquire, Acquire const &acquire)
+      -> bool {
+    auto const start{clock_type::now()};
+    auto const contended{!try_acquire()};
+    if (contended && !acquire()) {
+      return false;
+    }
+    auto const end{clock_type::now()};
+    if constexpr (Shared) {
+      counters_.acquired_shared(end - start, contended);
+    } else {
+      acquired_ = end;
+      counters_.acquired(end - start, contended);
+    }
+    return true;
+  }
+
+public:
+  Instrumented_lock() = default;
+  ~Instrumented_lock() noexcept = default;
+  Instrumented_lock(Instrumented_lock const &) = delete;
+  auto operator=(Instrumented_lock const &) = delete;
+  Instrumented_lock(Instrumented_lock &&) = delete;
+  auto operator=(Instrumented_lock &&) = delete;
+
+  // named requirement: BasicLockable
+
+  template <typename = void>
+  requires requires {
+    { std::declval<Lock &>().lock() } -> std::same_as<void>;
+  }
+  void lock() {
+    if constexpr (requires {
+                    { std::declval<Lock &>().try_lock() } -> std::same_as<bool>;
+                  }) {
+      static_cast<void>(instrument<false>(
+          [this] { return lock_.try_lock(); },
+          [this] {
+            lock_.lock();
+            return true;
+          }));
+    } else {
+      static_cast<void>(instrument<false>([] { return false; },
+                                          [this] {
+                                            lock_.lock();
+                                            return true;
+                                          }));
+    }
+  }
+  template <typename = void>
+  requires requires {
+    { std::declval<Lock &>().unlock() } -> std::same_as<void>;
+  }
+  void unlock() {
+    auto const hold{clock_type::now() - acquired_};
+    lock_.unlock();
+    counters_.released(hold);
+  }
+
+  // named requirement: BasicLockable <- Lockable
+
+  template <typename = void>
+  requires requires {
+    { std::declval<Lock &>().try_lock() } -> std::same_as<bool>;
+  }
+  auto try_lock [[nodiscard]] () -> bool {
+    return instrument<false>([this] { return lock_.try_lock(); },
+                             [] { return false; });
+  }
+
+  // named requirement: BasicLockable <- Lockable <- TimedLockable
+
+  template <typename Rep, typename Period>
+  requires requires {
+    {
+      std::declval<Lock &>().try_lock_for(
+          std::declval<std::chrono::duration<Rep, Period> const &>())
+      } -> std::same_as<bool>;
+  }
+  auto try_lock_for
+      [[nodiscard]] (std::chrono::duration<Rep, Period> const &rel_time)
+      -> bool {
+    return instrument<false>(
+        [this] { return lock_.try_lock(); },
+        [this, &rel_time] { return lock_.try_lock_for(rel_time); });
+  }
+  template <typename Clock, typename Duration>
+  requires requires {
+    {
+      std::declval<Lock &>().try_lock_until(
+          std::declval<std::chrono::time_point<Clock, Duration> const &>())
+      } -> std::same_as<bool>;
+  }
+  auto try_lock_until
+      [[nodiscard]] (std::chrono::time_point<Clock, Duration> const &abs_time)
+      -> bool {
+    return instrument<false>(
+        [this] { return lock_.try_lock(); },
+        [this, &abs_time] { return lock_.try_lock_until(abs_time); });
+  }
+
+  // named requirement: SharedLockable
+
+  template <typename = void>
+  requires requires {
+    { std::declval<Lock &>().lock_shared() } -> std::same_as<void>;
+  }
+  void lock_shared() {
+    static_cast<void>(instrument<true>(
+        [this] { return lock_.try_lock_shared(); },
+        [this] {
+          lock_.lock_shared();
+          return true;
+        }));
+  }
+  template <typename = void>
+  requires requires {
+    { std::declval<Lock &>().try_lock_shared() } -> std::same_as<bool>;
+  }
+  auto try_lock_shared [[nodiscard]] () -> bool {
+    return instrument<true>([this] { return lock_.try_lock_shared(); },
+                            [] { return false; });
+  }
+  template <typename = void>
+  requires requires {
+    { std::declval<Lock &>().unlock_shared() } -> std::same_as<void>;
+  }
+  void unlock_shared() {
+    counters_.released_shared();
+    lock_.unlock_shared();
+  }
+
+  // named requirement: SharedLockable <- SharedTimedLockable
+
+  template <typename Rep, typename Period>
+  requires requires {
+    {
+      std::declval<Lock &>().try_lock_shared_for(
+          std::declval<std::chrono::duration<Rep, Period> const &>())
+      } -> std::same_as<bool>;
+  }
+  auto try_lock_shared_for
+      [[nodiscard]] (std::chrono::duration<Rep, Period> const &rel_time)
+      -> bool {
+    return instrument<true>(
+        [this] { return lock_.try_lock_shared(); },
+        [this, &rel_time] { return lock_.try_lock_shared_for(rel_time); });
+  }
+  template <typename Clock, typename Duration>
+  requires requires {
+    {
+      std::declval<Lock &>().try_lock_shared_until(
+          std::declval<std::chrono::time_point<Clock, Duration> const &>())
+      } -> std::same_as<bool>;
+  }
+  auto try_lock_shared_until
+      [[nodiscard]] (std::chrono::time_point<Clock, Duration> const &abs_time)
+      -> bool {
+    return instrument<true>(
+        [this] { return lock_.try_lock_shared(); },
+        [this, &abs_time] { return lock_.try_lock_shared_until(abs_time); });
+  }
+};
+} // namespace detail
+
+// Lock itself without ARTCCEL_METRICS, so that it may be left in place;
+// usable wherever a lock type is a template parameter, as in
+// Nullable_lockable<Instrumented_lockable<std::shared_mutex>>
+template <typename Lock>
+using Instrumented_lockable =
+    std::conditional_t<lock_metrics_enabled, detail::Instrumented_lock<Lock>,
+                       Lock>;
+
+namespace f {
+// live locks ordered by id, then the totals of destroyed locks by type;
+// empty without ARTCCEL_METRICS
+ARTCCEL_CORE_EXPORT auto lock_metrics_samples [[nodiscard]] ()
+    -> std::vector<Lock_metrics_sample>;
+} // namespace f
+
+// epoch-based read-side critical section, reentrant, never blocks; the first
+// one on a thread allocates its slot, so it may throw std::bad_alloc
+class Epoch_guard {
+public:
+  Epoch_guard();
+  ~Epoch_guard() noexcept;
+  Epoch_guard(Epoch_guard const &) = delete;
+  auto operator=(Epoch_guard const &) = delete;
+  Epoch_guard(Epoch_guard &&) = delete;
+  auto operator=(Epoch_guard &&) = delete;
+};
+
+// single-writer cell whose readers never write shared memory; writers must
+// be serialized externally
+template <std::copyable Type> class Snapshot_cell {
+private:
+  std::atomic<Type const *> value_;
+
+public:
+  explicit Snapshot_cell(Type value)
+      : value_{std::make_unique<Type const>(std::move(value)).release()} {}
+  auto load [[nodiscard]] () const -> Type {
+    Epoch_guard const guard{};
+    return *value_.load(std::memory_order_seq_cst);
+  }
+  void store(Type value) { retire(install(prepare(std::move(value)))); }
+  // store in steps, so that only install, which cannot throw, has to run in a
+  // critical section; what install returns is then passed to retire
+  using prepared_type = std::unique_ptr<Type const>;
+  static auto prepare [[nodiscard]] (Type value) -> prepared_type {
+    return std::make_unique<Type const>(std::move(value));
+  }
+  auto install [[nodiscard]] (prepared_type value) noexcept -> Type const * {
+    return value_.exchange(value.release(), std::memory_order_seq_cst);
+  }
+  static void retire(Type const *value) { f::epoch_retire(value); }
+
+  ~Snapshot_cell() noexcept {
+    // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+    delete value_.load(std::memory_order_relaxed);
+  }
+  Snapshot_cell(Snapshot_cell const &) = delete;
+  auto operator=(Snapshot_cell const &) = delete;
+  Snapshot_cell(Snapshot_cell &&) = delete;
+  auto operator=(Snapshot_cell &&) = delete;
+};
+// seqlock, see "Can Seqlocks Get Along with Programming Language Memory
+// Models?" (Boehm, 2012)
+template <std::copyable Type>
+requires std::is_trivially_copyable_v<Type>
+class Snapshot_cell<Type> {
+private:
+  constexpr static auto word_count_{
+      (sizeof(Type) + sizeof(std::uintptr_t) - 1) / sizeof(std::uintptr_t)};
+  using words_type = std::array<std::uintptr_t, word_count_>;
+
+  std::atomic<std::uint_fast64_t> sequence_{0};
+  std::array<std::atomic<std::uintptr_t>, word_count_> words_{};
+
+public:
+  explicit Snapshot_cell(Type value) noexcept { store(value); }
+  auto load [[nodiscard]] () const noexcept -> Type {
+    words_type words{};
+    for (auto sequence{sequence_.load(std::memory_order_acquire)};;
+         sequence = sequence_.load(std::memory_order_acquire)) {
+      if (sequence % 2U != 0U) {
+        std::this_thread::yield(); // a writer is in progress
+        continue;
+      }
+      for (std::size_t index{0}; index != word_count_; ++index) {
+        words[index] = words_[index].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence_.load(std::memory_order_relaxed) == sequence) {
+        break;
+      }
+    }
+    std::array<std::byte, sizeof(Type)> bytes{};
+    std::memcpy(bytes.data(), words.data(), sizeof(Type));
+    return std::bit_cast<Type>(bytes);
+  }
+  void store(Type value) noexcept {
+    words_type words{};
+    std::memcpy(words.data(), &value, sizeof(Type));
+    auto const sequence{sequence_.load(std::memory_order_relaxed)};
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (std::size_t index{0}; index != word_count_; ++index) {
+      words_[index].store(words[index], std::memory_order_relaxed);
+    }
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+  using prepared_type = Type;
+  static auto prepare [[nodiscard]] (Type value) noexcept -> prepared_type {
+    return value;
+  }
+  auto install [[nodiscard]] (prepared_type value) noexcept -> Type const * {
+    store(value);
+    return nullptr; // nothing to reclaim
+  }
+  static void retire(Type const *value [[maybe_unused]]) noexcept {}
+
+  ~Snapshot_cell() noexcept = default;
+  Snapshot_cell(Snapshot_cell const &) = delete;
+  auto operator=(Snapshot_cell const &) = delete;
+  Snapshot_cell(Snapshot_cell &&) = delete;
+  auto operator=(Snapshot_cell &&) = delete;
+};
+
+// like Snapshot_cell, but may be empty; writers must be serialized
+// externally, a reader loads the value published last and copies it in an
+// Epoch_guard, replaced values are reclaimed through f::epoch_retire
+template <std::copyable Type> class Result_cell {
+private:
+  struct Node {
+    Type value_;
+    // links the replaced nodes not yet retired, touched by writers only
+    mutable Node const *next_{nullptr};
+  };
+
+  std::atomic<Node const *> current_{nullptr};
+  Node const *replaced_{nullptr};
+
+  void replace(Node const *node) noexcept {
+    if (node != nullptr) {
+      node->next_ = replaced_;
+      replaced_ = node;
+    }
+  }
+  // if this throws, the rest is retired on the next publish
+  void retire() {
+    while (replaced_ != nullptr) {
+      auto const *const next{replaced_->next_};
+      f::epoch_retire(replaced_);
+      replaced_ = next;
+    }
+  }
+
+public:
+  constexpr Result_cell() noexcept = default;
+  // one acquire load
+  auto ready [[nodiscard]] () const noexcept {
+    return current_.load(std::memory_order_acquire) != nullptr;
+  }
+  auto load [[nodiscard]] () const -> std::optional<Type> {
+    Epoch_guard const guard{};
+    if (auto const *const node{current_.load(std::memory_order_acquire)}) {
+      return node->value_;
+    }
+    return std::nullopt;
+  }
+  void publish(Type value) {
+    auto next{std::make_unique<Node const>(Node{std::move(value)})};
+    replace(current_.exchange(next.release(), std::memory_order_acq_rel));
+    retire();
+  }
+  // never waits; readers already copying the value go on
+  void retract() noexcept {
+    replace(current_.exchange(nullptr, std::memory_order_acq_rel));
+  }
+
+  ~Result_cell() noexcept {
+    replace(current_.load(std::memory_order_relaxed));
+    while (replaced_ != nullptr) {
+      // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+      delete std::exchange(replaced_, replaced_->next_);
+    }
+  }
+  Result_cell(Result_cell const &) = delete;
+  auto operator=(Result_cell const &) = delete;
+  Result_cell(Result_cell &&) = delete;
+  auto operator=(Result_cell &&) = delete;
+};
+// seqlock like Snapshot_cell, its readers never write shared memory
+template <std::copyable Type>
+requires std::is_trivially_copyable_v<Type>
+class Result_cell<Type> {
+private:
+  constexpr static auto word_count_{
+      (sizeof(Type) + sizeof(std::uintptr_t) - 1) / sizeof(std::uintptr_t)};
+  using words_type = std::array<std::uintptr_t, word_count_>;
+  // bit 0 while writing, bit 1 while ready, the rest counts the writes
+  constexpr static std::uint_fast64_t writing_{1};
+  constexpr static std::uint_fast64_t ready_{2};
+  constexpr static std::uint_fast64_t step_{4};
+
+  std::atomic<std::uint_fast64_t> sequence_{0};
+  std::array<std::atomic<std::uintptr_t>, word_count_> words_{};
+
+  auto next [[nodiscard]] () const noexcept {
+    return (sequence_.load(std::memory_order_relaxed) & ~(step_ - 1)) + step_;
+  }
+
+public:
+  constexpr Result_cell() noexcept = default;
+  // one acquire load
+  auto ready [[nodiscard]] () const noexcept {
+    return (sequence_.load(std::memory_order_acquire) & ready_) != 0U;
+  }
+  auto load [[nodiscard]] () const noexcept -> std::optional<Type> {
+    words_type words{};
+    for (auto sequence{sequence_.load(std::memory_order_acquire)};;
+         sequence = sequence_.load(std::memory_order_acquire)) {
+      if ((sequence & writing_) != 0U) {
+        std::this_thread::yield(); // a writer is in progress
+        continue;
+      }
+      if ((sequence & ready_) == 0U) {
+        return std::nullopt;
+      }
+      for (std::size_t index{0}; index != word_count_; ++index) {
+        words[index] = words_[index].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence_.load(std::memory_order_relaxed) == sequence) {
+        break;
+      }
+    }
+    std::array<std::byte, sizeof(Type)> bytes{};
+    std::memcpy(bytes.data(), words.data(), sizeof(Type));
+    return std::bit_cast<Type>(bytes);
+  }
+  void publish(Type value) noexcept {
+    words_type words{};
+    std::memcpy(words.data(), &value, sizeof(Type));
+    auto const sequence{next()};
+    sequence_.store(sequence | writing_, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (std::size_t index{0}; index != word_count_; ++index) {
+      words_[index].store(words[index], std::memory_order_relaxed);
+    }
+    sequence_.store(sequence | ready_, std::memory_order_release);
+  }
+  void retract() noexcept {
+    sequence_.store(next(), std::memory_order_release);
+  }
+
+  ~Result_cell() noexcept = default;
+  Result_cell(Result_cell const &) = delete;
+  auto operator=(Result_cell const &) = delete;
+  Result_cell(Result_cell &&) = delete;
+  auto operator=(Result_cell &&) = delete;
+};
+
+// a task embedded in its owner, so that submitting it allocates nothing; the
+// executor leaves it alone once run is called, so that run may submit it
+// again or end its lifetime
+class Task {
+private:
+  Task *next_{nullptr}; // links the injection stack
+  Task_group *group_{nullptr};
+
+  friend class Task_executor;
+  friend class Task_group;
+
+protected:
+  ~Task() noexcept = default;
+
+public:
+  constexpr Task() noexcept = default;
+  Task(Task const &) = delete;
+  auto operator=(Task const &) = delete;
+  Task(Task &&) = delete;
+  auto operator=(Task &&) = delete;
+
+  // must not throw unless submitted through a Task_group
+  virtual void run() = 0;
+};
+
+// runs tasks on a fixed set of workers; a worker submits onto a Chase-Lev
+// deque of its own, which the others steal from once out of tasks, any other
+// thread onto a shared lock-free injection stack, which a worker takes whole,
+// moving the tasks onto its deque; idle workers sleep until a submission
+class Task_executor {
+public:
+  using task_type = Move_only_function<void()>;
+
+private:
+  class Impl;
+#pragma warning(suppress : 4251)
+  std::unique_ptr<Impl> impl_;
+
+  friend class Task_group;
+
+public:
+  // uses std::thread::hardware_concurrency() workers
+  Task_executor();
+  // with zero workers, tasks run only within run_one and Task_group::wait
+  explicit Task_executor(std::size_t concurrency);
+  // runs the tasks still queued before joining the workers
+  ~Task_executor() noexcept;
+  Task_executor(Task_executor const &) = delete;
+  auto operator=(Task_executor const &) = delete;
+  Task_executor(Task_executor &&) = delete;
+  auto operator=(Task_executor &&) = delete;
+
+  auto concurrency [[nodiscard]] () const noexcept -> std::size_t;
+  // task must not throw, submit through a Task_group otherwise
+  void submit(task_type task);
+  void submit(Task &task) noexcept;
+  // in one operation, whatever the number of tasks
+  void submit(std::span<Task *const> tasks) noexcept;
+  // runs a queued task on the calling thread, false if there was none
+  auto run_one() -> bool;
+};
+
+// tasks submitted through a group are waited on together
+class Task_group {
+private:
+  Task_executor *executor_;
+#pragma warning(push)
+#pragma warning(disable : 4251)
+  std::atomic<std::size_t> pending_{0};
+  std::mutex mutex_{};
+  std::condition_variable done_{};
+  std::exception_ptr exception_{}; // the first one thrown, guarded by mutex_
+#pragma warning(pop)
+
+  friend class Task_executor;
+  void finish(std::exception_ptr exception) noexcept;
+
+public:
+  explicit Task_group(Task_executor &executor) noexcept;
+  // waits for the tasks, dropping their exception
+  ~Task_group() noexcept;
+  Task_group(Task_group const &) = delete;
+  auto operator=(Task_group const &) = delete;
+  Task_group(Task_group &&) = delete;
+  auto operator=(Task_group &&) = delete;
+
+  void submit(Task_executor::task_type task);
+  void submit(Task &task) noexcept;
+  void submit(std::span<Task *const> tasks) noexcept;
+  // runs queued tasks, of any group, on the calling thread until those of
+  // this group finish, then rethrows the first exception thrown by them
+  void wait();
+#pragma warning(suppress : 4820)
+};
+
 extern template class ARTCCEL_CORE_EXPORT_DECLARATION
     Nullable_lockable<std::mutex>;
 extern template class ARTCCEL_CORE_EXPORT_DECLARATION
@@ -354,6 +1363,8 @@ extern template class ARTCCEL_CORE_EXPORT_DECLARATION
     Nullable_lockable<std::shared_mutex>;
 extern template class ARTCCEL_CORE_EXPORT_DECLARATION
     Nullable_lockable<std::shared_timed_mutex>;
+extern template class ARTCCEL_CORE_EXPORT_DECLARATION
+    Nullable_lockable<Striped_shared_mutex>;
 } // namespace artccel::core::util
 
 #endif
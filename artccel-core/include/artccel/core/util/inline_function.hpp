@@ -0,0 +1,124 @@
+#pragma once
+#ifndef GUARD_C6B1E04D_8F27_4A93_B5D2_0E9A7F3C6185
+#define GUARD_C6B1E04D_8F27_4A93_B5D2_0E9A7F3C6185
+
+#include <array>       // import std::array
+#include <concepts>    // import std::copy_constructible, std::same_as
+#include <cstddef>     // import std::byte, std::max_align_t, std::size_t
+#include <functional>  // import std::bad_function_call, std::invoke
+#include <memory>      // import std::construct_at, std::destroy_at
+#include <type_traits> // import std::decay_t, std::is_nothrow_move_constructible_v, std::remove_cvref_t
+#include <utility>     // import std::exchange, std::forward, std::move
+
+#include "concepts_extras.hpp" // import Invocable_r
+
+namespace artccel::core::util {
+template <typename Signature, std::size_t Capacity> class Inline_function;
+
+// std::function that never allocates, storing its target in Capacity bytes
+template <typename Ret, typename... Args, std::size_t Capacity>
+class Inline_function<Ret(Args...), Capacity> {
+private:
+  struct Vtable {
+    Ret (*invoke_)(void *target, Args &&...args);
+    void (*copy_)(void const *from, void *to);
+    void (*move_)(void *from, void *to) noexcept;
+    void (*destroy_)(void *target) noexcept;
+  };
+  template <typename Func>
+  constexpr static Vtable vtable_for_{
+      [](void *target, Args &&...args) -> Ret {
+        return std::invoke(*static_cast<Func *>(target),
+                           std::forward<Args>(args)...);
+      },
+      [](void const *from, void *to) {
+        std::construct_at(static_cast<Func *>(to),
+                          *static_cast<Func const *>(from));
+      },
+      [](void *from, void *to) noexcept {
+        std::construct_at(static_cast<Func *>(to),
+                          std::move(*static_cast<Func *>(from)));
+      },
+      [](void *target) noexcept {
+        std::destroy_at(static_cast<Func *>(target));
+      }};
+
+  // mutable like the target of std::function::operator() const
+  alignas(std::max_align_t) mutable std::array<std::byte, Capacity> storage_;
+  Vtable const *vtable_{nullptr};
+
+public:
+  constexpr Inline_function() noexcept = default;
+  template <typename Func>
+  requires(!std::same_as<std::remove_cvref_t<Func>, Inline_function> &&
+           std::copy_constructible<std::decay_t<Func>> &&
+           Invocable_r<std::decay_t<Func> &, Ret, Args...>)
+  // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+  Inline_function(Func &&func) : vtable_{&vtable_for_<std::decay_t<Func>>} {
+    using target_type = std::decay_t<Func>;
+    static_assert(sizeof(target_type) <= Capacity,
+                  u8"Target does not fit, increase the capacity");
+    static_assert(alignof(target_type) <= alignof(std::max_align_t),
+                  u8"Target is over-aligned");
+    static_assert(std::is_nothrow_move_constructible_v<target_type>,
+                  u8"Target must be nothrow move constructible");
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    std::construct_at(reinterpret_cast<target_type *>(storage_.data()),
+                      std::forward<Func>(func));
+  }
+
+  auto operator()(Args... args) const -> Ret {
+    if (vtable_ == nullptr) {
+      throw std::bad_function_call{};
+    }
+    return vtable_->invoke_(storage_.data(), std::forward<Args>(args)...);
+  }
+  explicit operator bool() const noexcept { return vtable_ != nullptr; }
+
+  ~Inline_function() noexcept { reset(); }
+  void swap(Inline_function &other) noexcept {
+    Inline_function temp{std::move(other)};
+    other = std::move(*this);
+    *this = std::move(temp);
+  }
+  friend void swap(Inline_function &left, Inline_function &right) noexcept {
+    left.swap(right);
+  }
+  Inline_function(Inline_function const &other) : vtable_{other.vtable_} {
+    if (vtable_ != nullptr) {
+      vtable_->copy_(other.storage_.data(), storage_.data());
+    }
+  }
+  auto operator=(Inline_function const &right) -> Inline_function & {
+    if (this != &right) {
+      Inline_function temp{right};
+      *this = std::move(temp);
+    }
+    return *this;
+  }
+  Inline_function(Inline_function &&other) noexcept : vtable_{other.vtable_} {
+    if (vtable_ != nullptr) {
+      vtable_->move_(other.storage_.data(), storage_.data());
+    }
+  }
+  auto operator=(Inline_function &&right) noexcept -> Inline_function & {
+    if (this != &right) {
+      reset();
+      vtable_ = right.vtable_;
+      if (vtable_ != nullptr) {
+        vtable_->move_(right.storage_.data(), storage_.data());
+      }
+    }
+    return *this;
+  }
+
+private:
+  void reset() noexcept {
+    if (auto const *const vtable{std::exchange(vtable_, nullptr)}) {
+      vtable->destroy_(storage_.data());
+    }
+  }
+};
+} // namespace artccel::core::util
+
+#endif
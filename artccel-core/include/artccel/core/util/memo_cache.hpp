@@ -0,0 +1,179 @@
+#pragma once
+#ifndef GUARD_9D4A2C71_3B6E_4F05_A8E1_5C7F0B2D6E93
+#define GUARD_9D4A2C71_3B6E_4F05_A8E1_5C7F0B2D6E93
+
+#include <bit>        // import std::bit_ceil
+#include <cstddef>    // import std::size_t
+#include <cstdint>    // import std::uint_fast64_t
+#include <functional> // import std::equal_to, std::hash
+#include <tuple>      // import std::apply, std::tuple
+#include <utility>    // import std::move
+#include <vector>     // import std::vector
+
+namespace artccel::core::util {
+template <typename Tuple> struct Tuple_hash;
+struct Cache_stats;
+template <typename Key, typename Value, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class Clock_cache;
+
+template <typename... Types> struct Tuple_hash<std::tuple<Types...>> {
+  auto operator()(std::tuple<Types...> const &tuple) const -> std::size_t {
+    return std::apply(
+        [](Types const &...elements) {
+          std::size_t ret{0};
+          // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+          ((ret ^= std::hash<Types>{}(elements) + 0x9e3779b9U + (ret << 6U) +
+                   (ret >> 2U)),
+           ...);
+          return ret;
+        },
+        tuple);
+  }
+};
+
+struct Cache_stats {
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::uint_fast64_t hits_{0};
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::uint_fast64_t misses_{0};
+};
+
+// fixed-capacity map evicting by the CLOCK (second chance) policy, lookups and
+// insertions are O(1) on average; the index and the entries are sized to the
+// capacity on construction, so the cache itself never allocates afterwards
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+class Clock_cache {
+private:
+  struct Entry {
+    Key key_;
+    Value value_;
+    std::size_t hash_;
+    bool referenced_;
+  };
+  constexpr static std::size_t empty_slot_{0};
+
+  std::size_t capacity_;
+  // open addressing with linear probing, each slot holds an entry index plus
+  // one; at most half full, so that probes stay short
+  std::vector<std::size_t> slots_{};
+  std::vector<Entry> entries_{};
+  std::size_t hand_{0};
+  Cache_stats stats_{};
+  Hash hash_{};
+  KeyEqual key_equal_{};
+
+  auto home [[nodiscard]] (std::size_t hash) const noexcept {
+    return hash & (slots_.size() - 1);
+  }
+  // the slot of key, or the empty slot ending its probe sequence
+  auto probe [[nodiscard]] (Key const &key, std::size_t hash) const
+      -> std::size_t {
+    auto slot{home(hash)};
+    for (; slots_[slot] != empty_slot_; slot = home(slot + 1)) {
+      if (auto const &entry{entries_[slots_[slot] - 1]};
+          entry.hash_ == hash && key_equal_(entry.key_, key)) {
+        break;
+      }
+    }
+    return slot;
+  }
+  // finds the slot by position rather than by key, so that an entry whose key
+  // was partially replaced by a throwing assignment is still handled
+  void unindex(std::size_t position) noexcept {
+    auto slot{home(entries_[position].hash_)};
+    for (; slots_[slot] != position + 1; slot = home(slot + 1)) {
+      if (slots_[slot] == empty_slot_) {
+        return;
+      }
+    }
+    // backward shift deletion, keeps every probe sequence unbroken
+    for (auto next{home(slot + 1)}; slots_[next] != empty_slot_;
+         next = home(next + 1)) {
+      auto const next_home{home(entries_[slots_[next] - 1].hash_)};
+      if (home(next - next_home) >= home(next - slot)) {
+        slots_[slot] = slots_[next];
+        slot = next;
+      }
+    }
+    slots_[slot] = empty_slot_;
+  }
+
+public:
+  explicit Clock_cache(std::size_t capacity)
+      : capacity_{capacity},
+        slots_(capacity == 0 ? 0 : std::bit_ceil(capacity * 2), empty_slot_) {
+    entries_.reserve(capacity_);
+  }
+
+  auto capacity [[nodiscard]] () const noexcept { return capacity_; }
+  auto size [[nodiscard]] () const noexcept { return entries_.size(); }
+  auto stats [[nodiscard]] () const noexcept { return stats_; }
+  // the pointer is valid until the next insertion
+  auto find [[nodiscard]] (Key const &key) -> Value const * {
+    if (capacity_ != 0) {
+      if (auto const slot{probe(key, hash_(key))};
+          slots_[slot] != empty_slot_) {
+        auto &entry{entries_[slots_[slot] - 1]};
+        entry.referenced_ = true;
+        ++stats_.hits_;
+        return &entry.value_;
+      }
+    }
+    ++stats_.misses_;
+    return nullptr;
+  }
+  void insert(Key key, Value value) {
+    if (capacity_ == 0) {
+      return;
+    }
+    auto const hash{hash_(key)};
+    if (auto const slot{probe(key, hash)}; slots_[slot] != empty_slot_) {
+      auto &entry{entries_[slots_[slot] - 1]};
+      entry.value_ = std::move(value);
+      entry.referenced_ = true;
+      return;
+    }
+    if (entries_.size() < capacity_) {
+      entries_.emplace_back(
+          Entry{std::move(key), std::move(value), hash, false});
+      slots_[probe(entries_.back().key_, hash)] = entries_.size();
+      return;
+    }
+    // clears the referenced bits in passing, so this visits at most one cycle
+    while (entries_[hand_].referenced_) {
+      entries_[hand_].referenced_ = false;
+      hand_ = (hand_ + 1) % capacity_;
+    }
+    auto const position{hand_};
+    hand_ = (hand_ + 1) % capacity_;
+    // unindexed first, a throwing assignment then leaves it unreachable
+    unindex(position);
+    auto &victim{entries_[position]};
+    victim.key_ = std::move(key);
+    victim.hash_ = hash;
+    victim.value_ = std::move(value);
+    slots_[probe(victim.key_, hash)] = position + 1;
+  }
+
+  ~Clock_cache() noexcept = default;
+  Clock_cache(Clock_cache const &other) : Clock_cache(other.capacity_) {
+    entries_.assign(other.entries_.begin(), other.entries_.end());
+    slots_ = other.slots_;
+    hand_ = other.hand_;
+    stats_ = other.stats_;
+    hash_ = other.hash_;
+    key_equal_ = other.key_equal_;
+  }
+  auto operator=(Clock_cache const &right) -> Clock_cache & {
+    if (this != &right) {
+      *this = Clock_cache{right};
+    }
+    return *this;
+  }
+  Clock_cache(Clock_cache &&) noexcept = default;
+  auto operator=(Clock_cache &&) noexcept -> Clock_cache & = default;
+};
+} // namespace artccel::core::util
+
+#endif
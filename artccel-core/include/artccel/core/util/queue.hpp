@@ -0,0 +1,371 @@
+#pragma once
+#ifndef GUARD_7E2C9A41_0B5D_4F86_93A7_C14D8E6B2F50
+#define GUARD_7E2C9A41_0B5D_4F86_93A7_C14D8E6B2F50
+
+#include <algorithm> // import std::max, std::min
+#include <array>     // import std::array
+#include <atomic> // import std::atomic, std::atomic_thread_fence, std::memory_order_acquire, std::memory_order_relaxed, std::memory_order_release, std::memory_order_seq_cst
+#include <bit>         // import std::bit_ceil
+#include <concepts>    // import std::invocable
+#include <cstddef>     // import std::byte, std::size_t
+#include <cstdint>     // import std::intptr_t
+#include <memory>      // import std::construct_at, std::destroy_at, std::make_unique, std::unique_ptr
+#include <new>         // import std::launder
+#include <optional>    // import std::optional
+#include <span>        // import std::span
+#include <type_traits> // import std::is_nothrow_move_constructible_v
+#include <utility>     // import std::forward, std::move
+
+#pragma warning(push)
+#pragma warning(disable : 4626 4820)
+#include <gsl/gsl> // import gsl::finally
+#pragma warning(pop)
+
+#include "concurrent.hpp" // import cache_line_size
+
+namespace artccel::core::util {
+template <typename Type> class Spsc_ring;
+template <typename Type> class Mpmc_queue;
+
+namespace detail {
+template <typename Type> struct Queue_slot;
+
+// uninitialized storage for one element, constructed and destroyed by the
+// owning queue
+template <typename Type> struct Queue_slot {
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  alignas(Type) std::array<std::byte, sizeof(Type)> storage_;
+
+  auto value [[nodiscard]] () noexcept -> Type * {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    return std::launder(reinterpret_cast<Type *>(storage_.data()));
+  }
+  template <typename... Args> void emplace(Args &&...args) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    std::construct_at(reinterpret_cast<Type *>(storage_.data()),
+                      std::forward<Args>(args)...);
+  }
+  auto take [[nodiscard]] () noexcept -> Type {
+    Type ret{std::move(*value())};
+    std::destroy_at(value());
+    return ret;
+  }
+};
+
+// at least capacity and at least 2, rounded up to a power of two, so that an
+// index masks to a slot
+constexpr auto queue_capacity [[nodiscard]] (std::size_t capacity) noexcept {
+  return std::bit_ceil(std::max(capacity, std::size_t{2}));
+}
+} // namespace detail
+
+// bounded lock-free ring for one producer thread and one consumer thread at a
+// time; the two indices sit on separate cache lines, and each side rereads
+// the index of the other only when the ring looks full or empty to it, so
+// that batches cost one cache line transfer each way; a side about to block
+// announces itself, and is notified only then
+template <typename Type> class Spsc_ring {
+  static_assert(std::is_nothrow_move_constructible_v<Type>,
+                u8"Type must be nothrow move constructible");
+
+private:
+  std::size_t mask_;
+  std::unique_ptr<detail::Queue_slot<Type>[]> slots_;
+  // written by the producer only, but consumer_waiting_
+  alignas(cache_line_size) std::atomic<std::size_t> head_{0};
+  std::size_t cached_tail_{0};
+  std::atomic<bool> consumer_waiting_{false};
+  // written by the consumer only, but producer_waiting_
+  alignas(cache_line_size) std::atomic<std::size_t> tail_{0};
+  std::size_t cached_head_{0};
+  std::atomic<bool> producer_waiting_{false};
+
+public:
+  explicit Spsc_ring(std::size_t capacity)
+      : mask_{detail::queue_capacity(capacity) - 1},
+        slots_{std::make_unique<detail::Queue_slot<Type>[]>(mask_ + 1)} {}
+  ~Spsc_ring() noexcept {
+    for (auto tail{tail_.load(std::memory_order_relaxed)},
+         head{head_.load(std::memory_order_relaxed)};
+         tail != head; ++tail) {
+      std::destroy_at(slot(tail).value());
+    }
+  }
+  Spsc_ring(Spsc_ring const &) = delete;
+  auto operator=(Spsc_ring const &) = delete;
+  Spsc_ring(Spsc_ring &&) = delete;
+  auto operator=(Spsc_ring &&) = delete;
+
+  auto capacity [[nodiscard]] () const noexcept { return mask_ + 1; }
+
+  // producer side; value is left untouched if the ring is full
+  auto try_push [[nodiscard]] (Type &&value) noexcept -> bool {
+    auto const head{head_.load(std::memory_order_relaxed)};
+    if (free_slots(head, 1) == 0) {
+      return false;
+    }
+    slot(head).emplace(std::move(value));
+    publish(head + 1);
+    return true;
+  }
+  void push(Type value) noexcept {
+    while (!try_push(std::move(value))) {
+      wait_not_full();
+    }
+  }
+  // moves a prefix of values into the ring, publishing them at once, and
+  // returns its size
+  auto try_push_some [[nodiscard]] (std::span<Type> values) noexcept
+      -> std::size_t {
+    auto const head{head_.load(std::memory_order_relaxed)};
+    auto const count{
+        std::min(free_slots(head, values.size()), values.size())};
+    for (std::size_t index{0}; index < count; ++index) {
+      slot(head + index).emplace(std::move(values[index]));
+    }
+    if (count != 0) {
+      publish(head + count);
+    }
+    return count;
+  }
+  void push_all(std::span<Type> values) noexcept {
+    while (!values.empty()) {
+      if (auto const count{try_push_some(values)}; count != 0) {
+        values = values.subspan(count);
+      } else {
+        wait_not_full();
+      }
+    }
+  }
+
+  // consumer side
+  auto try_pop [[nodiscard]] () noexcept -> std::optional<Type> {
+    auto const tail{tail_.load(std::memory_order_relaxed)};
+    if (used_slots(tail, 1) == 0) {
+      return std::nullopt;
+    }
+    std::optional<Type> ret{slot(tail).take()};
+    release(tail + 1);
+    return ret;
+  }
+  auto pop [[nodiscard]] () noexcept -> Type {
+    while (true) {
+      if (auto ret{try_pop()}) {
+        return *std::move(ret);
+      }
+      wait_not_empty();
+    }
+  }
+  // passes up to max elements to func, freeing their slots at once, and
+  // returns how many it passed; stops after the element func throws on
+  template <std::invocable<Type &&> Func>
+  auto try_pop_some(std::size_t max, Func &&func) -> std::size_t {
+    auto const tail{tail_.load(std::memory_order_relaxed)};
+    auto const count{std::min(used_slots(tail, max), max)};
+    std::size_t popped{0};
+    auto const releaser{gsl::finally([this, tail, &popped] {
+      if (popped != 0) {
+        release(tail + popped);
+      }
+    })};
+    while (popped != count) {
+      func(slot(tail + popped++).take());
+    }
+    return count;
+  }
+  // blocks until there is at least one element
+  template <std::invocable<Type &&> Func>
+  auto pop_some(std::size_t max, Func &&func) -> std::size_t {
+    while (true) {
+      if (auto const count{try_pop_some(max, func)}; count != 0 || max == 0) {
+        return count;
+      }
+      wait_not_empty();
+    }
+  }
+
+private:
+  auto slot [[nodiscard]] (std::size_t index) const noexcept
+      -> detail::Queue_slot<Type> & {
+    return slots_[index & mask_];
+  }
+  // rereads the index of the other side only if fewer than wanted
+  auto free_slots [[nodiscard]] (std::size_t head, std::size_t wanted) noexcept
+      -> std::size_t {
+    if (capacity() - (head - cached_tail_) < wanted) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+    }
+    return capacity() - (head - cached_tail_);
+  }
+  auto used_slots [[nodiscard]] (std::size_t tail, std::size_t wanted) noexcept
+      -> std::size_t {
+    if (cached_head_ - tail < wanted) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+    }
+    return cached_head_ - tail;
+  }
+  // the fences pair with those in the waits, so that either the waiting
+  // side sees the new index or this side sees it waiting
+  void publish(std::size_t head) noexcept {
+    head_.store(head, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (consumer_waiting_.load(std::memory_order_relaxed)) {
+      head_.notify_one();
+    }
+  }
+  void release(std::size_t tail) noexcept {
+    tail_.store(tail, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (producer_waiting_.load(std::memory_order_relaxed)) {
+      tail_.notify_one();
+    }
+  }
+  void wait_not_full() noexcept {
+    auto const full{head_.load(std::memory_order_relaxed) - capacity()};
+    producer_waiting_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    tail_.wait(full, std::memory_order_acquire);
+    producer_waiting_.store(false, std::memory_order_relaxed);
+  }
+  void wait_not_empty() noexcept {
+    auto const empty{tail_.load(std::memory_order_relaxed)};
+    consumer_waiting_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    head_.wait(empty, std::memory_order_acquire);
+    consumer_waiting_.store(false, std::memory_order_relaxed);
+  }
+#pragma warning(suppress : 4324)
+};
+
+// bounded lock-free queue for any number of producers and consumers, see
+// "Bounded MPMC queue" (Vyukov, 2010); each slot carries a sequence number
+// telling which lap of the ring may write or read it next, so that producers
+// and consumers contend only on their own position counter; blocking callers
+// are counted, and slots are notified only while there are any
+template <typename Type> class Mpmc_queue {
+  static_assert(std::is_nothrow_move_constructible_v<Type>,
+                u8"Type must be nothrow move constructible");
+
+private:
+  struct Cell {
+    std::atomic<std::size_t> sequence_;
+    detail::Queue_slot<Type> slot_;
+  };
+
+  std::size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+  alignas(cache_line_size) std::atomic<std::size_t> enqueue_{0};
+  alignas(cache_line_size) std::atomic<std::size_t> dequeue_{0};
+  // read on every operation, written only around blocking
+  alignas(cache_line_size) std::atomic<std::size_t> waiters_{0};
+
+public:
+  explicit Mpmc_queue(std::size_t capacity)
+      : mask_{detail::queue_capacity(capacity) - 1},
+        cells_{std::make_unique<Cell[]>(mask_ + 1)} {
+    for (std::size_t index{0}; index <= mask_; ++index) {
+      cells_[index].sequence_.store(index, std::memory_order_relaxed);
+    }
+  }
+  ~Mpmc_queue() noexcept {
+    while (try_pop()) {
+    }
+  }
+  Mpmc_queue(Mpmc_queue const &) = delete;
+  auto operator=(Mpmc_queue const &) = delete;
+  Mpmc_queue(Mpmc_queue &&) = delete;
+  auto operator=(Mpmc_queue &&) = delete;
+
+  auto capacity [[nodiscard]] () const noexcept { return mask_ + 1; }
+
+  // value is left untouched if the queue is full
+  auto try_push [[nodiscard]] (Type &&value) noexcept -> bool {
+    auto position{enqueue_.load(std::memory_order_relaxed)};
+    while (true) {
+      auto &cell{cells_[position & mask_]};
+      auto const lap{distance(cell.sequence_.load(std::memory_order_acquire),
+                              position)};
+      if (lap == 0) {
+        if (enqueue_.compare_exchange_weak(position, position + 1,
+                                           std::memory_order_relaxed)) {
+          cell.slot_.emplace(std::move(value));
+          advance(cell.sequence_, position + 1);
+          return true;
+        }
+      } else if (lap < 0) {
+        return false;
+      } else {
+        position = enqueue_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+  void push(Type value) noexcept {
+    while (!try_push(std::move(value))) {
+      // the slot of the next position, until a consumer frees it
+      auto const position{enqueue_.load(std::memory_order_relaxed)};
+      wait_while(cells_[position & mask_].sequence_, position);
+    }
+  }
+
+  auto try_pop [[nodiscard]] () noexcept -> std::optional<Type> {
+    auto position{dequeue_.load(std::memory_order_relaxed)};
+    while (true) {
+      auto &cell{cells_[position & mask_]};
+      auto const lap{distance(cell.sequence_.load(std::memory_order_acquire),
+                              position + 1)};
+      if (lap == 0) {
+        if (dequeue_.compare_exchange_weak(position, position + 1,
+                                           std::memory_order_relaxed)) {
+          std::optional<Type> ret{cell.slot_.take()};
+          advance(cell.sequence_, position + capacity());
+          return ret;
+        }
+      } else if (lap < 0) {
+        return std::nullopt;
+      } else {
+        position = dequeue_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+  auto pop [[nodiscard]] () noexcept -> Type {
+    while (true) {
+      if (auto ret{try_pop()}) {
+        return *std::move(ret);
+      }
+      // the slot of the next position, until a producer fills it
+      auto const position{dequeue_.load(std::memory_order_relaxed)};
+      wait_while(cells_[position & mask_].sequence_, position + 1);
+    }
+  }
+
+private:
+  // how far sequence is ahead of position, negative if behind
+  constexpr static auto distance
+      [[nodiscard]] (std::size_t sequence, std::size_t position) noexcept {
+    return static_cast<std::intptr_t>(sequence - position);
+  }
+  // the fences pair with each other, so that either the waiter sees the new
+  // sequence or the notifier sees the waiter
+  void advance(std::atomic<std::size_t> &sequence, std::size_t next) noexcept {
+    sequence.store(next, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_relaxed) != 0) {
+      sequence.notify_all();
+    }
+  }
+  // blocks while sequence is behind wanted
+  void wait_while(std::atomic<std::size_t> &sequence,
+                  std::size_t wanted) noexcept {
+    waiters_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (auto const observed{sequence.load(std::memory_order_acquire)};
+        distance(observed, wanted) < 0) {
+      sequence.wait(observed, std::memory_order_acquire);
+    }
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+  }
+#pragma warning(suppress : 4324)
+};
+} // namespace artccel::core::util
+
+#endif
@@ -0,0 +1,85 @@
+#pragma once
+#ifndef GUARD_4E7B1A93_0C5D_4F28_B6A2_9D3E8F1C7A54
+#define GUARD_4E7B1A93_0C5D_4F28_B6A2_9D3E8F1C7A54
+
+#include <algorithm>   // import std::ranges::for_each, std::ranges::transform
+#include <cstdint>     // import std::uint_fast64_t
+#include <functional>  // import std::less
+#include <iterator>    // import std::back_inserter
+#include <map>         // import std::map
+#include <mutex>       // import std::lock_guard, std::mutex
+#include <string_view> // import std::u8string_view
+#include <vector>      // import std::vector
+
+namespace artccel::core::util::detail {
+template <typename Derived, typename Counters, typename Sample>
+class Sample_registry;
+
+// registers counters for their lifetime and sums those of destroyed ones by
+// type; Derived, a friend of Counters, provides
+// static auto sample(Counters const &) -> Sample and
+// static void accumulate(Sample &, Counters const &) noexcept
+template <typename Derived, typename Counters, typename Sample>
+class Sample_registry {
+private:
+  struct Total {
+    std::uint_fast64_t destroyed_{0};
+    Sample sample_{};
+  };
+
+  std::uint_fast64_t next_id_{1};
+  std::map<std::uint_fast64_t, Counters const *> live_{};
+  // keyed by the types, which have static storage duration; made when the
+  // first counters of a type are added, so that removing does not allocate
+  std::map<std::u8string_view, Total, std::less<>> totals_{};
+
+protected:
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::mutex mutex_{};
+
+  Sample_registry() noexcept = default;
+
+public:
+  // assigns id with the mutex held, so that a sample never sees it unset
+  void add(Counters const &counters, std::uint_fast64_t &id,
+           std::u8string_view type) {
+    std::lock_guard const guard{mutex_};
+    if (auto const [total, inserted]{totals_.try_emplace(type)}; inserted) {
+      try {
+        total->second.sample_.type_ = type;
+      } catch (...) {
+        totals_.erase(total);
+        throw;
+      }
+    }
+    id = next_id_;
+    live_.emplace(id, &counters);
+    ++next_id_;
+  }
+  void remove(Counters const &counters, std::uint_fast64_t id,
+              std::u8string_view type) noexcept {
+    std::lock_guard const guard{mutex_};
+    live_.erase(id);
+    auto &total{totals_.find(type)->second};
+    ++total.destroyed_;
+    Derived::accumulate(total.sample_, counters);
+  }
+  // live counters ordered by id, then the totals of destroyed ones by type
+  auto samples [[nodiscard]] () -> std::vector<Sample> {
+    std::lock_guard const guard{mutex_};
+    std::vector<Sample> ret{};
+    ret.reserve(live_.size() + totals_.size());
+    std::ranges::transform(
+        live_, std::back_inserter(ret),
+        [](auto const &entry) { return Derived::sample(*entry.second); });
+    std::ranges::for_each(totals_, [&ret](auto const &entry) {
+      if (entry.second.destroyed_ != 0) {
+        ret.push_back(entry.second.sample_);
+      }
+    });
+    return ret;
+  }
+};
+} // namespace artccel::core::util::detail
+
+#endif
@@ -4,10 +4,12 @@
 
 #include <concepts>    // import std::derived_from, std::same_as
 #include <sstream>     // import std::basic_stringbuf, std::basic_stringstream
-#include <string>      // import std::basjc_string
+#include <string>      // import std::basjc_string, std::u8string
+#include <string_view> // import std::u8string_view
 #include <type_traits> // import std::remove_cv_t
 
-#include "meta.hpp" // import Replace_all_t
+#include "meta.hpp"              // import Replace_all_t
+#include <artccel/core/export.h> // import ARTCCEL_CORE_EXPORT
 
 namespace artccel::core::util {
 template <typename Type>
@@ -27,6 +29,13 @@ template <typename Type, typename LikeTraits, typename CharT>
 concept Compatible_char_traits =
     Char_traits_c<Type> && Char_traits_c<LikeTraits> &&
     std::same_as<Type, Rebind_char_traits_t<LikeTraits, CharT>>;
+
+namespace f {
+// appends str as a quoted JSON string, escaping quotes, backslashes and
+// control characters
+ARTCCEL_CORE_EXPORT void append_json_string(std::u8string &out,
+                                            std::u8string_view str);
+} // namespace f
 } // namespace artccel::core::util
 
 #endif
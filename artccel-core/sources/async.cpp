@@ -0,0 +1,42 @@
+#include <coroutine> // import std::coroutine_handle
+#include <cstddef>   // import std::size_t
+#include <memory>    // import std::make_unique
+#include <thread>    // import std::thread::hardware_concurrency
+
+#include <artccel/core/compute/async.hpp> // interface
+
+#include <artccel/core/util/concurrent.hpp> // import util::Task_executor
+
+namespace artccel::core::compute {
+class Compute_scheduler::Impl {
+private:
+  util::Task_executor executor_;
+
+public:
+  explicit Impl(std::size_t concurrency) : executor_{concurrency} {}
+
+  auto concurrency [[nodiscard]] () const noexcept {
+    return executor_.concurrency();
+  }
+  void post(std::coroutine_handle<> handle) {
+    if (concurrency() == 0) {
+      handle.resume();
+      return;
+    }
+    executor_.submit([handle] { handle.resume(); });
+  }
+};
+
+Compute_scheduler::Compute_scheduler()
+    : Compute_scheduler{std::thread::hardware_concurrency()} {}
+Compute_scheduler::Compute_scheduler(std::size_t concurrency)
+    : impl_{std::make_unique<Impl>(concurrency)} {}
+Compute_scheduler::~Compute_scheduler() noexcept = default;
+
+auto Compute_scheduler::concurrency() const noexcept -> std::size_t {
+  return impl_->concurrency();
+}
+void Compute_scheduler::post(std::coroutine_handle<> handle) {
+  impl_->post(handle);
+}
+} // namespace artccel::core::compute
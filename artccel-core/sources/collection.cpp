@@ -0,0 +1,22 @@
+#include <algorithm> // import std::max, std::ranges::sort
+#include <vector>    // import std::vector
+
+#include <artccel/core/compute/collection.hpp> // interface
+
+namespace artccel::core::compute::detail {
+void coalesce(std::vector<Dirty_range> &ranges) {
+  std::ranges::sort(ranges, {}, &Dirty_range::begin_);
+  auto out{ranges.begin()};
+  for (auto const &range : ranges) {
+    if (range.begin_ == range.end_) {
+      continue;
+    }
+    if (out != ranges.begin() && range.begin_ <= (out - 1)->end_) {
+      (out - 1)->end_ = std::max((out - 1)->end_, range.end_);
+    } else {
+      *out++ = range;
+    }
+  }
+  ranges.erase(out, ranges.end());
+}
+} // namespace artccel::core::compute::detail
@@ -0,0 +1,270 @@
+#include <algorithm>       // import std::any_of, std::max
+#include <array>           // import std::array
+#include <atomic> // import std::atomic, std::memory_order_acquire, std::memory_order_relaxed, std::memory_order_release, std::memory_order_seq_cst
+#include <cstddef>         // import std::byte, std::max_align_t, std::size_t
+#include <cstdint>         // import std::uint_fast32_t, std::uint_fast64_t
+#include <memory>          // import std::make_shared, std::shared_ptr
+#include <memory_resource> // import std::pmr::memory_resource
+#include <mutex>           // import std::lock_guard
+#include <new> // import std::align_val_t, std::launder
+#include <span>            // import std::span
+#include <stop_token>      // import std::stop_token
+#include <utility>         // import std::move
+#include <vector>          // import std::erase_if, std::vector
+
+#include <gsl/gsl> // import gsl::finally
+
+#include <artccel/core/compute/compute.hpp> // interface
+
+#include <artccel/core/util/concurrent.hpp> // import util::cache_line_size
+
+namespace artccel::core::compute {
+namespace detail {
+auto commit_sequence(std::size_t stripe) noexcept
+    -> std::atomic<std::uint_fast64_t> & {
+  struct alignas(util::cache_line_size) Sequence {
+    std::atomic<std::uint_fast64_t> value_{0};
+  };
+  static std::array<Sequence, commit_stripes> instance{};
+  return instance[stripe].value_;
+}
+auto graph_resource() noexcept -> std::pmr::memory_resource *& {
+  thread_local constinit std::pmr::memory_resource *instance{nullptr};
+  return instance;
+}
+auto running_stop_token() noexcept -> std::stop_token & {
+  thread_local std::stop_token instance{};
+  return instance;
+}
+auto computing() noexcept -> std::size_t & {
+  thread_local std::size_t instance{0};
+  return instance;
+}
+
+Commit_reads::Commit_reads(std::span<Compute_node const *const> nodes) {
+  for (auto const *const node : nodes) {
+    if (node == nullptr) {
+      continue;
+    }
+    auto const stripe{commit_stripe(*node)};
+    auto const bit{std::uint_fast32_t{1} << stripe};
+    if ((stripes_ & bit) != 0) {
+      continue;
+    }
+    auto const &sequence{commit_sequence(stripe)};
+    for (;;) {
+      // applying never waits on a reader
+      await_applied(sequence);
+      auto const current{sequence.load(std::memory_order_seq_cst)};
+      if ((current & commit_counter_mask) != 0) {
+        continue;
+      }
+      if (((current / commit_invalidating) & commit_counter_mask) == 0) {
+        stripes_ |= bit;
+        sequences_[stripe] = current;
+        break;
+      }
+      // a dependent being invalidated may still hold a result cached before
+      Compute_retry const retry{stripe, current};
+      if (computing() != 0) {
+        throw retry;
+      }
+      await_commit(retry);
+    }
+  }
+}
+auto Commit_reads::consistent() const noexcept -> bool {
+  for (auto stripe{std::size_t{0}}; stripe != commit_stripes; ++stripe) {
+    if ((stripes_ & (std::uint_fast32_t{1} << stripe)) != 0 &&
+        commit_sequence(stripe).load(std::memory_order_seq_cst) !=
+            sequences_[stripe]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void await_commit(Compute_retry const &retry) noexcept {
+  commit_sequence(retry.stripe_)
+      .wait(retry.sequence_, std::memory_order_seq_cst);
+}
+
+// the mirror is published racily with bumps, so it only ever moves forward
+static void raise_version(std::atomic<Compute_node::version_type> &mirror,
+                          Compute_node::version_type version) noexcept {
+  auto current{mirror.load(std::memory_order_relaxed)};
+  while (current < version &&
+         !mirror.compare_exchange_weak(current, version,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+  }
+  mirror.notify_all();
+}
+
+// remembers where a node was allocated, aligned like ::operator new or like
+// the node if it is over-aligned
+constexpr static auto node_header_size{alignof(std::max_align_t)};
+static_assert(sizeof(std::pmr::memory_resource *) <= node_header_size,
+              u8"Implementation error");
+constexpr static auto node_header_size_for [[nodiscard]] (
+    std::size_t alignment) noexcept {
+  return std::max(node_header_size, alignment);
+}
+
+static auto allocate_node [[nodiscard]] (std::size_t size,
+                                         std::size_t alignment) -> void * {
+  auto *const resource{graph_resource()};
+  auto const header_size{node_header_size_for(alignment)};
+  auto const total{header_size + size};
+  void *base{};
+  if (resource != nullptr) {
+    base = resource->allocate(total, std::max(alignment, node_header_size));
+  } else if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+    base = ::operator new(total, std::align_val_t{alignment});
+  } else {
+    base = ::operator new(total);
+  }
+  ::new (base) std::pmr::memory_resource *{resource};
+  return static_cast<std::byte *>(base) + header_size;
+}
+static void deallocate_node(void *ptr, std::size_t size,
+                            std::size_t alignment) noexcept {
+  if (ptr == nullptr) {
+    return;
+  }
+  auto const header_size{node_header_size_for(alignment)};
+  auto *const base{static_cast<std::byte *>(ptr) - header_size};
+  auto const total{header_size + size};
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  if (auto *const resource{*std::launder(
+          reinterpret_cast<std::pmr::memory_resource **>(base))}) {
+    resource->deallocate(base, total, std::max(alignment, node_header_size));
+  } else if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+    ::operator delete(base, total, std::align_val_t{alignment});
+  } else {
+    ::operator delete(base, total);
+  }
+}
+} // namespace detail
+
+Compute_node::Compute_node() noexcept = default;
+Compute_node::~Compute_node() noexcept {
+  if (version_cell_) {
+    version_cell_->store(expired_version, std::memory_order_release);
+    version_cell_->notify_all();
+  }
+}
+
+auto Compute_node::operator new(std::size_t size) -> void * {
+  return detail::allocate_node(size, alignof(std::max_align_t));
+}
+auto Compute_node::operator new(std::size_t size, std::align_val_t alignment)
+    -> void * {
+  return detail::allocate_node(size, util::f::to_underlying(alignment));
+}
+void Compute_node::operator delete(void *ptr, std::size_t size) noexcept {
+  detail::deallocate_node(ptr, size, alignof(std::max_align_t));
+}
+void Compute_node::operator delete(void *ptr, std::size_t size,
+                                   std::align_val_t alignment) noexcept {
+  detail::deallocate_node(ptr, size, util::f::to_underlying(alignment));
+}
+
+void Compute_node::add_dependent(Compute_node const &dependent,
+                                 generation_type generation) const {
+  auto weak_dependent{dependent.weak_from_node()};
+  std::lock_guard const guard{dependents_mutex_};
+  std::erase_if(dependents_, [](auto const &entry) noexcept {
+    return entry.first.expired();
+  });
+  dependents_.emplace_back(std::move(weak_dependent), generation);
+}
+
+void Compute_node::remove_dependent(
+    Compute_node const &dependent) const noexcept {
+  auto const weak_dependent{dependent.weak_from_node()};
+  std::lock_guard const guard{dependents_mutex_};
+  std::erase_if(dependents_, [&weak_dependent](auto const &entry) noexcept {
+    return entry.first.expired() ||
+           !(entry.first.owner_before(weak_dependent) ||
+             weak_dependent.owner_before(entry.first));
+  });
+}
+
+void Compute_node::invalidate_dependents() const {
+  // seq_cst pairs with version_cell(), so one of the two sees the other
+  auto const version{version_.fetch_add(1, std::memory_order_seq_cst) + 1};
+  if (auto *const mirror{version_mirror_.load(std::memory_order_seq_cst)}) {
+    detail::raise_version(*mirror, version);
+  }
+  // a snapshot, so that concurrent writers each reach every edge; nested
+  // invalidations stack theirs above ours, so the capacity is kept
+  thread_local decltype(dependents_) snapshot{};
+  auto const begin{snapshot.size()};
+  auto const truncate{gsl::finally([begin] { snapshot.resize(begin); })};
+  {
+    std::lock_guard const guard{dependents_mutex_};
+    snapshot.insert(snapshot.end(), dependents_.cbegin(), dependents_.cend());
+  }
+  auto const end{snapshot.size()};
+  auto stale{false};
+  // never call into dependents while holding the mutex, they may re-register
+  for (auto index{begin}; index != end; ++index) {
+    // nested invalidations may reallocate the snapshot
+    auto const locked{snapshot[index].first.lock()};
+    if (locked && locked->invalidate(snapshot[index].second)) {
+      snapshot[index].first.reset();
+    } else {
+      stale = true;
+    }
+  }
+  if (!stale) {
+    return;
+  }
+  // the edges left in the snapshot are to destroyed nodes or older generations
+  std::lock_guard const guard{dependents_mutex_};
+  std::erase_if(dependents_, [begin, end](auto const &entry) noexcept {
+    return entry.first.expired() ||
+           std::any_of(snapshot.cbegin() + begin, snapshot.cbegin() + end,
+                       [&entry](auto const &left) noexcept {
+                         return left.second == entry.second &&
+                                !(left.first.owner_before(entry.first) ||
+                                  entry.first.owner_before(left.first));
+                       });
+  });
+}
+
+auto Compute_node::version() const noexcept -> version_type {
+  return version_.load(std::memory_order_acquire);
+}
+
+auto Compute_node::version_cell() const
+    -> std::shared_ptr<std::atomic<version_type> const> {
+  std::lock_guard const guard{dependents_mutex_};
+  if (!version_cell_) {
+    version_cell_ = std::make_shared<std::atomic<version_type>>(0);
+    version_mirror_.store(version_cell_.get(), std::memory_order_seq_cst);
+    // catches up with bumps that missed the mirror
+    detail::raise_version(*version_cell_,
+                          version_.load(std::memory_order_seq_cst));
+  }
+  return version_cell_;
+}
+
+auto Compute_node::dependencies() const
+    -> std::vector<std::shared_ptr<Compute_node const>> {
+  return {};
+}
+
+auto Compute_node::evaluate_async(Compute_scheduler &scheduler
+                                  [[maybe_unused]]) const
+    -> Compute_future<void> {
+  evaluate();
+  co_return;
+}
+
+auto Compute_node::invalidate(generation_type generation
+                              [[maybe_unused]]) const -> bool {
+  return true;
+}
+} // namespace artccel::core::compute
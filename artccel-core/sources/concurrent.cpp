@@ -1,11 +1,765 @@
-#include <mutex> // import std::mutex, std::recursive_mutex, std::recursive_timed_mutex, std::timed_mutex
+#include <algorithm> // import std::clamp, std::min, std::ranges::for_each, std::ranges::partition
+#include <array>     // import std::array
+#include <atomic> // import std::atomic, std::atomic_thread_fence, std::memory_order_acq_rel, std::memory_order_acquire, std::memory_order_relaxed, std::memory_order_release, std::memory_order_seq_cst
+#include <bit>     // import std::bit_ceil, std::bit_width
+#include <chrono>  // import std::chrono::duration_cast, std::chrono::nanoseconds
+#include <cstddef> // import std::ptrdiff_t, std::size_t
+#include <cstdint> // import std::uint_fast32_t, std::uint_fast64_t
+#include <exception> // import std::current_exception, std::exception_ptr, std::rethrow_exception
+#include <limits>    // import std::numeric_limits
+#include <memory>    // import std::make_unique, std::unique_ptr
+#include <mutex> // import std::lock_guard, std::mutex, std::recursive_mutex, std::recursive_timed_mutex, std::timed_mutex, std::unique_lock
 #include <shared_mutex> // import std::shared_mutex, std::shared_timed_mutex
+#include <span>         // import std::span
+#include <stop_token>   // import std::stop_token
+#include <string>       // import std::u8string
+#include <string_view>  // import std::u8string_view
+#include <thread> // import std::jthread, std::this_thread::yield, std::thread::hardware_concurrency
+#include <utility> // import std::exchange, std::move
+#include <vector>  // import std::vector
 
 #include <artccel/core/util/concurrent.hpp> // interface
 
+#include <artccel/core/util/sample_registry.hpp> // import detail::Sample_registry
+
 #include <artccel/core/export.h> // import ARTCCEL_CORE_EXPORT_DEFINITION
 
 namespace artccel::core::util {
+namespace detail {
+struct alignas(cache_line_size) Epoch_slot {
+  constexpr static std::uint_fast64_t quiescent_{0};
+  std::atomic<std::uint_fast64_t> epoch_{quiescent_};
+  std::atomic<bool> owned_{false};
+  Epoch_slot *next_{nullptr};
+};
+
+class Epoch_domain {
+private:
+  struct Retired {
+    void const *ptr_;
+    void (*deleter_)(void const *) noexcept;
+    std::uint_fast64_t epoch_;
+  };
+
+  alignas(cache_line_size) std::atomic<std::uint_fast64_t> epoch_{1};
+  alignas(cache_line_size) std::atomic<Epoch_slot *> slots_{nullptr};
+  std::mutex retired_mutex_{};
+  std::vector<Retired> retired_{};
+
+public:
+  constexpr Epoch_domain() noexcept = default;
+  ~Epoch_domain() noexcept {
+    std::ranges::for_each(retired_, [](Retired const &retired) noexcept {
+      retired.deleter_(retired.ptr_);
+    });
+    for (auto *slot{slots_.load(std::memory_order_acquire)}; slot != nullptr;) {
+      // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+      delete std::exchange(slot, slot->next_);
+    }
+  }
+  Epoch_domain(Epoch_domain const &) = delete;
+  auto operator=(Epoch_domain const &) = delete;
+  Epoch_domain(Epoch_domain &&) = delete;
+  auto operator=(Epoch_domain &&) = delete;
+
+  auto acquire_slot [[nodiscard]] () -> Epoch_slot & {
+    // slots are never freed before the domain, only recycled
+    for (auto *slot{slots_.load(std::memory_order_acquire)}; slot != nullptr;
+         slot = slot->next_) {
+      if (!slot->owned_.load(std::memory_order_relaxed) &&
+          !slot->owned_.exchange(true, std::memory_order_acquire)) {
+        return *slot;
+      }
+    }
+    auto *const slot{std::make_unique<Epoch_slot>().release()};
+    slot->owned_.store(true, std::memory_order_relaxed);
+    slot->next_ = slots_.load(std::memory_order_relaxed);
+    while (!slots_.compare_exchange_weak(slot->next_, slot,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+    }
+    return *slot;
+  }
+  void enter(Epoch_slot &slot) noexcept {
+    slot.epoch_.store(epoch_.load(std::memory_order_seq_cst),
+                      std::memory_order_seq_cst);
+  }
+  void retire(void const *ptr, void (*deleter)(void const *) noexcept) {
+    // readers entering after the increment cannot observe ptr
+    auto const epoch{epoch_.fetch_add(1, std::memory_order_seq_cst)};
+    std::vector<Retired> reclaimable{};
+    {
+      std::lock_guard const guard{retired_mutex_};
+      retired_.emplace_back(Retired{ptr, deleter, epoch});
+      auto const oldest{oldest_epoch()};
+      auto const expired{
+          std::ranges::partition(retired_, [oldest](Retired const &retired) {
+            return retired.epoch_ >= oldest;
+          })};
+      reclaimable.assign(expired.begin(), expired.end());
+      retired_.erase(expired.begin(), expired.end());
+    }
+    std::ranges::for_each(reclaimable, [](Retired const &retired) noexcept {
+      retired.deleter_(retired.ptr_);
+    });
+  }
+
+private:
+  auto oldest_epoch [[nodiscard]] () const noexcept -> std::uint_fast64_t {
+    auto ret{std::numeric_limits<std::uint_fast64_t>::max()};
+    for (auto *slot{slots_.load(std::memory_order_acquire)}; slot != nullptr;
+         slot = slot->next_) {
+      if (auto const epoch{slot->epoch_.load(std::memory_order_seq_cst)};
+          epoch != Epoch_slot::quiescent_ && epoch < ret) {
+        ret = epoch;
+      }
+    }
+    return ret;
+  }
+#pragma warning(suppress : 4324)
+};
+
+static auto epoch_domain() -> Epoch_domain & {
+  static Epoch_domain instance{};
+  return instance;
+}
+
+struct Epoch_thread {
+  Epoch_slot *slot_{nullptr};
+  std::size_t nesting_{0};
+
+  constexpr Epoch_thread() noexcept = default;
+  ~Epoch_thread() noexcept {
+    if (slot_ != nullptr) {
+      slot_->owned_.store(false, std::memory_order_release);
+    }
+  }
+  Epoch_thread(Epoch_thread const &) = delete;
+  auto operator=(Epoch_thread const &) = delete;
+  Epoch_thread(Epoch_thread &&) = delete;
+  auto operator=(Epoch_thread &&) = delete;
+};
+thread_local constinit Epoch_thread epoch_thread{};
+
+// allocated by submitting a function, deleted by its run, so that the captures
+// go before the group, which may be gone once finished
+class Function_task final : public Task {
+private:
+  Task_executor::task_type function_;
+
+public:
+  explicit Function_task(Task_executor::task_type function) noexcept
+      : function_{std::move(function)} {}
+
+  void run() override {
+    std::unique_ptr<Function_task> const owned{this};
+    function_();
+  }
+};
+
+// Chase-Lev deque, see "Correct and Efficient Work-Stealing for Weak Memory
+// Models" (Lê et al., 2013); only the owner pushes and pops, others steal
+class Task_deque {
+private:
+  struct Ring {
+    std::ptrdiff_t capacity_;
+    std::unique_ptr<std::atomic<Task *>[]> tasks_;
+
+    explicit Ring(std::ptrdiff_t capacity)
+        : capacity_{capacity},
+          tasks_{std::make_unique<std::atomic<Task *>[]>(
+              static_cast<std::size_t>(capacity))} {}
+    auto at(std::ptrdiff_t index) const -> std::atomic<Task *> & {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+      return tasks_[static_cast<std::size_t>(index & (capacity_ - 1))];
+    }
+  };
+  constexpr static std::ptrdiff_t initial_capacity_{64};
+
+  alignas(cache_line_size) std::atomic<std::ptrdiff_t> top_{0};
+  alignas(cache_line_size) std::atomic<std::ptrdiff_t> bottom_{0};
+  std::atomic<Ring *> ring_{nullptr};
+  // retired rings may still be read by thieves, freed with the deque
+  std::vector<std::unique_ptr<Ring>> rings_{};
+
+public:
+  Task_deque() {
+    rings_.emplace_back(std::make_unique<Ring>(initial_capacity_));
+    ring_.store(rings_.back().get(), std::memory_order_relaxed);
+  }
+
+  void push(Task *task) {
+    auto const bottom{bottom_.load(std::memory_order_relaxed)};
+    auto const top{top_.load(std::memory_order_acquire)};
+    auto *ring{ring_.load(std::memory_order_relaxed)};
+    if (bottom - top > ring->capacity_ - 1) {
+      auto grown{std::make_unique<Ring>(ring->capacity_ * 2)};
+      for (auto index{top}; index != bottom; ++index) {
+        grown->at(index).store(ring->at(index).load(std::memory_order_relaxed),
+                               std::memory_order_relaxed);
+      }
+      ring = rings_.emplace_back(std::move(grown)).get();
+      ring_.store(ring, std::memory_order_release);
+    }
+    ring->at(bottom).store(task, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+  }
+  auto pop [[nodiscard]] () noexcept -> Task * {
+    auto const bottom{bottom_.load(std::memory_order_relaxed) - 1};
+    auto *const ring{ring_.load(std::memory_order_relaxed)};
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto top{top_.load(std::memory_order_relaxed)};
+    if (top > bottom) {
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    auto *ret{ring->at(bottom).load(std::memory_order_relaxed)};
+    if (top == bottom) {
+      // last task, race against thieves
+      if (!top_.compare_exchange_strong(top, top + 1,
+                                        std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        ret = nullptr;
+      }
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return ret;
+  }
+  // retries when losing a race, so that nullptr means empty
+  auto steal [[nodiscard]] () noexcept -> Task * {
+    for (;;) {
+      auto top{top_.load(std::memory_order_acquire)};
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      auto const bottom{bottom_.load(std::memory_order_acquire)};
+      if (top >= bottom) {
+        return nullptr;
+      }
+      auto *const task{ring_.load(std::memory_order_acquire)
+                           ->at(top)
+                           .load(std::memory_order_relaxed)};
+      if (top_.compare_exchange_strong(top, top + 1,
+                                       std::memory_order_seq_cst,
+                                       std::memory_order_relaxed)) {
+        return task;
+      }
+    }
+  }
+#pragma warning(suppress : 4324)
+};
+
+struct Task_thread {
+  void const *executor_{nullptr}; // set on the workers only
+  std::size_t index_{0};
+  std::uint_fast32_t seed_{1};
+};
+thread_local constinit Task_thread task_thread{};
+
+class Lock_registry
+    : public Sample_registry<Lock_registry, Lock_counters,
+                             Lock_metrics_sample> {
+private:
+  friend Sample_registry;
+
+  Lock_registry() noexcept = default;
+
+  static auto sample [[nodiscard]] (Lock_counters const &lock) {
+    return lock.sample();
+  }
+  static void accumulate(Lock_metrics_sample &total,
+                         Lock_counters const &lock) noexcept {
+    lock.accumulate(total);
+  }
+
+public:
+  // constructed before the first lock, so destroyed after the last static one
+  static auto instance [[nodiscard]] () -> Lock_registry & {
+    static Lock_registry instance{};
+    return instance;
+  }
+};
+
+// starts of the shared holds of this thread, most recent last
+struct Shared_holds {
+  struct Hold {
+    Lock_counters const *lock_;
+    Lock_counters::clock_type::time_point start_;
+  };
+  constexpr static std::size_t capacity_{16};
+
+  std::array<Hold, capacity_> holds_{};
+  std::size_t size_{0};
+};
+thread_local constinit Shared_holds shared_holds{};
+
+static void add(Lock_counters::counter_type &counter,
+                std::uint_fast64_t value) noexcept {
+  counter.fetch_add(value, std::memory_order_relaxed);
+}
+static void add_histogram(
+    std::array<Lock_counters::counter_type, lock_histogram_buckets> &histogram,
+    Lock_counters::clock_type::duration duration) noexcept {
+  auto const nanoseconds{static_cast<std::uint_fast64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count())};
+  add(histogram.at(
+          std::min(static_cast<std::size_t>(std::bit_width(nanoseconds)),
+                   lock_histogram_buckets - 1)),
+      1);
+}
+
+// a power of two, so that a thread index masks to a stripe
+static auto stripe_count [[nodiscard]] () noexcept {
+  constexpr static std::size_t max{64};
+  static auto const ret{std::bit_ceil(std::clamp(
+      std::size_t{std::thread::hardware_concurrency()}, std::size_t{1}, max))};
+  return ret;
+}
+// consecutive in order of the first shared lock of each thread, so that up to
+// stripe_count() threads never share a stripe
+static auto stripe_index [[nodiscard]] () noexcept {
+  constinit static std::atomic<std::size_t> next{0};
+  thread_local auto const ret{next.fetch_add(1, std::memory_order_relaxed)};
+  return ret;
+}
+} // namespace detail
+
+class Task_executor::Impl {
+private:
+  std::vector<detail::Task_deque> deques_;
+  // a Treiber stack, pushed lock-free; the takers are serialized, so that a
+  // task cannot be taken and pushed again while another one pops it
+  alignas(cache_line_size) std::atomic<Task *> injection_{nullptr};
+  Spin_shared_mutex injection_taker_{};
+  alignas(cache_line_size) std::atomic<std::uint_fast32_t> epoch_{0};
+  alignas(cache_line_size) std::atomic<std::size_t> sleepers_{0};
+  std::vector<std::jthread> workers_{};
+
+public:
+  explicit Impl(std::size_t concurrency) : deques_(concurrency) {
+    workers_.reserve(concurrency);
+    try {
+      for (std::size_t index{0}; index != concurrency; ++index) {
+        workers_.emplace_back([this, index](std::stop_token const &stop) {
+          work(stop, index);
+        });
+      }
+    } catch (...) {
+      // the destructor does not run, and the workers started would otherwise
+      // sleep through the stop request of their std::jthread
+      stop_workers();
+      throw;
+    }
+  }
+  ~Impl() noexcept {
+    stop_workers();
+    while (run_one()) {
+    }
+  }
+  Impl(Impl const &) = delete;
+  auto operator=(Impl const &) = delete;
+  Impl(Impl &&) = delete;
+  auto operator=(Impl &&) = delete;
+
+  auto concurrency [[nodiscard]] () const noexcept { return workers_.size(); }
+  void submit(std::span<Task *const> tasks) noexcept {
+    if (tasks.empty()) {
+      return;
+    }
+    for (auto index{tasks.size() - 1}; index != 0; --index) {
+      tasks[index - 1]->next_ = tasks[index];
+    }
+    tasks.back()->next_ = nullptr;
+    distribute(tasks.front());
+    wake(tasks.size() != 1);
+  }
+  auto run_one() -> bool {
+    if (auto *const task{take()}) {
+      run(task);
+      return true;
+    }
+    return false;
+  }
+
+private:
+  // wakes sleeping workers, so that they see the stop request, then joins
+  void stop_workers() noexcept {
+    std::ranges::for_each(workers_,
+                          [](auto &worker) { worker.request_stop(); });
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+    epoch_.notify_all();
+    workers_.clear();
+  }
+  void wake(bool all) noexcept {
+    // pairs with the fence in work, so that either the tasks are seen or the
+    // sleeper is woken
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) != 0) {
+      epoch_.fetch_add(1, std::memory_order_relaxed);
+      if (all) {
+        epoch_.notify_all();
+      } else {
+        epoch_.notify_one();
+      }
+    }
+  }
+  // queues a list linked by Task::next_ onto the deque of the calling worker,
+  // or what does not fit there onto the injection stack
+  void distribute(Task *tasks) noexcept {
+    if (auto const &thread{detail::task_thread}; thread.executor_ == this) {
+      while (tasks != nullptr) {
+        // unlinked first, as a thief may run and resubmit it once pushed
+        auto *const next{std::exchange(tasks->next_, nullptr)};
+        try {
+          deques_[thread.index_].push(tasks);
+        } catch (...) {
+          // the deque could not grow
+          tasks->next_ = next;
+          break;
+        }
+        tasks = next;
+      }
+    }
+    if (tasks == nullptr) {
+      return;
+    }
+    auto *last{tasks};
+    while (last->next_ != nullptr) {
+      last = last->next_;
+    }
+    last->next_ = injection_.load(std::memory_order_relaxed);
+    while (!injection_.compare_exchange_weak(last->next_, tasks,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+    }
+  }
+  static void run(Task *task) noexcept {
+    auto *const group{task->group_};
+    if (group == nullptr) {
+      task->run();
+      return;
+    }
+    std::exception_ptr exception{};
+    try {
+      task->run();
+    } catch (...) {
+      exception = std::current_exception();
+    }
+    group->finish(std::move(exception));
+  }
+  // a worker takes the stack whole, moving the rest onto its deque, where
+  // idle workers steal from; any other thread pops one task
+  auto take_injected [[nodiscard]] (bool worker) noexcept -> Task * {
+    Task *task{nullptr};
+    {
+      std::lock_guard const guard{injection_taker_};
+      if (worker) {
+        task = injection_.exchange(nullptr, std::memory_order_acquire);
+      } else {
+        task = injection_.load(std::memory_order_acquire);
+        while (task != nullptr &&
+               !injection_.compare_exchange_weak(task, task->next_,
+                                                 std::memory_order_acquire,
+                                                 std::memory_order_acquire)) {
+        }
+      }
+    }
+    if (task == nullptr) {
+      return nullptr;
+    }
+    // what follows a task popped alone is still on the stack
+    if (auto *const rest{std::exchange(task->next_, nullptr)};
+        worker && rest != nullptr) {
+      distribute(rest);
+      wake(true);
+    }
+    return task;
+  }
+  auto take [[nodiscard]] () -> Task * {
+    auto &thread{detail::task_thread};
+    auto const worker{thread.executor_ == this};
+    if (worker) {
+      if (auto *const task{deques_[thread.index_].pop()}) {
+        return task;
+      }
+    }
+    if (injection_.load(std::memory_order_relaxed) != nullptr) {
+      if (auto *const task{take_injected(worker)}) {
+        return task;
+      }
+    }
+    // xorshift32, a fresh victim per attempt spreads contention
+    thread.seed_ ^= thread.seed_ << 13U;
+    thread.seed_ ^= thread.seed_ >> 17U;
+    thread.seed_ ^= thread.seed_ << 5U;
+    auto const count{deques_.size()};
+    for (std::size_t offset{0}; offset != count; ++offset) {
+      auto const victim{(thread.seed_ + offset) % count};
+      if (worker && victim == thread.index_) {
+        continue;
+      }
+      if (auto *const task{deques_[victim].steal()}) {
+        return task;
+      }
+    }
+    return nullptr;
+  }
+  void work(std::stop_token const &stop, std::size_t index) {
+    detail::task_thread = {this, index,
+                           static_cast<std::uint_fast32_t>(index) + 1};
+    for (;;) {
+      auto *task{take()};
+      if (task == nullptr) {
+        sleepers_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // acquire, so that a stop request is seen with its wake up
+        auto const epoch{epoch_.load(std::memory_order_acquire)};
+        task = take();
+        if (task == nullptr) {
+          // drains the queues even after a stop request
+          if (stop.stop_requested()) {
+            return;
+          }
+          epoch_.wait(epoch, std::memory_order_acquire);
+        }
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+      }
+      if (task != nullptr) {
+        run(task);
+      }
+    }
+  }
+#pragma warning(suppress : 4324)
+};
+
+Epoch_guard::Epoch_guard() {
+  auto &thread{detail::epoch_thread};
+  if (thread.nesting_ == 0) {
+    if (thread.slot_ == nullptr) {
+      thread.slot_ = &detail::epoch_domain().acquire_slot();
+    }
+    detail::epoch_domain().enter(*thread.slot_);
+  }
+  ++thread.nesting_; // not before, in case acquiring the slot throws
+}
+Epoch_guard::~Epoch_guard() noexcept {
+  auto &thread{detail::epoch_thread};
+  if (--thread.nesting_ == 0) {
+    thread.slot_->epoch_.store(detail::Epoch_slot::quiescent_,
+                               std::memory_order_release);
+  }
+}
+
+Striped_shared_mutex::Striped_shared_mutex()
+    : mask_{detail::stripe_count() - 1},
+      stripes_{std::make_unique<Stripe[]>(mask_ + 1)} {}
+Striped_shared_mutex::~Striped_shared_mutex() noexcept = default;
+auto Striped_shared_mutex::stripe() const noexcept -> Stripe & {
+  return stripes_[detail::stripe_index() & mask_];
+}
+auto Striped_shared_mutex::drained() const noexcept -> bool {
+  for (std::size_t index{0}; index <= mask_; ++index) {
+    // pairs with try_lock_shared, one of the two sees the other
+    if (stripes_[index].readers_.load(std::memory_order_seq_cst) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+auto Striped_shared_mutex::try_lock() -> bool {
+  if (!writer_mutex_.try_lock()) {
+    return false;
+  }
+  writer_.store(true, std::memory_order_seq_cst);
+  if (drained()) {
+    return true;
+  }
+  unlock();
+  return false;
+}
+void Striped_shared_mutex::lock() {
+  writer_mutex_.lock();
+  writer_.store(true, std::memory_order_seq_cst);
+  while (!drained()) {
+    std::this_thread::yield();
+  }
+}
+void Striped_shared_mutex::unlock() noexcept {
+  writer_.store(false, std::memory_order_release);
+  writer_.notify_all();
+  writer_mutex_.unlock();
+}
+auto Striped_shared_mutex::try_lock_shared() noexcept -> bool {
+  auto &readers{stripe().readers_};
+  readers.fetch_add(1, std::memory_order_seq_cst);
+  if (!writer_.load(std::memory_order_seq_cst)) {
+    return true;
+  }
+  readers.fetch_sub(1, std::memory_order_release);
+  return false;
+}
+void Striped_shared_mutex::lock_shared() noexcept {
+  while (!try_lock_shared()) {
+    writer_.wait(true, std::memory_order_relaxed);
+  }
+}
+void Striped_shared_mutex::unlock_shared() noexcept {
+  stripe().readers_.fetch_sub(1, std::memory_order_release);
+}
+
+namespace detail {
+Lock_counters::Lock_counters(std::u8string_view type) : type_{type} {
+  Lock_registry::instance().add(*this, id_, type_);
+}
+Lock_counters::~Lock_counters() noexcept {
+  Lock_registry::instance().remove(*this, id_, type_);
+}
+void Lock_counters::acquired(clock_type::duration wait,
+                             bool contended) noexcept {
+  add(acquisitions_, 1);
+  add(contended_, contended ? 1 : 0);
+  add_histogram(wait_, wait);
+}
+void Lock_counters::released(clock_type::duration hold) noexcept {
+  add_histogram(hold_, hold);
+}
+void Lock_counters::acquired_shared(clock_type::duration wait,
+                                    bool contended) noexcept {
+  add(shared_acquisitions_, 1);
+  add(shared_contended_, contended ? 1 : 0);
+  add_histogram(wait_, wait);
+  if (auto &holds{shared_holds}; holds.size_ != Shared_holds::capacity_) {
+    holds.holds_.at(holds.size_++) = {this, clock_type::now()};
+  }
+}
+void Lock_counters::released_shared() noexcept {
+  auto &holds{shared_holds};
+  for (auto index{holds.size_}; index-- != 0;) {
+    if (holds.holds_.at(index).lock_ == this) {
+      add_histogram(hold_, clock_type::now() - holds.holds_.at(index).start_);
+      holds.holds_.at(index) = holds.holds_.at(--holds.size_);
+      return;
+    }
+  }
+}
+auto Lock_counters::sample() const -> Lock_metrics_sample {
+  Lock_metrics_sample ret{};
+  ret.id_ = id_;
+  ret.type_ = type_;
+  ret.live_ = true;
+  accumulate(ret);
+  return ret;
+}
+void Lock_counters::accumulate(Lock_metrics_sample &total) const noexcept {
+  total.acquisitions_ += acquisitions_.load(std::memory_order_relaxed);
+  total.contended_ += contended_.load(std::memory_order_relaxed);
+  total.shared_acquisitions_ +=
+      shared_acquisitions_.load(std::memory_order_relaxed);
+  total.shared_contended_ += shared_contended_.load(std::memory_order_relaxed);
+  for (std::size_t index{0}; index < lock_histogram_buckets; ++index) {
+    total.wait_.at(index) += wait_.at(index).load(std::memory_order_relaxed);
+    total.hold_.at(index) += hold_.at(index).load(std::memory_order_relaxed);
+  }
+}
+} // namespace detail
+
+Task_executor::Task_executor()
+    : Task_executor{std::thread::hardware_concurrency()} {}
+Task_executor::Task_executor(std::size_t concurrency)
+    : impl_{std::make_unique<Impl>(concurrency)} {}
+Task_executor::~Task_executor() noexcept = default;
+
+auto Task_executor::concurrency() const noexcept -> std::size_t {
+  return impl_->concurrency();
+}
+void Task_executor::submit(task_type task) {
+  submit(*std::make_unique<detail::Function_task>(std::move(task)).release());
+}
+void Task_executor::submit(Task &task) noexcept {
+  task.group_ = nullptr;
+  Task *const tasks{&task};
+  impl_->submit({&tasks, 1});
+}
+void Task_executor::submit(std::span<Task *const> tasks) noexcept {
+  for (auto *const task : tasks) {
+    task->group_ = nullptr;
+  }
+  impl_->submit(tasks);
+}
+auto Task_executor::run_one() -> bool { return impl_->run_one(); }
+
+Task_group::Task_group(Task_executor &executor) noexcept
+    : executor_{&executor} {}
+Task_group::~Task_group() noexcept {
+  try {
+    wait();
+  } catch (...) {
+  }
+}
+void Task_group::submit(Task_executor::task_type task) {
+  submit(*std::make_unique<detail::Function_task>(std::move(task)).release());
+}
+void Task_group::submit(Task &task) noexcept {
+  Task *const tasks{&task};
+  submit({&tasks, 1});
+}
+void Task_group::submit(std::span<Task *const> tasks) noexcept {
+  for (auto *const task : tasks) {
+    task->group_ = this;
+  }
+  pending_.fetch_add(tasks.size(), std::memory_order_relaxed);
+  executor_->impl_->submit(tasks);
+}
+void Task_group::wait() {
+  while (pending_.load(std::memory_order_acquire) != 0) {
+    if (executor_->run_one()) {
+      continue;
+    }
+    // without workers, the rest is running on other waiting threads
+    if (executor_->concurrency() == 0) {
+      std::this_thread::yield();
+      continue;
+    }
+    std::unique_lock lock{mutex_};
+    done_.wait(lock, [this] {
+      return pending_.load(std::memory_order_acquire) == 0;
+    });
+  }
+  // also waits for the last task to leave finish
+  std::lock_guard const guard{mutex_};
+  if (exception_) {
+    std::rethrow_exception(std::exchange(exception_, nullptr));
+  }
+}
+void Task_group::finish(std::exception_ptr exception) noexcept {
+  if (exception) {
+    std::lock_guard const guard{mutex_};
+    if (!exception_) {
+      exception_ = std::move(exception);
+    }
+  }
+  for (auto pending{pending_.load(std::memory_order_relaxed)}; pending > 1;) {
+    if (pending_.compare_exchange_weak(pending, pending - 1,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+      return;
+    }
+  }
+  // possibly the last one, which wait must not return before
+  std::lock_guard const guard{mutex_};
+  pending_.fetch_sub(1, std::memory_order_release);
+  done_.notify_all();
+}
+
+namespace f {
+void epoch_retire(void const *ptr, void (*deleter)(void const *) noexcept) {
+  detail::epoch_domain().retire(ptr, deleter);
+}
+auto lock_metrics_samples() -> std::vector<Lock_metrics_sample> {
+  return detail::Lock_registry::instance().samples();
+}
+} // namespace f
+
 #pragma warning(push)
 #pragma warning(disable : 4251)
 template class ARTCCEL_CORE_EXPORT_DEFINITION Nullable_lockable<std::mutex>;
@@ -19,6 +773,8 @@ template class ARTCCEL_CORE_EXPORT_DEFINITION
     Nullable_lockable<std::shared_mutex>;
 template class ARTCCEL_CORE_EXPORT_DEFINITION
     Nullable_lockable<std::shared_timed_mutex>;
+template class ARTCCEL_CORE_EXPORT_DEFINITION
+    Nullable_lockable<Striped_shared_mutex>;
 #pragma warning(pop)
 
 #if defined _MSC_VER && !defined __clang__
@@ -43,6 +799,9 @@ ARTCCEL_CORE_EXPORT_DEFINITION constexpr
 ARTCCEL_CORE_EXPORT_DEFINITION constexpr
     typename Nullable_lockable<std::shared_timed_mutex>::null_lockable_type
         Nullable_lockable<std::shared_timed_mutex>::null_lockable_;
+ARTCCEL_CORE_EXPORT_DEFINITION constexpr
+    typename Nullable_lockable<Striped_shared_mutex>::null_lockable_type
+        Nullable_lockable<Striped_shared_mutex>::null_lockable_;
 #pragma warning(pop)
 #endif
 } // namespace artccel::core::util
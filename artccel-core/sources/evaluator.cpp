@@ -0,0 +1,161 @@
+#include <algorithm> // import std::ranges::for_each
+#include <atomic>    // import std::atomic, std::memory_order_acq_rel, std::memory_order_relaxed
+#include <cstddef>   // import std::size_t
+#include <exception> // import std::current_exception, std::exception_ptr, std::rethrow_exception
+#include <memory> // import std::make_unique, std::make_unique_for_overwrite, std::shared_ptr, std::unique_ptr
+#include <mutex>         // import std::lock_guard, std::mutex
+#include <span>          // import std::span
+#include <thread>        // import std::thread::hardware_concurrency
+#include <unordered_map> // import std::unordered_map
+#include <utility>       // import std::move
+#include <vector>        // import std::vector
+
+#pragma warning(push)
+#pragma warning(disable : 4626 4820)
+#include <gsl/gsl> // import gsl::index
+#pragma warning(pop)
+
+#include <artccel/core/compute/evaluator.hpp> // interface
+
+#include <artccel/core/compute/compute.hpp> // import Compute_node
+#include <artccel/core/util/concurrent.hpp> // import util::Task, util::Task_executor, util::Task_group
+
+namespace artccel::core::compute {
+namespace detail {
+class Evaluation {
+private:
+  // one per node, so that submitting allocates nothing
+  class Node_task final : public util::Task {
+  private:
+    Evaluation *evaluation_{nullptr};
+    std::size_t index_{0};
+
+  public:
+    void bind(Evaluation &evaluation, std::size_t index) noexcept {
+      evaluation_ = &evaluation;
+      index_ = index;
+    }
+    void run() override { evaluation_->execute(index_); }
+  };
+
+  std::vector<std::shared_ptr<Compute_node const>> nodes_{};
+  std::vector<std::vector<std::size_t>> dependents_{};
+  std::unique_ptr<std::atomic<std::size_t>[]> pending_{};
+  std::unique_ptr<Node_task[]> tasks_{};
+  std::vector<util::Task *> seeds_{};
+  util::Task_group *group_{nullptr};
+  std::mutex exception_mutex_{};
+  std::exception_ptr exception_{};
+
+public:
+  explicit Evaluation(
+      std::span<std::shared_ptr<Compute_node const> const> targets) {
+    std::unordered_map<Compute_node const *, std::size_t> indices{};
+    std::vector<std::size_t> pending{};
+    std::vector<std::size_t> stack{};
+    auto const visit{[this, &indices, &pending,
+                      &stack](std::shared_ptr<Compute_node const> node) {
+      auto const [iter,
+                  inserted]{indices.try_emplace(node.get(), nodes_.size())};
+      if (inserted) {
+        nodes_.emplace_back(std::move(node));
+        dependents_.emplace_back();
+        pending.emplace_back(0);
+        stack.emplace_back(iter->second);
+      }
+      return iter->second;
+    }};
+    std::ranges::for_each(targets, visit);
+    while (!stack.empty()) {
+      auto const index{stack.back()};
+      stack.pop_back();
+      auto dependencies{nodes_[index]->dependencies()};
+      pending[index] = dependencies.size();
+      for (auto &dependency : dependencies) {
+        dependents_[visit(std::move(dependency))].emplace_back(index);
+      }
+    }
+
+    pending_ =
+        std::make_unique_for_overwrite<std::atomic<std::size_t>[]>(
+            nodes_.size());
+    tasks_ = std::make_unique<Node_task[]>(nodes_.size());
+    for (auto index{gsl::index{0}}; auto const count : pending) {
+      auto const node{static_cast<std::size_t>(index)};
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+      pending_[node].store(count, std::memory_order_relaxed);
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+      auto &task{tasks_[node]};
+      task.bind(*this, node);
+      if (count == 0) {
+        seeds_.emplace_back(&task);
+      }
+      ++index;
+    }
+  }
+
+  // each node is submitted once all of its dependencies are evaluated, the
+  // seeds at once
+  void run(util::Task_group &group) {
+    group_ = &group;
+    group.submit(std::span<util::Task *const>{seeds_});
+    group.wait();
+    if (exception_) {
+      std::rethrow_exception(exception_);
+    }
+  }
+
+private:
+  void execute(std::size_t task) {
+    try {
+      nodes_[task]->evaluate();
+    } catch (...) {
+      std::lock_guard const guard{exception_mutex_};
+      if (!exception_) {
+        exception_ = std::current_exception();
+      }
+    }
+    for (auto const dependent : dependents_[task]) {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+      if (pending_[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        group_->submit(tasks_[dependent]);
+      }
+    }
+  }
+#pragma warning(suppress : 4820)
+};
+} // namespace detail
+
+class Compute_evaluator::Impl {
+private:
+  util::Task_executor executor_;
+
+public:
+  explicit Impl(std::size_t concurrency) : executor_{concurrency} {}
+
+  auto concurrency [[nodiscard]] () const noexcept {
+    return executor_.concurrency();
+  }
+  void
+  evaluate(std::span<std::shared_ptr<Compute_node const> const> targets) {
+    detail::Evaluation evaluation{targets};
+    util::Task_group group{executor_};
+    evaluation.run(group);
+  }
+};
+
+Compute_evaluator::Compute_evaluator()
+    : Compute_evaluator{std::thread::hardware_concurrency()} {}
+Compute_evaluator::Compute_evaluator(std::size_t concurrency)
+    : impl_{std::make_unique<Impl>(concurrency)} {}
+Compute_evaluator::~Compute_evaluator() noexcept = default;
+
+auto Compute_evaluator::concurrency() const noexcept -> std::size_t {
+  return impl_->concurrency();
+}
+void Compute_evaluator::evaluate(
+    std::span<std::shared_ptr<Compute_node const> const> targets) {
+  impl_->evaluate(targets);
+}
+} // namespace artccel::core::compute
@@ -11,6 +11,7 @@
 #include <gsl/gsl> // import gsl::final_action, gsl::index, gsl::wzstring, gsl::zstring
 #pragma warning(pop)
 
+#include <artccel/core/compute/metrics.hpp> // import compute::f::metrics_json, compute::f::metrics_text
 #include <artccel/core/main_hooks.hpp> // import Argument::verbatim, Main_program, Raw_arguments, artccel::core::f::safe_main
 #include <artccel/core/util/encoding.hpp> // import util::f::getline_utf8, util::f::utf8_as_utf8_compat, util::literals::encoding::operator""_as_utf8_compat, util::operators::utf8_compat::ostream::operator<<
 #include <artccel/core/util/meta.hpp>     // import util::Template_string
@@ -62,6 +63,20 @@ static void echo_cin() {
             << std::flush;
 }
 
+// --metrics=text or --metrics=json dumps the compute node and lock metrics on
+// exit
+static void print_metrics(Main_program const &program) {
+  for (auto const &arg : program.arguments()) {
+    if (auto const u8arg{arg.utf8()}) {
+      if (*u8arg == u8"--metrics=text") {
+        std::cout << compute::f::metrics_text() << std::flush;
+      } else if (*u8arg == u8"--metrics=json") {
+        std::cout << compute::f::metrics_json() << std::flush;
+      }
+    }
+  }
+}
+
 static auto main_0(Raw_arguments arguments) -> int {
   auto const program_dtor_excs{std::make_shared<
       typename Main_program::destructor_exceptions_out_type>()};
@@ -71,6 +86,7 @@ static auto main_0(Raw_arguments arguments) -> int {
   Main_program const program{arguments, program_dtor_excs};
   detail::print_args(program);
   detail::echo_cin();
+  detail::print_metrics(program);
   return EXIT_SUCCESS;
 }
 } // namespace artccel::core::detail
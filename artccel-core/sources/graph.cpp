@@ -0,0 +1,58 @@
+#include <atomic>          // import std::atomic, std::memory_order_relaxed
+#include <cassert>         // import assert
+#include <cstddef>         // import std::size_t
+#include <memory>          // import std::make_unique
+#include <memory_resource> // import std::pmr::memory_resource, std::pmr::monotonic_buffer_resource
+#include <mutex>           // import std::lock_guard, std::mutex
+
+#include <artccel/core/compute/graph.hpp> // interface
+
+namespace artccel::core::compute {
+class Compute_graph::Impl : public std::pmr::memory_resource {
+private:
+  std::mutex mutex_{};
+  std::pmr::monotonic_buffer_resource arena_;
+  std::atomic<std::size_t> live_{0};
+
+public:
+  Impl() = default;
+  explicit Impl(std::size_t initial_size) : arena_{initial_size} {}
+  ~Impl() noexcept override {
+    assert(live_.load(std::memory_order_relaxed) == 0 &&
+           u8"nodes outlived their Compute_graph");
+  }
+  Impl(Impl const &) = delete;
+  auto operator=(Impl const &) = delete;
+  Impl(Impl &&) = delete;
+  auto operator=(Impl &&) = delete;
+
+private:
+  auto do_allocate(std::size_t bytes, std::size_t alignment)
+      -> void * override {
+    auto *const ret{[this, bytes, alignment] {
+      std::lock_guard const guard{mutex_};
+      return arena_.allocate(bytes, alignment);
+    }()};
+    live_.fetch_add(1, std::memory_order_relaxed);
+    return ret;
+  }
+  void do_deallocate(void *ptr [[maybe_unused]],
+                     std::size_t bytes [[maybe_unused]],
+                     std::size_t alignment [[maybe_unused]]) override {
+    live_.fetch_sub(1, std::memory_order_relaxed);
+  }
+  auto do_is_equal(std::pmr::memory_resource const &other) const noexcept
+      -> bool override {
+    return this == &other;
+  }
+};
+
+Compute_graph::Compute_graph() : impl_{std::make_unique<Impl>()} {}
+Compute_graph::Compute_graph(std::size_t initial_size)
+    : impl_{std::make_unique<Impl>(initial_size)} {}
+Compute_graph::~Compute_graph() noexcept = default;
+
+auto Compute_graph::resource() noexcept -> std::pmr::memory_resource & {
+  return *impl_;
+}
+} // namespace artccel::core::compute
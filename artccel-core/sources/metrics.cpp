@@ -0,0 +1,299 @@
+#include <algorithm> // import std::min, std::ranges::transform
+#include <array>     // import std::array
+#include <atomic>    // import std::memory_order_relaxed
+#include <charconv>  // import std::to_chars
+#include <chrono>    // import std::chrono::nanoseconds
+#include <cstddef>   // import std::size_t
+#include <cstdint>   // import std::uint_fast64_t
+#include <iterator>  // import std::back_inserter
+#include <limits>    // import std::numeric_limits
+#include <mutex>     // import std::lock_guard
+#include <string>    // import std::u8string
+#include <string_view> // import std::u8string_view
+#include <utility>     // import std::exchange
+#include <vector>      // import std::vector
+
+#include <artccel/core/compute/metrics.hpp> // interface
+
+#include <artccel/core/util/concurrent.hpp> // import util::Lock_metrics_sample, util::f::lock_metrics_samples, util::lock_histogram_buckets
+#include <artccel/core/util/sample_registry.hpp> // import util::detail::Sample_registry
+#include <artccel/core/util/string_extras.hpp> // import util::f::append_json_string
+
+namespace artccel::core::compute {
+namespace detail {
+class Metrics_registry
+    : public util::detail::Sample_registry<Metrics_registry, Node_metrics,
+                                           Compute_metrics_sample> {
+private:
+  friend Sample_registry;
+
+  Metrics_registry() noexcept = default;
+
+  static auto sample [[nodiscard]] (Node_metrics const &node) {
+    return node.sample();
+  }
+  static void accumulate(Compute_metrics_sample &total,
+                         Node_metrics const &node) noexcept {
+    node.accumulate(total);
+  }
+
+public:
+  // constructed before the first node, so destroyed after the last static one
+  static auto instance [[nodiscard]] () -> Metrics_registry & {
+    static Metrics_registry instance{};
+    return instance;
+  }
+
+  void label(Node_metrics &node, std::u8string_view label) {
+    std::lock_guard const guard{mutex_};
+    node.label_ = label;
+  }
+};
+
+static auto recorded [[nodiscard]] (Compute_metrics_sample const &sample) {
+  return sample.evaluations_ != 0 || sample.recomputes_ != 0 ||
+         sample.shared_locks_ != 0 || sample.exclusive_locks_ != 0;
+}
+static auto recorded [[nodiscard]] (util::Lock_metrics_sample const &sample) {
+  return sample.acquisitions_ != 0 || sample.shared_acquisitions_ != 0;
+}
+static void append(std::u8string &out, std::uint_fast64_t value) {
+  std::array<char, std::numeric_limits<std::uint_fast64_t>::digits10 + 1>
+      buffer{};
+  auto const result{
+      std::to_chars(buffer.data(), buffer.data() + buffer.size(), value)};
+  std::ranges::transform(buffer.data(), result.ptr, std::back_inserter(out),
+                         [](char chr) { return static_cast<char8_t>(chr); });
+}
+// bounds of a latency bucket in nanoseconds, the upper one exclusive
+static auto bucket_bounds [[nodiscard]] (std::size_t index) noexcept {
+  auto const lower{index == 0 ? std::uint_fast64_t{0}
+                              : std::uint_fast64_t{1} << (index - 1)};
+  return std::array{lower, std::uint_fast64_t{1} << index};
+}
+template <std::size_t Buckets>
+static void append_text_histogram(
+    std::u8string &out, std::u8string_view label,
+    std::array<std::uint_fast64_t, Buckets> const &histogram) {
+  for (std::size_t index{0}; index < Buckets; ++index) {
+    if (auto const count{histogram.at(index)}; count != 0) {
+      auto const [lower, upper]{bucket_bounds(index)};
+      out += label;
+      out += u8" [";
+      append(out, lower);
+      out += u8", ";
+      append(out, upper);
+      out += u8") ns: ";
+      append(out, count);
+      out += u8'\n';
+    }
+  }
+}
+template <std::size_t Buckets>
+static void append_json_histogram(
+    std::u8string &out,
+    std::array<std::uint_fast64_t, Buckets> const &histogram) {
+  out += u8'[';
+  auto first{true};
+  for (std::size_t index{0}; index < Buckets; ++index) {
+    if (auto const count{histogram.at(index)}; count != 0) {
+      auto const [lower, upper]{bucket_bounds(index)};
+      if (!std::exchange(first, false)) {
+        out += u8',';
+      }
+      out += u8"{\"min\":";
+      append(out, lower);
+      out += u8",\"max\":";
+      append(out, upper);
+      out += u8",\"count\":";
+      append(out, count);
+      out += u8'}';
+    }
+  }
+  out += u8']';
+}
+
+Node_metrics::Node_metrics(std::u8string_view type) : type_{type} {
+  Metrics_registry::instance().add(*this, id_, type_);
+}
+Node_metrics::~Node_metrics() noexcept {
+  Metrics_registry::instance().remove(*this, id_, type_);
+}
+void Node_metrics::label(std::u8string_view label) {
+  Metrics_registry::instance().label(*this, label);
+}
+auto Node_metrics::sample() const -> Compute_metrics_sample {
+  Compute_metrics_sample ret{};
+  ret.id_ = id_;
+  ret.type_ = type_;
+  ret.label_ = label_;
+  ret.live_ = true;
+  accumulate(ret);
+  return ret;
+}
+void Node_metrics::accumulate(Compute_metrics_sample &total) const noexcept {
+  auto const evaluations{evaluations_.load(std::memory_order_relaxed)};
+  auto const recomputes{recomputes_.load(std::memory_order_relaxed)};
+  total.evaluations_ += evaluations;
+  total.recomputes_ += recomputes;
+  // a recomputation is counted apart from, and may outlast, its evaluation
+  total.hits_ += evaluations - std::min(evaluations, recomputes);
+  for (std::size_t index{0}; index < metrics_latency_buckets; ++index) {
+    total.latency_.at(index) +=
+        latency_.at(index).load(std::memory_order_relaxed);
+  }
+  total.shared_locks_ += shared_locks_.load(std::memory_order_relaxed);
+  total.shared_wait_ +=
+      std::chrono::nanoseconds{shared_wait_.load(std::memory_order_relaxed)};
+  total.exclusive_locks_ += exclusive_locks_.load(std::memory_order_relaxed);
+  total.exclusive_wait_ +=
+      std::chrono::nanoseconds{exclusive_wait_.load(std::memory_order_relaxed)};
+}
+} // namespace detail
+
+namespace f {
+auto metrics_samples() -> std::vector<Compute_metrics_sample> {
+  return detail::Metrics_registry::instance().samples();
+}
+auto metrics_text() -> std::u8string {
+  if constexpr (!metrics_enabled) {
+    return u8"compute metrics: disabled\n";
+  }
+  std::u8string ret{u8"compute metrics:\n"};
+  for (auto const &sample : metrics_samples()) {
+    if (!detail::recorded(sample)) {
+      continue;
+    }
+    if (sample.live_) {
+      ret += u8"|- node ";
+      detail::append(ret, sample.id_);
+      ret += u8": ";
+    } else {
+      ret += u8"|- destroyed: ";
+    }
+    ret += sample.type_;
+    if (!sample.label_.empty()) {
+      ret += u8" (";
+      ret += sample.label_;
+      ret += u8')';
+    }
+    ret += u8"\n |- evaluations: ";
+    detail::append(ret, sample.evaluations_);
+    ret += u8", hits: ";
+    detail::append(ret, sample.hits_);
+    ret += u8", recomputes: ";
+    detail::append(ret, sample.recomputes_);
+    ret += u8'\n';
+    detail::append_text_histogram(ret, u8" |- latency", sample.latency_);
+    ret += u8" |- shared locks: ";
+    detail::append(ret, sample.shared_locks_);
+    ret += u8", waited ";
+    detail::append(ret, static_cast<std::uint_fast64_t>(
+                            sample.shared_wait_.count()));
+    ret += u8" ns\n |- exclusive locks: ";
+    detail::append(ret, sample.exclusive_locks_);
+    ret += u8", waited ";
+    detail::append(ret, static_cast<std::uint_fast64_t>(
+                            sample.exclusive_wait_.count()));
+    ret += u8" ns\n";
+  }
+  for (auto const &sample : util::f::lock_metrics_samples()) {
+    if (!detail::recorded(sample)) {
+      continue;
+    }
+    if (sample.live_) {
+      ret += u8"|- lock ";
+      detail::append(ret, sample.id_);
+      ret += u8": ";
+    } else {
+      ret += u8"|- destroyed lock: ";
+    }
+    ret += sample.type_;
+    ret += u8"\n |- acquisitions: ";
+    detail::append(ret, sample.acquisitions_);
+    ret += u8", contended: ";
+    detail::append(ret, sample.contended_);
+    ret += u8"\n |- shared acquisitions: ";
+    detail::append(ret, sample.shared_acquisitions_);
+    ret += u8", contended: ";
+    detail::append(ret, sample.shared_contended_);
+    ret += u8'\n';
+    detail::append_text_histogram(ret, u8" |- wait", sample.wait_);
+    detail::append_text_histogram(ret, u8" |- hold", sample.hold_);
+  }
+  return ret;
+}
+auto metrics_json() -> std::u8string {
+  std::u8string ret{u8"{\"enabled\":"};
+  ret += metrics_enabled ? u8"true" : u8"false";
+  ret += u8",\"nodes\":[";
+  auto first{true};
+  for (auto const &sample : metrics_samples()) {
+    if (!detail::recorded(sample)) {
+      continue;
+    }
+    if (!std::exchange(first, false)) {
+      ret += u8',';
+    }
+    ret += u8"{\"id\":";
+    detail::append(ret, sample.id_);
+    ret += u8",\"type\":";
+    util::f::append_json_string(ret, sample.type_);
+    ret += u8",\"label\":";
+    util::f::append_json_string(ret, sample.label_);
+    ret += u8",\"live\":";
+    ret += sample.live_ ? u8"true" : u8"false";
+    ret += u8",\"evaluations\":";
+    detail::append(ret, sample.evaluations_);
+    ret += u8",\"hits\":";
+    detail::append(ret, sample.hits_);
+    ret += u8",\"recomputes\":";
+    detail::append(ret, sample.recomputes_);
+    ret += u8",\"latency_ns\":";
+    detail::append_json_histogram(ret, sample.latency_);
+    ret += u8",\"shared_locks\":";
+    detail::append(ret, sample.shared_locks_);
+    ret += u8",\"shared_wait_ns\":";
+    detail::append(ret, static_cast<std::uint_fast64_t>(
+                            sample.shared_wait_.count()));
+    ret += u8",\"exclusive_locks\":";
+    detail::append(ret, sample.exclusive_locks_);
+    ret += u8",\"exclusive_wait_ns\":";
+    detail::append(ret, static_cast<std::uint_fast64_t>(
+                            sample.exclusive_wait_.count()));
+    ret += u8'}';
+  }
+  ret += u8"],\"locks\":[";
+  first = true;
+  for (auto const &sample : util::f::lock_metrics_samples()) {
+    if (!detail::recorded(sample)) {
+      continue;
+    }
+    if (!std::exchange(first, false)) {
+      ret += u8',';
+    }
+    ret += u8"{\"id\":";
+    detail::append(ret, sample.id_);
+    ret += u8",\"type\":";
+    util::f::append_json_string(ret, sample.type_);
+    ret += u8",\"live\":";
+    ret += sample.live_ ? u8"true" : u8"false";
+    ret += u8",\"acquisitions\":";
+    detail::append(ret, sample.acquisitions_);
+    ret += u8",\"contended\":";
+    detail::append(ret, sample.contended_);
+    ret += u8",\"shared_acquisitions\":";
+    detail::append(ret, sample.shared_acquisitions_);
+    ret += u8",\"shared_contended\":";
+    detail::append(ret, sample.shared_contended_);
+    ret += u8",\"wait_ns\":";
+    detail::append_json_histogram(ret, sample.wait_);
+    ret += u8",\"hold_ns\":";
+    detail::append_json_histogram(ret, sample.hold_);
+    ret += u8'}';
+  }
+  ret += u8"]}\n";
+  return ret;
+}
+} // namespace f
+} // namespace artccel::core::compute
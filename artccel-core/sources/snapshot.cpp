@@ -0,0 +1,371 @@
+#include <algorithm> // import std::ranges::copy, std::ranges::lower_bound
+#include <array>       // import std::array
+#include <bit>         // import std::endian
+#include <cerrno>      // import errno
+#include <cstddef>     // import std::byte, std::max_align_t, std::ptrdiff_t, std::size_t
+#include <cstdint>     // import std::uint32_t, std::uint64_t
+#include <filesystem>  // import std::filesystem::path, std::filesystem::rename
+#include <fstream>     // import std::ofstream
+#include <ios>         // import std::streamsize
+#include <memory>      // import std::make_unique
+#include <optional>    // import std::nullopt, std::optional
+#include <span>        // import std::as_bytes, std::as_writable_bytes, std::span
+#include <string>      // import std::u8string
+#include <string_view> // import std::u8string_view
+#include <system_error> // import std::generic_category, std::system_error
+#include <utility>      // import std::move
+#include <vector>       // import std::vector
+
+#ifdef _WIN32
+#pragma warning(push)
+#pragma warning(disable : 4668 5039)
+#include <windows.h> // import ::CloseHandle, ::CreateFileMappingW, ::CreateFileW, ::GetFileSizeEx, ::GetLastError, ::MapViewOfFile, ::UnmapViewOfFile
+#pragma warning(pop)
+#else
+#include <fcntl.h>    // import ::open
+#include <sys/mman.h> // import ::mmap, ::munmap
+#include <sys/stat.h> // import ::fstat
+#include <unistd.h>   // import ::close
+#endif
+
+#include <artccel/core/compute/snapshot.hpp> // interface
+
+#ifdef _WIN32
+#include <artccel/core/platform/windows_error.hpp> // import platform::windows::f::throw_error, platform::windows::f::throw_last_error
+#endif
+
+namespace artccel::core::compute {
+namespace detail {
+// the file starts with a Snapshot_header, then Snapshot_entry records sorted
+// by key, then the keys and the data they point to, all in native byte order
+struct Snapshot_header {
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::array<char, 8> magic_;
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::uint32_t version_;
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::uint32_t endian_;
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::uint64_t schema_;
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::uint64_t count_;
+};
+struct Snapshot_entry {
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::uint64_t key_offset_;
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::uint64_t key_size_;
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::uint64_t type_;
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::uint64_t data_offset_;
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::uint64_t data_size_;
+};
+constexpr std::array snapshot_magic{'A', 'R', 'T', 'C', 'S', 'N', 'A', 'P'};
+constexpr std::uint32_t snapshot_version{1};
+constexpr auto snapshot_endian{static_cast<std::uint32_t>(std::endian::native)};
+constexpr std::size_t snapshot_data_alignment{alignof(std::max_align_t)};
+
+// copies, as the mapping gives no alignment guarantee past the header
+template <typename Type>
+static auto read_at(std::span<std::byte const> bytes, std::size_t offset)
+    -> std::optional<Type> {
+  if (offset > bytes.size() || bytes.size() - offset < sizeof(Type)) {
+    return std::nullopt;
+  }
+  Type ret{};
+  std::ranges::copy(bytes.subspan(offset, sizeof(Type)),
+                    std::as_writable_bytes(std::span{&ret, 1}).begin());
+  return ret;
+}
+static auto slice(std::span<std::byte const> bytes, std::uint64_t offset,
+                  std::uint64_t size)
+    -> std::optional<std::span<std::byte const>> {
+  if (offset > bytes.size() || bytes.size() - offset < size) {
+    return std::nullopt;
+  }
+  return bytes.subspan(offset, size);
+}
+static auto as_key(std::span<std::byte const> bytes) {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return std::u8string_view{reinterpret_cast<char8_t const *>(bytes.data()),
+                            bytes.size()};
+}
+
+// read-only mapping of a whole file, empty if the file is missing or empty
+class Mapped_file {
+private:
+  std::span<std::byte const> bytes_{};
+#ifdef _WIN32
+  ::HANDLE mapping_{nullptr};
+#endif
+
+public:
+  explicit Mapped_file(std::filesystem::path const &path);
+  ~Mapped_file() noexcept;
+  Mapped_file(Mapped_file const &) = delete;
+  auto operator=(Mapped_file const &) = delete;
+  Mapped_file(Mapped_file &&) = delete;
+  auto operator=(Mapped_file &&) = delete;
+
+  auto bytes [[nodiscard]] () const noexcept { return bytes_; }
+};
+
+#ifdef _WIN32
+Mapped_file::Mapped_file(std::filesystem::path const &path) {
+  auto *const file{::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                                 nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                                 nullptr)};
+  if (file == INVALID_HANDLE_VALUE) {
+    if (auto const error{::GetLastError()};
+        error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND) {
+      return;
+    }
+    platform::windows::f::throw_last_error();
+  }
+  // ::CloseHandle may overwrite the last error, so it is saved first
+  ::LARGE_INTEGER size{};
+  if (::GetFileSizeEx(file, &size) == 0) {
+    auto const error{::GetLastError()};
+    ::CloseHandle(file);
+    platform::windows::f::throw_error(error);
+  }
+  if (size.QuadPart == 0) {
+    ::CloseHandle(file);
+    return;
+  }
+  mapping_ = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  auto const error{::GetLastError()};
+  ::CloseHandle(file); // the mapping keeps the file open
+  if (mapping_ == nullptr) {
+    platform::windows::f::throw_error(error);
+  }
+  auto *const view{::MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0)};
+  if (view == nullptr) {
+    auto const view_error{::GetLastError()};
+    ::CloseHandle(mapping_);
+    platform::windows::f::throw_error(view_error);
+  }
+  bytes_ = {static_cast<std::byte const *>(view),
+            static_cast<std::size_t>(size.QuadPart)};
+}
+Mapped_file::~Mapped_file() noexcept {
+  if (!bytes_.empty()) {
+    ::UnmapViewOfFile(bytes_.data());
+  }
+  if (mapping_ != nullptr) {
+    ::CloseHandle(mapping_);
+  }
+}
+#else
+Mapped_file::Mapped_file(std::filesystem::path const &path) {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+  auto const file{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+  if (file == -1) {
+    if (errno == ENOENT) {
+      return;
+    }
+    throw std::system_error{errno, std::generic_category()};
+  }
+  struct ::stat status {};
+  if (::fstat(file, &status) == -1) {
+    auto const error{errno};
+    ::close(file);
+    throw std::system_error{error, std::generic_category()};
+  }
+  if (status.st_size == 0) {
+    ::close(file);
+    return;
+  }
+  auto const size{static_cast<std::size_t>(status.st_size)};
+  auto *const view{::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0)};
+  auto const error{errno};
+  ::close(file); // the mapping keeps the file open
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast,performance-no-int-to-ptr)
+  if (view == MAP_FAILED) {
+    throw std::system_error{error, std::generic_category()};
+  }
+  bytes_ = {static_cast<std::byte const *>(view), size};
+}
+Mapped_file::~Mapped_file() noexcept {
+  if (!bytes_.empty()) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    ::munmap(const_cast<std::byte *>(bytes_.data()), bytes_.size());
+  }
+}
+#endif
+} // namespace detail
+
+class Compute_snapshot_writer::Impl {
+private:
+  struct Entry {
+    std::u8string key_;
+    std::uint64_t type_;
+    std::vector<std::byte> data_;
+  };
+  std::uint64_t schema_;
+  std::vector<Entry> entries_{};
+
+public:
+  explicit Impl(std::uint64_t schema) : schema_{schema} {}
+
+  void add(std::u8string_view key, std::uint64_t type,
+           std::vector<std::byte> data) {
+    auto const found{std::ranges::lower_bound(entries_, key, {}, &Entry::key_)};
+    if (found != entries_.end() && found->key_ == key) {
+      found->type_ = type;
+      found->data_ = std::move(data);
+      return;
+    }
+    entries_.insert(found, Entry{std::u8string{key}, type, std::move(data)});
+  }
+  auto serialize [[nodiscard]] () const -> std::vector<std::byte> {
+    auto const index_size{sizeof(detail::Snapshot_header) +
+                          entries_.size() * sizeof(detail::Snapshot_entry)};
+    std::vector<detail::Snapshot_entry> index{};
+    index.reserve(entries_.size());
+    auto offset{index_size};
+    for (auto const &entry : entries_) {
+      index.emplace_back(detail::Snapshot_entry{offset, entry.key_.size(),
+                                                entry.type_, 0,
+                                                entry.data_.size()});
+      offset += entry.key_.size();
+    }
+    for (auto &entry : index) {
+      offset = (offset + detail::snapshot_data_alignment - 1) /
+               detail::snapshot_data_alignment *
+               detail::snapshot_data_alignment;
+      entry.data_offset_ = offset;
+      offset += entry.data_size_;
+    }
+    std::vector<std::byte> ret(offset);
+    detail::Snapshot_header const header{
+        detail::snapshot_magic, detail::snapshot_version,
+        detail::snapshot_endian, schema_, entries_.size()};
+    auto out{std::ranges::copy(std::as_bytes(std::span{&header, 1}),
+                               ret.begin())
+                 .out};
+    std::ranges::copy(std::as_bytes(std::span{index}), out);
+    for (std::size_t position{0}; position < entries_.size(); ++position) {
+      auto const &entry{entries_[position]};
+      std::ranges::copy(std::as_bytes(std::span{entry.key_}),
+                        ret.begin() + static_cast<std::ptrdiff_t>(
+                                          index[position].key_offset_));
+      std::ranges::copy(entry.data_,
+                        ret.begin() + static_cast<std::ptrdiff_t>(
+                                          index[position].data_offset_));
+    }
+    return ret;
+  }
+};
+
+class Compute_snapshot::Impl {
+private:
+  detail::Mapped_file file_;
+  std::size_t count_{0};
+
+public:
+  explicit Impl(std::filesystem::path const &path, std::uint64_t schema)
+      : file_{path} {
+    auto const bytes{file_.bytes()};
+    auto const header{detail::read_at<detail::Snapshot_header>(bytes, 0)};
+    if (!header || header->magic_ != detail::snapshot_magic ||
+        header->version_ != detail::snapshot_version ||
+        header->endian_ != detail::snapshot_endian ||
+        header->schema_ != schema ||
+        header->count_ > (bytes.size() - sizeof(detail::Snapshot_header)) /
+                             sizeof(detail::Snapshot_entry)) {
+      return;
+    }
+    count_ = header->count_;
+  }
+  ~Impl() noexcept = default;
+  Impl(Impl const &) = delete;
+  auto operator=(Impl const &) = delete;
+  Impl(Impl &&) = delete;
+  auto operator=(Impl &&) = delete;
+
+  auto size [[nodiscard]] () const noexcept { return count_; }
+  auto entry [[nodiscard]] (std::size_t position) const {
+    return *detail::read_at<detail::Snapshot_entry>(
+        file_.bytes(), sizeof(detail::Snapshot_header) +
+                           position * sizeof(detail::Snapshot_entry));
+  }
+  auto find [[nodiscard]] (std::u8string_view key, std::uint64_t type) const
+      -> std::optional<std::span<std::byte const>> {
+    auto const bytes{file_.bytes()};
+    // binary search, reading entries out of the mapping as it goes
+    std::size_t first{0};
+    for (auto count{count_}; count > 0;) {
+      auto const half{count / 2};
+      auto const candidate{entry(first + half)};
+      auto const candidate_key{
+          detail::slice(bytes, candidate.key_offset_, candidate.key_size_)};
+      if (!candidate_key) {
+        return std::nullopt;
+      }
+      if (detail::as_key(*candidate_key) < key) {
+        first += half + 1;
+        count -= half + 1;
+      } else {
+        count = half;
+      }
+    }
+    if (first == count_) {
+      return std::nullopt;
+    }
+    auto const found{entry(first)};
+    auto const found_key{
+        detail::slice(bytes, found.key_offset_, found.key_size_)};
+    if (!found_key || detail::as_key(*found_key) != key ||
+        found.type_ != type) {
+      return std::nullopt;
+    }
+    return detail::slice(bytes, found.data_offset_, found.data_size_);
+  }
+};
+
+Compute_snapshot_writer::Compute_snapshot_writer(std::uint64_t schema)
+    : impl_{std::make_unique<Impl>(schema)} {}
+Compute_snapshot_writer::~Compute_snapshot_writer() noexcept = default;
+Compute_snapshot_writer::Compute_snapshot_writer(
+    Compute_snapshot_writer &&) noexcept = default;
+auto Compute_snapshot_writer::operator=(Compute_snapshot_writer &&) noexcept
+    -> Compute_snapshot_writer & = default;
+
+void Compute_snapshot_writer::add(std::u8string_view key, std::uint64_t type,
+                                  std::vector<std::byte> data) {
+  impl_->add(key, type, std::move(data));
+}
+void Compute_snapshot_writer::write(std::filesystem::path const &path) const {
+  auto const bytes{impl_->serialize()};
+  auto temporary{path};
+  temporary += u8".tmp";
+  {
+    std::ofstream file{};
+    file.exceptions(std::ofstream::badbit | std::ofstream::failbit);
+    file.open(temporary, std::ofstream::binary | std::ofstream::trunc);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    file.write(reinterpret_cast<char const *>(bytes.data()),
+               static_cast<std::streamsize>(bytes.size()));
+  }
+  std::filesystem::rename(temporary, path);
+}
+
+Compute_snapshot::Compute_snapshot(std::filesystem::path const &path,
+                                   std::uint64_t schema)
+    : impl_{std::make_unique<Impl>(path, schema)} {}
+Compute_snapshot::~Compute_snapshot() noexcept = default;
+Compute_snapshot::Compute_snapshot(Compute_snapshot &&) noexcept = default;
+auto Compute_snapshot::operator=(Compute_snapshot &&) noexcept
+    -> Compute_snapshot & = default;
+
+auto Compute_snapshot::size() const noexcept -> std::size_t {
+  return impl_->size();
+}
+auto Compute_snapshot::find(std::u8string_view key, std::uint64_t type) const
+    -> std::optional<std::span<std::byte const>> {
+  return impl_->find(key, type);
+}
+} // namespace artccel::core::compute
@@ -0,0 +1,27 @@
+#include <string>      // import std::u8string
+#include <string_view> // import std::u8string_view
+
+#include <artccel/core/util/string_extras.hpp> // interface
+
+namespace artccel::core::util::f {
+void append_json_string(std::u8string &out, std::u8string_view str) {
+  constexpr static std::u8string_view hex{u8"0123456789abcdef"};
+  constexpr static char8_t control_end{0x20};
+  constexpr static unsigned nibble_bits{4};
+  constexpr static unsigned nibble_mask{0xF};
+  out += u8'"';
+  for (auto const chr : str) {
+    if (chr == u8'"' || chr == u8'\\') {
+      out += u8'\\';
+      out += chr;
+    } else if (chr < control_end) {
+      out += u8"\\u00";
+      out += hex[static_cast<unsigned>(chr) >> nibble_bits];
+      out += hex[static_cast<unsigned>(chr) & nibble_mask];
+    } else {
+      out += chr;
+    }
+  }
+  out += u8'"';
+}
+} // namespace artccel::core::util::f
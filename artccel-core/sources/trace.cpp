@@ -0,0 +1,177 @@
+#include <array>      // import std::array
+#include <atomic> // import std::atomic, std::memory_order_acquire, std::memory_order_relaxed, std::memory_order_release
+#include <charconv>   // import std::to_chars
+#include <chrono>     // import std::chrono::duration_cast, std::chrono::nanoseconds
+#include <cstddef>    // import std::size_t
+#include <cstdint> // import std::int_fast64_t, std::uint_fast64_t, std::uintptr_t
+#include <filesystem> // import std::filesystem::path
+#include <fstream>    // import std::ofstream
+#include <ios>        // import std::dec, std::hex
+#include <memory>     // import std::make_shared, std::make_unique, std::shared_ptr, std::unique_ptr
+#include <mutex>      // import std::lock_guard, std::mutex
+#include <string>      // import std::string, std::u8string
+#include <string_view> // import std::u8string_view
+#include <utility>     // import std::exchange
+#include <vector>      // import std::erase_if, std::vector
+
+#include <artccel/core/compute/trace.hpp> // interface
+
+#include <artccel/core/util/concurrent.hpp> // import util::cache_line_size
+#include <artccel/core/util/encoding.hpp> // import util::f::utf8_as_utf8_compat
+#include <artccel/core/util/string_extras.hpp> // import util::f::append_json_string
+
+namespace artccel::core::compute {
+namespace detail {
+// single producer, the owning thread, and single consumer, the writer
+class Trace_buffer {
+public:
+  constexpr static std::size_t capacity_{std::size_t{1} << 14U};
+
+private:
+  std::unique_ptr<Trace_event[]> events_{
+      std::make_unique<Trace_event[]>(capacity_)};
+  alignas(util::cache_line_size) std::atomic<std::size_t> head_{0};
+  alignas(util::cache_line_size) std::atomic<std::size_t> tail_{0};
+  alignas(util::cache_line_size) std::atomic<std::uint_fast64_t> dropped_{0};
+  std::uint_fast64_t const id_;
+
+public:
+  explicit Trace_buffer(std::uint_fast64_t id) : id_{id} {}
+
+  auto id [[nodiscard]] () const noexcept { return id_; }
+  void push(Trace_event const &event) noexcept {
+    auto const head{head_.load(std::memory_order_relaxed)};
+    if (head - tail_.load(std::memory_order_acquire) == capacity_) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    events_[head % capacity_] = event;
+    head_.store(head + 1, std::memory_order_release);
+  }
+  template <typename Func> void drain(Func &&func) {
+    auto const head{head_.load(std::memory_order_acquire)};
+    auto tail{tail_.load(std::memory_order_relaxed)};
+    for (; tail != head; ++tail) {
+      func(events_[tail % capacity_]);
+    }
+    tail_.store(tail, std::memory_order_release);
+  }
+  auto take_dropped [[nodiscard]] () noexcept {
+    return dropped_.exchange(0, std::memory_order_relaxed);
+  }
+};
+
+class Trace_registry {
+private:
+  std::mutex mutex_{};
+  std::uint_fast64_t next_id_{1};
+  // shared with the owning threads, kept until drained once they exit
+  std::vector<std::shared_ptr<Trace_buffer>> buffers_{};
+
+public:
+  static auto instance [[nodiscard]] () -> Trace_registry & {
+    static Trace_registry instance{};
+    return instance;
+  }
+
+  auto add [[nodiscard]] () -> std::shared_ptr<Trace_buffer> {
+    std::lock_guard const guard{mutex_};
+    return buffers_.emplace_back(std::make_shared<Trace_buffer>(next_id_++));
+  }
+  template <typename Func> void drain(Func &&func) {
+    std::lock_guard const guard{mutex_};
+    for (auto const &buffer : buffers_) {
+      buffer->drain([&func, &buffer](Trace_event const &event) {
+        func(buffer->id(), event);
+      });
+    }
+    std::erase_if(buffers_, [](auto const &buffer) {
+      return buffer.use_count() == 1;
+    });
+  }
+  auto take_dropped [[nodiscard]] () {
+    std::lock_guard const guard{mutex_};
+    std::uint_fast64_t ret{0};
+    for (auto const &buffer : buffers_) {
+      ret += buffer->take_dropped();
+    }
+    return ret;
+  }
+};
+
+static auto microseconds [[nodiscard]] (trace_clock::duration duration) {
+  constexpr static std::size_t size{32};
+  constexpr static std::int_fast64_t per_microsecond{1000};
+  constexpr static std::int_fast64_t fraction_digits{3};
+  constexpr static std::int_fast64_t radix{10};
+  auto const nanoseconds{
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()};
+  std::array<char, size> ret{};
+  auto *ptr{
+      std::to_chars(ret.data(), ret.data() + ret.size(),
+                    nanoseconds / per_microsecond)
+          .ptr};
+  *ptr++ = '.';
+  auto fraction{nanoseconds % per_microsecond};
+  for (auto digit{fraction_digits}; digit-- != 0;) {
+    ptr[digit] = static_cast<char>('0' + fraction % radix);
+    fraction /= radix;
+  }
+  return std::string{ret.data(), ptr + fraction_digits};
+}
+static void write_json_string(std::ofstream &file, std::u8string_view str) {
+  std::u8string json{};
+  util::f::append_json_string(json, str);
+  file << util::f::utf8_as_utf8_compat(json);
+}
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+constinit std::atomic<bool> tracing{false};
+void trace(Trace_event &event) noexcept {
+  event.end_ = trace_clock::now();
+  thread_local std::shared_ptr<Trace_buffer> buffer{};
+  if (!buffer) {
+    try {
+      buffer = Trace_registry::instance().add();
+    } catch (...) {
+      return;
+    }
+  }
+  buffer->push(event);
+}
+} // namespace detail
+
+namespace f {
+void start_trace() noexcept {
+  detail::tracing.store(true, std::memory_order_relaxed);
+}
+void stop_trace() noexcept {
+  detail::tracing.store(false, std::memory_order_relaxed);
+}
+void write_trace(std::filesystem::path const &path) {
+  std::ofstream file{};
+  file.exceptions(std::ofstream::badbit | std::ofstream::failbit);
+  file.open(path, std::ofstream::binary | std::ofstream::trunc);
+  file << R"({"displayTimeUnit":"ns","traceEvents":[)";
+  auto first{true};
+  auto &registry{detail::Trace_registry::instance()};
+  registry.drain([&file, &first](std::uint_fast64_t thread,
+                                 detail::Trace_event const &event) {
+    file << (std::exchange(first, false) ? "\n" : ",\n");
+    file << R"({"ph":"X","cat":"compute","pid":1,"tid":)" << thread
+         << R"(,"name":)";
+    detail::write_json_string(file, event.name_);
+    file << R"(,"ts":)"
+         << detail::microseconds(event.begin_.time_since_epoch())
+         << R"(,"dur":)" << detail::microseconds(event.end_ - event.begin_)
+         << R"(,"args":{"node":"0x)" << std::hex
+         << reinterpret_cast<std::uintptr_t>(event.node_) << std::dec
+         << R"(","type":)";
+    detail::write_json_string(file, event.type_);
+    file << "}}";
+  });
+  file << R"(],"otherData":{"dropped":)" << registry.take_dropped()
+       << "}}\n";
+}
+} // namespace f
+} // namespace artccel::core::compute
@@ -0,0 +1,101 @@
+#include <algorithm> // import std::ranges::sort, std::ranges::unique
+#include <atomic>    // import std::memory_order_seq_cst
+#include <cstddef>   // import std::size_t
+#include <cstdint>   // import std::uint_fast32_t, std::uint_fast64_t
+#include <utility>   // import std::exchange
+#include <vector>    // import std::vector
+
+#include <gsl/gsl> // import gsl::finally
+
+#include <artccel/core/compute/transaction.hpp> // interface
+
+#include <artccel/core/compute/compute.hpp> // import Compute_node, detail::commit_applied, detail::commit_applying, detail::commit_invalidating, detail::commit_sequence, detail::commit_stripe, detail::commit_stripes
+
+namespace artccel::core::compute {
+Compute_transaction::Compute_transaction() noexcept = default;
+Compute_transaction::~Compute_transaction() noexcept = default;
+Compute_transaction::Compute_transaction(Compute_transaction &&) noexcept =
+    default;
+auto Compute_transaction::operator=(Compute_transaction &&) noexcept
+    -> Compute_transaction & = default;
+
+auto Compute_transaction::empty() const noexcept -> bool {
+  return writes_.empty();
+}
+
+void Compute_transaction::commit() {
+  auto writes{std::exchange(writes_, {})};
+  if (writes.empty()) {
+    return;
+  }
+  std::vector<Mutex> mutexes{};
+  std::vector<Compute_node const *> targets{};
+  mutexes.reserve(writes.size());
+  targets.reserve(writes.size());
+  for (auto const &write : writes) {
+    mutexes.emplace_back(write.mutex_);
+    targets.emplace_back(write.target_);
+  }
+  // a global order rules out deadlocks between overlapping transactions
+  std::ranges::sort(mutexes, {}, &Mutex::mutex_);
+  mutexes.erase(std::ranges::unique(mutexes, {}, &Mutex::mutex_).begin(),
+                mutexes.end());
+  std::ranges::sort(targets);
+  targets.erase(std::ranges::unique(targets).begin(), targets.end());
+  std::uint_fast32_t stripes{0};
+  for (auto const *const target : targets) {
+    stripes |= std::uint_fast32_t{1} << detail::commit_stripe(*target);
+  }
+  // adds delta modulo 2^64 to the sequence of every stripe of the targets
+  auto const advance{[stripes](std::uint_fast64_t delta) noexcept {
+    for (auto stripe{std::size_t{0}}; stripe != detail::commit_stripes;
+         ++stripe) {
+      if ((stripes & (std::uint_fast32_t{1} << stripe)) != 0) {
+        auto &sequence{detail::commit_sequence(stripe)};
+        sequence.fetch_add(delta, std::memory_order_seq_cst);
+        sequence.notify_all();
+      }
+    }
+  }};
+  // everything that may throw happens before anything is published
+  for (auto &write : writes) {
+    write.run_(Phase::prepare);
+  }
+  {
+    std::size_t locked{0};
+    auto const guards{gsl::finally([&mutexes, &locked] {
+      while (locked != 0) {
+        auto const &mutex{mutexes[--locked]};
+        mutex.unlock_(mutex.mutex_);
+      }
+    })};
+    for (auto const &mutex : mutexes) {
+      mutex.lock_(mutex.mutex_);
+      ++locked;
+    }
+    // readers of the targets, including lock-free ones, wait out the writes
+    advance(detail::commit_applying);
+    [&writes]() noexcept {
+      for (auto &write : writes) {
+        write.run_(Phase::apply);
+      }
+    }();
+    advance(detail::commit_applied + detail::commit_invalidating -
+            detail::commit_applying);
+  }
+  {
+    // a cached result upstream of a reader is dropped before the reader may
+    // pull it along with a written value; the targets are unlocked first, as
+    // a computation being invalidated may be waiting on one
+    auto const close{gsl::finally([&advance] {
+      advance(std::uint_fast64_t{0} - detail::commit_invalidating);
+    })};
+    for (auto const *const target : targets) {
+      target->invalidate_dependents();
+    }
+  }
+  for (auto &write : writes) {
+    write.run_(Phase::retire);
+  }
+}
+} // namespace artccel::core::compute
@@ -16,10 +16,10 @@
 namespace artccel::core::platform::windows::f {
 using util::literals::encoding::operator""_as_utf8_compat;
 
-void throw_last_error [[noreturn]] () {
-  auto const last_error{::GetLastError()};
-  assert(last_error && u8"No last error");
-  throw std::system_error{util::f::int_modulo_cast<int>(last_error),
+void throw_last_error [[noreturn]] () { throw_error(::GetLastError()); }
+void throw_error [[noreturn]] (unsigned long error) {
+  assert(error && u8"No last error");
+  throw std::system_error{util::f::int_modulo_cast<int>(error),
                           std::system_category()};
 }
 void print_last_error() {
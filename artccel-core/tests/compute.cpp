@@ -0,0 +1,1229 @@
+#include <algorithm> // import std::ranges::count_if
+#include <atomic> // import std::atomic, std::memory_order_acquire, std::memory_order_relaxed, std::memory_order_release
+#include <chrono>   // import std::chrono::steady_clock
+#include <concepts> // import std::same_as
+#include <cstddef> // import std::max_align_t, std::size_t
+#include <cstdint> // import std::uint64_t, std::uint_fast64_t, std::uintptr_t
+#include <filesystem> // import std::filesystem::remove, std::filesystem::temp_directory_path
+#include <fstream>    // import std::ifstream
+#include <functional> // import std::bad_function_call, std::multiplies, std::plus
+#include <ios>      // import std::ios_base::binary
+#include <iterator> // import std::istreambuf_iterator
+#include <memory> // import std::enable_shared_from_this, std::make_shared, std::shared_ptr, std::weak_ptr
+#include <optional>     // import std::nullopt, std::optional
+#include <semaphore>    // import std::binary_semaphore
+#include <shared_mutex> // import std::shared_mutex
+#include <span>         // import std::span
+#include <stdexcept>    // import std::runtime_error
+#include <string>       // import std::string, std::u8string
+#include <string_view>  // import std::u8string_view
+#include <system_error> // import std::error_code
+#include <thread> // import std::jthread, std::this_thread::sleep_for
+#include <type_traits>  // import std::remove_cv_t
+#include <utility>      // import std::forward, std::move
+#include <vector>       // import std::vector
+
+#include <gsl/gsl> // import gsl::finally
+
+#include "harness.hpp" // interface
+
+#include <artccel/core/compute/async.hpp> // import compute::Compute_scheduler
+#include <artccel/core/compute/collection.hpp> // import compute::Compute_collection
+#include <artccel/core/compute/compute.hpp> // import compute::Compute_constant, compute::Compute_function, compute::Compute_function_constant, compute::Compute_io, compute::Compute_node, compute::Compute_option, compute::Compute_out, compute::Compute_value, compute::Lock_inline, compute::Lock_instrumented, compute::Lock_none, compute::Lock_spin, compute::detail::commit_stripe, compute::f::current_stop_token
+#include <artccel/core/compute/evaluator.hpp> // import compute::Compute_evaluator
+#include <artccel/core/compute/expression.hpp> // import compute::Constant_expression, compute::expression_of, compute::f::fold, compute::f::fuse
+#include <artccel/core/compute/graph.hpp> // import compute::Compute_graph
+#include <artccel/core/compute/handle.hpp> // import compute::Compute_handle, compute::Compute_variant_handle
+#include <artccel/core/compute/metrics.hpp> // import compute::f::metrics_json, compute::f::metrics_samples, compute::f::metrics_text, compute::metrics_enabled
+#include <artccel/core/compute/shared_value.hpp> // import compute::Compute_shared_value
+#include <artccel/core/compute/snapshot.hpp> // import compute::Compute_snapshot, compute::Compute_snapshot_c, compute::Compute_snapshot_writer
+#include <artccel/core/compute/trace.hpp> // import compute::f::start_trace, compute::f::stop_trace, compute::f::write_trace
+#include <artccel/core/compute/transaction.hpp> // import compute::Compute_transaction
+#include <artccel/core/util/concurrent.hpp> // import util::Instrumented_lockable, util::Lock_metrics_sample, util::f::lock_metrics_samples, util::lock_metrics_enabled
+#include <artccel/core/util/enum_bitset.hpp> // import util::Enum_bitset, util::operators::enum_bitset
+#include <artccel/core/util/inline_function.hpp> // import util::Inline_function
+#include <artccel/core/util/string_extras.hpp> // import util::f::append_json_string
+
+namespace artccel::core::test {
+using compute::Compute_collection;
+using compute::Compute_constant;
+using compute::Compute_evaluator;
+using compute::Compute_function;
+using compute::Compute_function_constant;
+using compute::Compute_graph;
+using compute::Compute_io;
+using compute::Compute_node;
+using compute::Compute_option;
+using compute::Compute_out;
+using compute::Compute_scheduler;
+using compute::Compute_snapshot;
+using compute::Compute_snapshot_writer;
+using compute::Compute_transaction;
+using compute::Compute_value;
+// NOLINTNEXTLINE(google-build-using-namespace)
+using namespace util::operators::enum_bitset;
+
+namespace detail {
+using Function = Compute_function<int(int)>;
+
+static auto plus_one(int value) noexcept { return value + 1; }
+
+static void clone_tests(Tester &tester) {
+  for (auto const option :
+       {Compute_option::empty, Compute_option::concurrent}) {
+    tester.run(u8"compute/clone/unique", [option] {
+      auto const value{Compute_value<int>::create(1)};
+      auto const function{Function::create(plus_one, value)};
+      auto const clone{function->clone(util::Enum_bitset{} | option)};
+      check((*function)() == 2 && (*clone)() == 2);
+      *value << 10;
+      check((*function)() == 11 && (*clone)() == 11);
+    });
+    tester.run(u8"compute/clone/shared", [option] {
+      auto const value{Compute_value<int>::create(1)};
+      auto const function{Function::create(plus_one, value)};
+      check((*function)() == 2);
+      std::shared_ptr<Function const> const clone{
+          function->clone(util::Enum_bitset{} | option)};
+      *value << 5;
+      check((*clone)() == 6);
+      *value << 10;
+      check((*function)() == 11 && (*clone)() == 11);
+    });
+  }
+  // only a concurrent clone locks
+  tester.run(u8"compute/clone/locking", [] {
+    auto const value{Compute_value<int>::create(1)};
+    auto const function{Function::create(plus_one, value)};
+    auto const sequential{
+        function->clone(util::Enum_bitset{} | Compute_option::empty)};
+    auto const concurrent{
+        function->clone(util::Enum_bitset{} | Compute_option::concurrent)};
+    sequential->metrics_label(u8"compute/clone/locking/sequential");
+    concurrent->metrics_label(u8"compute/clone/locking/concurrent");
+    check((*sequential)() == 2 && (*concurrent)() == 2);
+    if constexpr (compute::metrics_enabled) {
+      auto const shared_locks{[](std::u8string_view label) {
+        for (auto const &sample : compute::f::metrics_samples()) {
+          if (sample.label_ == label) {
+            return sample.shared_locks_;
+          }
+        }
+        throw Check_failure{"no sample"};
+      }};
+      check(shared_locks(u8"compute/clone/locking/sequential") == 0 &&
+            shared_locks(u8"compute/clone/locking/concurrent") != 0);
+    }
+  });
+}
+
+static void async_tests(Tester &tester) {
+  tester.run(u8"compute/async/rebind", [] {
+    Compute_scheduler scheduler{2};
+    std::binary_semaphore entered{0};
+    std::binary_semaphore gate{0};
+    auto const options{util::Enum_bitset{} | Compute_option::concurrent |
+                       Compute_option::defer | Compute_option::async};
+    auto const slow{Function::create(
+        options,
+        [&entered, &gate](int value) {
+          entered.release();
+          gate.acquire();
+          return value;
+        },
+        Compute_value<int>::create(1))};
+    auto const function{Function::create(options, plus_one, slow)};
+    auto const stale{function->async(scheduler)};
+    entered.acquire(); // stale awaits slow
+    function->bind(util::Enum_bitset{} | Compute_option::defer,
+                   Compute_value<int>::create(10));
+    auto const fresh{function->async(scheduler)};
+    auto const ready{wait_until([&fresh] { return fresh.is_ready(); })};
+    gate.release();
+    check(ready && fresh.get() == 11 && stale.get() == 11);
+  });
+}
+
+static void collection_tests(Tester &tester) {
+  tester.run(u8"compute/collection/modify_throw", [] {
+    auto const collection{
+        Compute_collection<int>::create(std::vector<int>{1, 2, 3, 4})};
+    auto const revision{collection->revision()};
+    auto const version{collection->version()};
+    check_throws<std::runtime_error>([&collection] {
+      collection->modify(1, 3, [](std::span<int> values) {
+        values.front() = 20;
+        throw std::runtime_error{"modify"};
+      });
+    });
+    check(collection->revision() != revision &&
+          collection->version() != version);
+  });
+}
+
+// counts its evaluations, failing the check if a dependency was not evaluated
+// exactly once before it
+class Counting_node : public Compute_node,
+                      public std::enable_shared_from_this<Counting_node> {
+private:
+  std::vector<std::shared_ptr<Compute_node const>> dependencies_;
+  bool throws_;
+  mutable std::atomic<std::size_t> evaluations_{0};
+  mutable std::atomic<bool> ordered_{true};
+
+public:
+  explicit Counting_node(
+      std::vector<std::shared_ptr<Compute_node const>> dependencies,
+      bool throws = false)
+      : dependencies_{std::move(dependencies)}, throws_{throws} {}
+
+  auto evaluations [[nodiscard]] () const noexcept {
+    return evaluations_.load(std::memory_order_relaxed);
+  }
+  auto ordered [[nodiscard]] () const noexcept {
+    return ordered_.load(std::memory_order_relaxed);
+  }
+  auto dependencies [[nodiscard]] () const
+      -> std::vector<std::shared_ptr<Compute_node const>> override {
+    return dependencies_;
+  }
+  void evaluate() const override {
+    for (auto const &dependency : dependencies_) {
+      if (static_cast<Counting_node const &>(*dependency).evaluations() != 1) {
+        ordered_.store(false, std::memory_order_relaxed);
+      }
+    }
+    evaluations_.fetch_add(1, std::memory_order_relaxed);
+    if (throws_) {
+      throw std::runtime_error{"evaluate"};
+    }
+  }
+
+private:
+  auto weak_from_node [[nodiscard]] () const noexcept
+      -> std::weak_ptr<Compute_node const> override {
+    return weak_from_this();
+  }
+};
+// allocated through Compute_node::operator new, unlike make_shared
+class alignas(2 * alignof(std::max_align_t)) Aligned_node
+    : public Counting_node {
+public:
+  using Counting_node::Counting_node;
+
+  static auto create [[nodiscard]] () {
+    return std::shared_ptr<Aligned_node>{new Aligned_node{{}}};
+  }
+};
+
+static void evaluator_tests(Tester &tester) {
+  tester.run(u8"compute/evaluator/diamond", [] {
+    constexpr std::size_t width{64};
+    for (std::size_t const concurrency : {0, 4}) {
+      Compute_evaluator evaluator{concurrency};
+      auto const root{std::make_shared<Counting_node>(
+          std::vector<std::shared_ptr<Compute_node const>>{})};
+      std::vector<std::shared_ptr<Counting_node const>> nodes{root};
+      std::vector<std::shared_ptr<Compute_node const>> fan{};
+      for (std::size_t index{0}; index != width; ++index) {
+        auto node{std::make_shared<Counting_node>(
+            std::vector<std::shared_ptr<Compute_node const>>{root})};
+        nodes.emplace_back(node);
+        fan.emplace_back(std::move(node));
+      }
+      auto const join{std::make_shared<Counting_node>(std::move(fan))};
+      nodes.emplace_back(join);
+      // reached twice, directly and through the join
+      std::vector<std::shared_ptr<Compute_node const>> const targets{
+          join, nodes.at(1)};
+      evaluator.evaluate(targets);
+      for (auto const &node : nodes) {
+        check(node->evaluations() == 1 && node->ordered());
+      }
+    }
+  });
+  tester.run(u8"compute/evaluator/throw", [] {
+    for (std::size_t const concurrency : {0, 4}) {
+      Compute_evaluator evaluator{concurrency};
+      auto const throwing{std::make_shared<Counting_node>(
+          std::vector<std::shared_ptr<Compute_node const>>{}, true)};
+      auto const other{std::make_shared<Counting_node>(
+          std::vector<std::shared_ptr<Compute_node const>>{})};
+      auto const join{std::make_shared<Counting_node>(
+          std::vector<std::shared_ptr<Compute_node const>>{throwing, other})};
+      std::vector<std::shared_ptr<Compute_node const>> const targets{join};
+      check_throws<std::runtime_error>(
+          [&evaluator, &targets] { evaluator.evaluate(targets); });
+      // the run completes, dependents included
+      check(throwing->evaluations() == 1 && other->evaluations() == 1 &&
+            join->evaluations() == 1);
+    }
+  });
+}
+
+constexpr static auto scale() noexcept { return 3; }
+static auto seed() noexcept { return 5; }
+// (2 + scale()) * scale(), composed without nodes
+constexpr auto fused{compute::f::fuse(
+    std::multiplies<>{},
+    compute::f::fuse(std::plus<>{},
+                     compute::expression_of<Compute_constant<int, 2>>,
+                     compute::expression_of<
+                         Compute_function_constant<int, scale>>),
+    compute::expression_of<Compute_function_constant<int, scale>>)};
+// seed() is not constexpr, so neither is this
+constexpr auto unfoldable{compute::f::fuse(
+    std::plus<>{}, compute::expression_of<Compute_constant<int, 2>>,
+    compute::expression_of<Compute_function_constant<int, seed>>)};
+
+static void expression_tests(Tester &tester) {
+  static_assert(std::same_as<decltype(compute::f::fold<fused>()),
+                             compute::Constant_expression<int, 15>>);
+  static_assert(
+      std::same_as<decltype(compute::f::fold<unfoldable>()),
+                   std::remove_cv_t<decltype(unfoldable)>>);
+  tester.run(u8"compute/expression/fused", [] {
+    check(fused() == 15 && unfoldable() == 7);
+    auto const node{Compute_function_constant<int, fused>::create()};
+    auto const folded{
+        Compute_function_constant<int, compute::f::fold<fused>()>::create()};
+    auto const unfolded{Compute_function_constant<int, unfoldable>::create()};
+    check((*node)() == 15 && (*folded)() == 15 && (*unfolded)() == 7);
+  });
+}
+
+// Compute_function with the callable and the bound arguments stored inline
+using Inline_compute_function = Compute_function<int(int), 128>;
+// exposes the protected swap
+class Swappable_function : public Inline_compute_function {
+public:
+  template <typename... Args>
+  explicit Swappable_function(Args &&...args)
+      : Inline_compute_function(std::forward<Args>(args)...) {}
+
+  using Inline_compute_function::swap;
+};
+
+static auto times_two(int value) noexcept { return value * 2; }
+
+// copies block on the gate while one is set, counting themselves in on entered
+class Blocking_copy {
+private:
+  int value_;
+
+public:
+  inline static std::atomic<std::binary_semaphore *> entered_{nullptr};
+  inline static std::atomic<std::binary_semaphore *> gate_{nullptr};
+
+  explicit Blocking_copy(int value) noexcept : value_{value} {}
+  auto value [[nodiscard]] () const noexcept { return value_; }
+
+  ~Blocking_copy() noexcept = default;
+  Blocking_copy(Blocking_copy const &other) : value_{other.value_} {
+    if (auto *const gate{gate_.load(std::memory_order_acquire)}) {
+      entered_.load(std::memory_order_acquire)->release();
+      gate->acquire();
+    }
+  }
+  auto operator=(Blocking_copy const &) -> Blocking_copy & = default;
+  Blocking_copy(Blocking_copy &&) noexcept = default;
+  auto operator=(Blocking_copy &&) noexcept -> Blocking_copy & = default;
+};
+
+static void function_tests(Tester &tester) {
+  tester.run(u8"compute/function/single_flight", [] {
+    auto const value{Compute_value<int>::create(1)};
+    std::atomic<int> calls{0};
+    std::binary_semaphore entered{0};
+    std::binary_semaphore gate{0};
+    auto const function{Function::create(
+        [&calls, &entered, &gate](int arg) {
+          calls.fetch_add(1, std::memory_order_relaxed);
+          entered.release();
+          gate.acquire();
+          return arg + 1;
+        },
+        value)};
+    std::atomic<int> sum{0};
+    {
+      std::vector<std::jthread> callers{};
+      for (auto thread{0}; thread != 4; ++thread) {
+        callers.emplace_back([&function, &sum] {
+          sum.fetch_add((*function)(), std::memory_order_relaxed);
+        });
+      }
+      entered.acquire();
+      // the others park on the running computation
+      std::this_thread::sleep_for(park_time);
+      gate.release();
+    }
+    check(calls.load(std::memory_order_relaxed) == 1 &&
+          sum.load(std::memory_order_relaxed) == 8);
+  });
+  tester.run(u8"compute/function/cancel", [] {
+    auto const value{Compute_value<int>::create(1)};
+    std::atomic<int> calls{0};
+    std::atomic<bool> stopped{false};
+    std::binary_semaphore entered{0};
+    auto const function{Function::create(
+        [&calls, &stopped, &entered](int arg) {
+          if (calls.fetch_add(1, std::memory_order_relaxed) != 0) {
+            return arg + 1;
+          }
+          entered.release();
+          stopped.store(wait_until([] {
+                          return compute::f::current_stop_token()
+                              .stop_requested();
+                        }),
+                        std::memory_order_relaxed);
+          return -1; // discarded
+        },
+        value)};
+    std::atomic<int> result{0};
+    std::jthread caller{[&function, &result] {
+      result.store((*function)(), std::memory_order_relaxed);
+    }};
+    entered.acquire();
+    check(function->bind(util::Enum_bitset{} | Compute_option::defer,
+                         Compute_value<int>::create(10)) == std::nullopt);
+    caller.join();
+    check(stopped.load(std::memory_order_relaxed) &&
+          result.load(std::memory_order_relaxed) == 11 &&
+          (*function)() == 11 && calls.load(std::memory_order_relaxed) == 2);
+    check(!compute::f::current_stop_token().stop_possible());
+  });
+  tester.run(u8"compute/function/deadline", [] {
+    auto const value{Compute_value<int>::create(1)};
+    std::binary_semaphore entered{0};
+    std::binary_semaphore gate{0};
+    auto const function{Function::create(
+        [&entered, &gate](int arg) {
+          entered.release();
+          gate.acquire();
+          return arg + 1;
+        },
+        value)};
+    std::atomic<int> result{0};
+    std::jthread caller{[&function, &result] {
+      result.store((*function)(), std::memory_order_relaxed);
+    }};
+    entered.acquire();
+    auto const start{std::chrono::steady_clock::now()};
+    auto const ret{(*function)(start + park_time)};
+    auto const elapsed{std::chrono::steady_clock::now() - start};
+    gate.release();
+    caller.join();
+    check(!ret && elapsed >= park_time && elapsed < 20 * park_time &&
+          result.load(std::memory_order_relaxed) == 2);
+    check((*function)(std::chrono::steady_clock::now()) == 2);
+  });
+  // a reader copying the result out holds up neither a reset nor the next
+  // computation
+  tester.run(u8"compute/function/reset_reader", [] {
+    auto const value{Compute_value<int>::create(1)};
+    std::atomic<int> calls{0};
+    auto const function{Compute_function<Blocking_copy(int)>::create(
+        [&calls](int arg) {
+          calls.fetch_add(1, std::memory_order_relaxed);
+          return Blocking_copy{arg};
+        },
+        value)};
+    check((*function)().value() == 1);
+    std::binary_semaphore entered{0};
+    std::binary_semaphore gate{0};
+    Blocking_copy::entered_.store(&entered, std::memory_order_release);
+    Blocking_copy::gate_.store(&gate, std::memory_order_release);
+    std::atomic<int> read{0};
+    std::jthread reader{[&function, &read] {
+      read.store((*function)().value(), std::memory_order_relaxed);
+    }};
+    entered.acquire();
+    Blocking_copy::gate_.store(nullptr, std::memory_order_release);
+    check(function->reset(util::Enum_bitset{} | Compute_option::defer) ==
+          std::nullopt);
+    *value << 2;
+    check(function->reset(util::Enum_bitset{} | Compute_option::empty)
+              ->value() == 2 &&
+          (*function)().value() == 2);
+    gate.release();
+    reader.join();
+    check(read.load(std::memory_order_relaxed) == 1 &&
+          calls.load(std::memory_order_relaxed) == 2);
+  });
+  // a write racing another one still invalidates every dependent before it
+  // returns
+  tester.run(u8"compute/function/concurrent_writes", [] {
+    auto const value{Compute_value<int>::create(1)};
+    std::binary_semaphore entered{0};
+    std::binary_semaphore gate{0};
+    std::atomic<bool> blocking{true};
+    auto const blocked{Function::create(
+        [&blocking, &entered, &gate](int arg) {
+          if (blocking.exchange(false, std::memory_order_relaxed)) {
+            entered.release();
+            gate.acquire();
+          }
+          return arg + 1;
+        },
+        value)};
+    auto const function{Function::create(plus_one, value)};
+    check((*function)() == 2);
+    std::jthread reader{[&blocked] { static_cast<void>((*blocked)()); }};
+    entered.acquire();
+    // invalidates blocked first, then waits for its computation
+    std::jthread first{[&value] { *value << 5; }};
+    std::this_thread::sleep_for(park_time);
+    std::atomic<int> read{0};
+    std::jthread second{[&value, &function, &read] {
+      *value << 6;
+      read.store((*function)(), std::memory_order_relaxed);
+    }};
+    std::this_thread::sleep_for(park_time);
+    gate.release();
+    second.join();
+    check(read.load(std::memory_order_relaxed) == 7);
+  });
+
+  tester.run(u8"compute/function/inline_bind", [] {
+    auto const value{Compute_value<int>::create(1)};
+    auto const other{Compute_value<int>::create(10)};
+    auto const function{Inline_compute_function::create(plus_one, value)};
+    check((*function)() == 2);
+    check(function->bind(util::Enum_bitset{} | Compute_option::empty,
+                         other) == 11);
+    *value << 2;
+    *other << 20;
+    check((*function)() == 21);
+  });
+  tester.run(u8"compute/function/inline_reset", [] {
+    auto const value{Compute_value<int>::create(1)};
+    std::atomic<int> calls{0};
+    auto const function{Inline_compute_function::create(
+        [&calls](int arg) {
+          calls.fetch_add(1, std::memory_order_relaxed);
+          return arg;
+        },
+        value)};
+    check((*function)() == 1 && (*function)() == 1);
+    check(function->reset(util::Enum_bitset{} | Compute_option::defer) ==
+          std::nullopt);
+    check((*function)() == 1 && calls.load(std::memory_order_relaxed) == 2);
+  });
+  tester.run(u8"compute/function/inline_copy", [] {
+    auto const value{Compute_value<int>::create(1)};
+    auto const function{Inline_compute_function::create(plus_one, value)};
+    check((*function)() == 2);
+    auto const copy{
+        function->clone(util::Enum_bitset{} | Compute_option::concurrent)};
+    check((*copy)() == 2);
+    *value << 5;
+    check((*function)() == 6 && (*copy)() == 6);
+  });
+  tester.run(u8"compute/function/inline_swap", [] {
+    auto const value{Compute_value<int>::create(1)};
+    auto const other{Compute_value<int>::create(10)};
+    auto const left{std::make_shared<Swappable_function>(plus_one, value)};
+    auto const right{std::make_shared<Swappable_function>(times_two, other)};
+    check((*left)() == 2 && (*right)() == 20);
+    left->swap(*right);
+    check((*left)() == 20 && (*right)() == 2);
+    *value << 2;
+    *other << 20;
+    check((*left)() == 40 && (*right)() == 3);
+  });
+}
+
+static void graph_tests(Tester &tester) {
+  // fails the live allocation assertion of the graph, or reads freed memory
+  tester.run(u8"compute/graph/outside_dependency", [] {
+    auto const value{Compute_value<int>::create(1)};
+    auto const other{Compute_value<int>::create(10)};
+    {
+      Compute_graph graph{};
+      auto const function{graph.create<Function>(plus_one, value)};
+      auto const rebound{graph.create<Function>(plus_one, value)};
+      check((*function)() == 2 && (*rebound)() == 2);
+      *value << 2;
+      check((*function)() == 3);
+      rebound->bind(util::Enum_bitset{} | Compute_option::empty, other);
+      check((*rebound)() == 11);
+    }
+    *value << 3;
+    *other << 20;
+    check((*value)() == 3 && (*other)() == 20);
+  });
+  tester.run(u8"compute/graph/over_aligned", [] {
+    auto const aligned{[](auto const &node) {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      return reinterpret_cast<std::uintptr_t>(node.get()) %
+                 alignof(Aligned_node) ==
+             0U;
+    }};
+    auto const node{Aligned_node::create()};
+    check(aligned(node));
+    Compute_graph graph{};
+    auto const graph_node{graph.create<Aligned_node>()};
+    check(aligned(graph_node));
+  });
+}
+
+static void handle_tests(Tester &tester) {
+  tester.run(u8"compute/handle/same", [] {
+    auto const value{Compute_value<int>::create(1)};
+    auto const function{Function::create(plus_one, value)};
+    auto const constant{Compute_constant<int, 7>::create()};
+    std::vector<std::shared_ptr<Compute_io<int> const>> const nodes{
+        value, function, constant};
+    compute::Compute_handle const value_handle{*value};
+    compute::Compute_handle const function_handle{*function};
+    compute::Compute_handle const constant_handle{*constant};
+    std::vector<compute::Compute_variant_handle<
+        Compute_value<int>, Function, Compute_constant<int, 7>>> const
+        variants{value_handle, function_handle, constant_handle};
+    for (auto const written : {1, 4}) {
+      *value << written;
+      check(value_handle() == (*nodes[0])() &&
+            function_handle() == (*nodes[1])() &&
+            constant_handle() == (*nodes[2])());
+      for (std::size_t index{0}; index != nodes.size(); ++index) {
+        check(variants[index].index() == index &&
+              variants[index]() == (*nodes[index])());
+      }
+    }
+    check(function_handle() == 5 && &function_handle.node() == function.get());
+  });
+}
+
+static void inline_function_tests(Tester &tester) {
+  using Function_type = util::Inline_function<int(int), 32>;
+  tester.run(u8"compute/inline_function/copy", [] {
+    auto const offset{std::make_shared<int>(1)};
+    Function_type const function{
+        [offset](int value) { return value + *offset; }};
+    Function_type copy{function};
+    check(function(1) == 2 && copy(1) == 2 && offset.use_count() == 3);
+    Function_type assigned{times_two};
+    assigned = copy;
+    check(assigned(2) == 3 && offset.use_count() == 4);
+  });
+  tester.run(u8"compute/inline_function/move", [] {
+    Function_type function{plus_one};
+    Function_type moved{std::move(function)};
+    check(static_cast<bool>(moved) && moved(1) == 2);
+    Function_type assigned{};
+    assigned = std::move(moved);
+    check(static_cast<bool>(assigned) && assigned(2) == 3);
+    Function_type other{times_two};
+    swap(assigned, other);
+    check(assigned(2) == 4 && other(2) == 3);
+  });
+  tester.run(u8"compute/inline_function/empty", [] {
+    Function_type const empty{};
+    check(!empty);
+    check_throws<std::bad_function_call>(
+        [&empty] { static_cast<void>(empty(1)); });
+    Function_type const copy{empty};
+    check(!copy);
+  });
+}
+
+// reads a chain of nodes locked by Lock, while another thread writes to it
+// unless Lock never locks
+template <typename Lock> static void check_lock() {
+  auto const options{util::Enum_bitset{} | Compute_option::concurrent};
+  auto const value{Compute_value<int, Lock>::create(options, 1)};
+  auto const function{
+      Compute_function<int(int), 0, Lock>::create(options, plus_one, value)};
+  check((*function)() == 2);
+  *value << 2;
+  check((*function)() == 3);
+  if constexpr (!std::same_as<Lock, compute::Lock_none>) {
+    constexpr auto last{1000};
+    std::atomic<bool> ordered{true};
+    {
+      std::jthread const reader{[&function, &ordered] {
+        for (auto previous{0}; previous != last + 1;) {
+          auto const read{(*function)()};
+          if (read < previous) {
+            ordered.store(false, std::memory_order_relaxed);
+          }
+          previous = read;
+        }
+      }};
+      for (auto write{3}; write <= last; ++write) {
+        *value << write;
+      }
+    }
+    check(ordered.load(std::memory_order_relaxed) && (*function)() == last + 1);
+  }
+}
+
+static void lock_tests(Tester &tester) {
+  tester.run(u8"compute/lock/none", [] { check_lock<compute::Lock_none>(); });
+  tester.run(u8"compute/lock/inline",
+             [] { check_lock<compute::Lock_inline>(); });
+  tester.run(u8"compute/lock/spin", [] { check_lock<compute::Lock_spin>(); });
+  tester.run(u8"compute/lock/instrumented", [] {
+    check_lock<compute::Lock_instrumented<>>();
+    check_lock<compute::Lock_instrumented<compute::Lock_inline>>();
+    auto const live_locks{[] {
+      return std::ranges::count_if(
+          util::f::lock_metrics_samples(),
+          [](util::Lock_metrics_sample const &sample) { return sample.live_; });
+    }};
+    auto const before{live_locks()};
+    auto const value{Compute_value<
+        int, compute::Lock_instrumented<compute::Lock_inline>>::create(1)};
+    check((*value)() == 1 &&
+          live_locks() == before + (util::lock_metrics_enabled ? 1 : 0));
+  });
+  tester.run(u8"compute/lock/transaction", [] {
+    auto const options{util::Enum_bitset{} | Compute_option::concurrent};
+    auto const none{Compute_value<int, compute::Lock_none>::create(0)};
+    auto const inlined{
+        Compute_value<int, compute::Lock_inline>::create(options, 0)};
+    auto const spin{Compute_value<int, compute::Lock_spin>::create(options, 0)};
+    auto const instrumented{
+        Compute_value<int, compute::Lock_instrumented<>>::create(options, 0)};
+    // -1 unless every value comes from the same commit
+    auto const same{Compute_function<int(int, int, int), 0,
+                                     compute::Lock_spin>::create(
+        options,
+        [](int first, int second, int third) {
+          return first == second && second == third ? first : -1;
+        },
+        inlined, spin, instrumented)};
+    {
+      Compute_transaction transaction{};
+      transaction.stage(*none, 1);
+      transaction.stage(*inlined, 1);
+      transaction.stage(*spin, 1);
+      transaction.stage(*instrumented, 1);
+      transaction.commit();
+    }
+    check((*none)() == 1 && (*same)() == 1);
+    constexpr auto last{200};
+    std::atomic<bool> consistent{true};
+    {
+      std::jthread const reader{[&same, &consistent] {
+        for (auto read{0}; read != last;) {
+          read = (*same)();
+          if (read == -1) {
+            consistent.store(false, std::memory_order_relaxed);
+            return;
+          }
+        }
+      }};
+      for (auto commit{2}; commit <= last; ++commit) {
+        Compute_transaction transaction{};
+        transaction.stage(*inlined, commit);
+        transaction.stage(*spin, commit);
+        transaction.stage(*instrumented, commit);
+        transaction.commit();
+      }
+    }
+    check(consistent.load(std::memory_order_relaxed) && (*same)() == last);
+  });
+}
+
+// a lock type of its own, so that its samples are told apart
+class Probe_mutex : public std::shared_mutex {};
+
+static void metrics_tests(Tester &tester) {
+  tester.run(u8"compute/metrics/json", [] {
+    auto const value{Compute_value<int>::create(1)};
+    value->metrics_label(u8"compute/metrics/json\t\"\x01");
+    check((*value)() == 1);
+    auto const json{compute::f::metrics_json()};
+    if constexpr (compute::metrics_enabled) {
+      check(json.starts_with(u8"{\"enabled\":true,\"nodes\":[{"));
+      constexpr std::u8string_view escaped{
+          u8"\"label\":\"compute/metrics/json\\u0009\\\"\\u0001\""};
+      check(json.find(escaped) != std::u8string::npos);
+      check(compute::f::metrics_text().find(
+                u8"(compute/metrics/json\t\"\x01)") != std::u8string::npos);
+    } else {
+      check(json == u8"{\"enabled\":false,\"nodes\":[],\"locks\":[]}\n");
+      check(compute::f::metrics_text() == u8"compute metrics: disabled\n");
+    }
+  });
+  tester.run(u8"compute/metrics/reads", [] {
+    auto const shared{compute::Compute_shared_value<int>::create(1)};
+    auto const collection{Compute_collection<int>::create(std::vector{1, 2})};
+    shared->metrics_label(u8"compute/metrics/reads/shared");
+    collection->metrics_label(u8"compute/metrics/reads/collection");
+    check(*(*shared)() == 1 && (*collection)().size() == 2 &&
+          collection->read([](auto values) { return values[1]; }) == 2);
+    static_cast<void>(collection->read_changes(
+        collection->revision(), [](auto /*values*/, auto const & /*changes*/) {
+        }));
+    if constexpr (compute::metrics_enabled) {
+      auto const find{[](std::u8string_view label) {
+        for (auto const &sample : compute::f::metrics_samples()) {
+          if (sample.label_ == label) {
+            return sample;
+          }
+        }
+        throw Check_failure{"no sample"};
+      }};
+      auto const shared_sample{find(u8"compute/metrics/reads/shared")};
+      auto const collection_sample{find(u8"compute/metrics/reads/collection")};
+      check(shared_sample.evaluations_ == 1 &&
+            shared_sample.shared_locks_ == 1);
+      check(collection_sample.evaluations_ == 3 &&
+            collection_sample.shared_locks_ == 4);
+    }
+  });
+  tester.run(u8"compute/metrics/lock", [] {
+    auto const find{[](bool live) -> std::optional<util::Lock_metrics_sample> {
+      for (auto &sample : util::f::lock_metrics_samples()) {
+        if (sample.live_ == live &&
+            sample.type_.find(u8"Probe_mutex") != std::u8string::npos) {
+          return std::move(sample);
+        }
+      }
+      return std::nullopt;
+    }};
+    auto const before{find(false).value_or(util::Lock_metrics_sample{})};
+    {
+      util::Instrumented_lockable<Probe_mutex> lock{};
+      lock.lock();
+      lock.unlock();
+      check(lock.try_lock());
+      lock.unlock();
+      lock.lock_shared();
+      lock.unlock_shared();
+      if constexpr (util::lock_metrics_enabled) {
+        auto const live{find(true)};
+        check(live && live->id_ != 0 && live->acquisitions_ == 2 &&
+              live->shared_acquisitions_ == 1 && live->contended_ == 0);
+        auto const json{compute::f::metrics_json()};
+        auto const text{compute::f::metrics_text()};
+        auto const type{
+            json.find(u8"\"type\":\"" + live->type_ + u8"\",\"live\":true")};
+        check(type != std::u8string::npos &&
+              type > json.find(u8"\"locks\":[") &&
+              json.find(u8"\"acquisitions\":2", type) != std::u8string::npos);
+        check(text.find(u8"|- lock ") != std::u8string::npos);
+      }
+    }
+    if constexpr (util::lock_metrics_enabled) {
+      auto const total{find(false)};
+      check(!find(true) && total && total->id_ == 0 &&
+            total->acquisitions_ == before.acquisitions_ + 2 &&
+            total->shared_acquisitions_ == before.shared_acquisitions_ + 1);
+      check(compute::f::metrics_text().find(u8"|- destroyed lock: ") !=
+            std::u8string::npos);
+    } else {
+      check(util::f::lock_metrics_samples().empty());
+    }
+  });
+}
+
+static void out_tests(Tester &tester) {
+  tester.run(u8"compute/out/stale", [] {
+    auto const value{Compute_value<int>::create(1)};
+    Compute_out out{*value};
+    check(!out.stale() && out() == 1);
+    *value << 2;
+    check(out.stale() && out() == 1);
+    check(out.update() && out() == 2 && !out.stale());
+  });
+  tester.run(u8"compute/out/update", [] {
+    auto const value{Compute_value<int>::create(1)};
+    value->metrics_label(u8"compute/out/update");
+    Compute_out out{*value};
+    auto const evaluations{[] {
+      for (auto const &sample : compute::f::metrics_samples()) {
+        if (sample.label_ == u8"compute/out/update") {
+          return sample.evaluations_;
+        }
+      }
+      return std::uint_fast64_t{0};
+    }};
+    auto const before{evaluations()};
+    check(!out.update() && evaluations() == before);
+    *value << 2;
+    check(out.update() && out() == 2);
+    check(!compute::metrics_enabled || evaluations() == before + 1);
+  });
+  tester.run(u8"compute/out/wait", [] {
+    auto const value{Compute_value<int>::create(1)};
+    Compute_out out{*value};
+    std::atomic<bool> woken{false};
+    std::jthread const waiter{[&out, &woken] {
+      out.wait();
+      woken.store(true, std::memory_order_release);
+    }};
+    std::this_thread::sleep_for(park_time);
+    check(!woken.load(std::memory_order_acquire));
+    *value << 2;
+    check(wait_until(
+        [&woken] { return woken.load(std::memory_order_acquire); }));
+  });
+  tester.run(u8"compute/out/expired", [] {
+    auto value{Compute_value<int>::create(1)};
+    Compute_out out{*value};
+    std::atomic<bool> woken{false};
+    std::jthread const waiter{[&out, &woken] {
+      out.wait();
+      woken.store(true, std::memory_order_release);
+    }};
+    std::this_thread::sleep_for(park_time);
+    value.reset();
+    check(wait_until(
+        [&woken] { return woken.load(std::memory_order_acquire); }));
+    check(out.stale() && out.update() && out() == 1);
+    out.wait();
+  });
+}
+
+static void shared_value_tests(Tester &tester) {
+  using Shared_value = compute::Compute_shared_value<int>;
+  tester.run(u8"compute/shared_value/snapshot", [] {
+    auto const value{Shared_value::create(1)};
+    auto const first{(*value)()};
+    check((*value)() == first && *first == 1);
+    auto const previous{*value << 2};
+    auto const second{(*value)()};
+    check(previous == first && second != first && *first == 1 &&
+          *second == 2 && (*value)() == second);
+  });
+  tester.run(u8"compute/shared_value/const", [] {
+    auto const value{Shared_value::create_const(1)};
+    static_assert(
+        std::same_as<decltype(value)::element_type, Shared_value const>);
+    value->metrics_label(u8"compute/shared_value/const");
+    check(*(*value)() == 1 && (*value)() == (*value)());
+    if constexpr (compute::metrics_enabled) {
+      check(std::ranges::count_if(
+                compute::f::metrics_samples(), [](auto const &sample) {
+                  return sample.label_ == u8"compute/shared_value/const" &&
+                         sample.shared_locks_ == 0;
+                }) == 1);
+    }
+  });
+  tester.run(u8"compute/shared_value/update_retry", [] {
+    auto const value{Shared_value::create(1)};
+    std::atomic<int> calls{0};
+    std::binary_semaphore entered{0};
+    std::binary_semaphore gate{0};
+    std::jthread updater{[&value, &calls, &entered, &gate] {
+      static_cast<void>(value->update([&calls, &entered, &gate](int current) {
+        if (calls.fetch_add(1, std::memory_order_relaxed) == 0) {
+          entered.release();
+          gate.acquire();
+        }
+        return current + 1;
+      }));
+    }};
+    entered.acquire();
+    // published while the update computes from the previous snapshot
+    static_cast<void>(*value << 10);
+    gate.release();
+    updater.join();
+    check(calls.load(std::memory_order_relaxed) == 2 && *(*value)() == 11);
+  });
+  tester.run(u8"compute/shared_value/update_contended", [] {
+    constexpr static auto threads{4};
+    constexpr static auto updates{1000};
+    auto const value{Shared_value::create(0)};
+    {
+      std::vector<std::jthread> updaters{};
+      for (auto thread{0}; thread != threads; ++thread) {
+        updaters.emplace_back([&value] {
+          for (auto update{0}; update != updates; ++update) {
+            static_cast<void>(
+                value->update([](int current) { return current + 1; }));
+          }
+        });
+      }
+    }
+    check(*(*value)() == threads * updates);
+  });
+  tester.run(u8"compute/shared_value/invalidate", [] {
+    auto const value{Shared_value::create(1)};
+    auto const doubled{
+        Compute_function<int(std::shared_ptr<int const>)>::create(
+            [](std::shared_ptr<int const> const &current) {
+              return *current * 2;
+            },
+            value)};
+    check((*doubled)() == 2);
+    static_cast<void>(*value << 3);
+    check((*doubled)() == 6);
+    static_cast<void>(value->update([](int current) { return current + 1; }));
+    check((*doubled)() == 8);
+  });
+}
+
+static void snapshot_tests(Tester &tester) {
+  static_assert(!compute::Compute_snapshot_c<int *>);
+  static_assert(!compute::Compute_snapshot_c<int *[2]>);
+  static_assert(!compute::Compute_snapshot_c<std::vector<int const *>>);
+  tester.run(u8"compute/snapshot/round_trip", [] {
+    constexpr std::uint64_t schema{1};
+    auto const path{std::filesystem::temp_directory_path() /
+                    u8"artccel-core-tests.snapshot"};
+    auto const remove{gsl::finally([&path] {
+      std::error_code error{};
+      std::filesystem::remove(path, error);
+    })};
+    auto calls{0};
+    auto const twice{[&calls](int value) {
+      ++calls;
+      return value * 2;
+    }};
+    {
+      auto const value{Compute_value<int>::create(21)};
+      auto const function{Function::create(twice, value)};
+      check((*function)() == 42);
+      Compute_snapshot_writer writer{schema};
+      writer.save(u8"value", *value);
+      check(writer.save(u8"function", *function));
+      writer.write(path);
+    }
+    auto const value{Compute_value<int>::create(0)};
+    auto const function{Function::create(
+        util::Enum_bitset{} | Compute_option::defer, twice, value)};
+    Compute_snapshot const snapshot{path, schema};
+    check(snapshot.size() == 2);
+    check(snapshot.restore(u8"value", *value) &&
+          snapshot.restore(u8"function", *function));
+    check(!snapshot.restore(u8"missing", *value));
+    calls = 0;
+    check((*value)() == 21 && (*function)() == 42 && calls == 0);
+    *value << 5;
+    check((*function)() == 10 && calls == 1);
+    check(Compute_snapshot{path, schema + 1}.size() == 0);
+  });
+}
+
+// copying throws if throws_ is set, moving never does
+struct Fragile {
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  int value_{0};
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  bool throws_{false};
+
+  explicit Fragile(int value, bool throws = false) noexcept
+      : value_{value}, throws_{throws} {}
+  ~Fragile() noexcept = default;
+  Fragile(Fragile const &other) : value_{other.value_}, throws_{other.throws_} {
+    if (throws_) {
+      throw std::runtime_error{"copy"};
+    }
+  }
+  auto operator=(Fragile const &right) -> Fragile & {
+    Fragile copy{right};
+    return *this = std::move(copy);
+  }
+  Fragile(Fragile &&) noexcept = default;
+  auto operator=(Fragile &&) noexcept -> Fragile & = default;
+};
+
+static void trace_tests(Tester &tester) {
+  tester.run(u8"compute/trace/escape", [] {
+    std::u8string out{u8"x"};
+    util::f::append_json_string(out, u8"a\"b\\c\n\x1f");
+    check(out == u8"x\"a\\\"b\\\\c\\u000a\\u001f\"");
+  });
+  tester.run(u8"compute/trace/write", [] {
+    auto const path{std::filesystem::temp_directory_path() /
+                    u8"artccel-core-tests.trace.json"};
+    auto const remove{gsl::finally([&path] {
+      std::error_code error{};
+      std::filesystem::remove(path, error);
+    })};
+    auto const value{Compute_value<int>::create(1)};
+    auto const function{Function::create(plus_one, value)};
+    compute::f::start_trace();
+    {
+      auto const stop{gsl::finally([] { compute::f::stop_trace(); })};
+      *value << 2;
+      check((*function)() == 3);
+    }
+    compute::f::write_trace(path);
+    std::ifstream file{path, std::ios_base::binary};
+    std::string const trace{std::istreambuf_iterator<char>{file},
+                            std::istreambuf_iterator<char>{}};
+    check(trace.starts_with(R"({"displayTimeUnit":"ns","traceEvents":[)"));
+    check(trace.find(R"("ph":"X","cat":"compute")") != std::string::npos &&
+          trace.find(R"("name":"compute")") != std::string::npos);
+    check(trace.ends_with("],\"otherData\":{\"dropped\":0}}\n"));
+    // the buffers were moved out, so nothing is written twice
+    compute::f::write_trace(path);
+    std::ifstream again{path, std::ios_base::binary};
+    std::string const empty{std::istreambuf_iterator<char>{again},
+                            std::istreambuf_iterator<char>{}};
+    check(empty.find(R"("ph":"X")") == std::string::npos);
+  });
+}
+
+static void transaction_tests(Tester &tester) {
+  tester.run(u8"compute/transaction/commit", [] {
+    auto const left{Compute_value<int>::create(
+        util::Enum_bitset{} | Compute_option::snapshot, 1)};
+    auto const right{Compute_value<int>::create(2)};
+    auto const function{Function::create(plus_one, left)};
+    check((*function)() == 2);
+    Compute_transaction transaction{};
+    transaction.stage(*left, 10);
+    transaction.stage(*right, 20);
+    transaction.stage(*left, 30);
+    transaction.commit();
+    check(transaction.empty());
+    check((*left)() == 30 && (*right)() == 20 && (*function)() == 31);
+  });
+  tester.run(u8"compute/transaction/throw", [] {
+    auto const left{Compute_value<int>::create(
+        util::Enum_bitset{} | Compute_option::snapshot, 1)};
+    auto const right{Compute_value<Fragile>::create(
+        util::Enum_bitset{} | Compute_option::snapshot, Fragile{2})};
+    auto const function{Function::create(plus_one, left)};
+    check((*function)() == 2);
+    Compute_transaction transaction{};
+    transaction.stage(*left, 10);
+    transaction.stage(*right, Fragile{20, true});
+    check_throws<std::runtime_error>([&transaction] { transaction.commit(); });
+    check((*left)() == 1 && (*right)().value_ == 2 && (*function)() == 2);
+    // readers and later commits are not left waiting on the failed one
+    transaction.stage(*left, 30);
+    transaction.commit();
+    check((*left)() == 30 && (*function)() == 31);
+  });
+  tester.run(u8"compute/transaction/intermediate", [] {
+    auto const left{Compute_value<int>::create(0)};
+    auto const right{Compute_value<int>::create(0)};
+    std::binary_semaphore entered{0};
+    std::binary_semaphore gate{0};
+    std::atomic<bool> blocked{false};
+    // invalidated first, holding the commit up while it computes
+    auto const blocker{Function::create(
+        [&entered, &gate, &blocked](int value) {
+          if (!blocked.exchange(true)) {
+            entered.release();
+            gate.acquire();
+          }
+          return value;
+        },
+        left)};
+    // caches left, so that it goes stale only once invalidated
+    auto const middle{Function::create([](int value) { return value; }, left)};
+    auto const both{Compute_function<int(int, int)>::create(
+        [](int left_value, int right_value) {
+          return left_value == right_value ? left_value : -1;
+        },
+        middle, right)};
+    check((*middle)() == 0);
+    std::jthread const computing{[&blocker] {
+      static_cast<void>((*blocker)());
+    }};
+    entered.acquire();
+    std::jthread const committing{[&left, &right] {
+      Compute_transaction transaction{};
+      transaction.stage(*left, 1);
+      transaction.stage(*right, 1);
+      transaction.commit();
+    }};
+    std::this_thread::sleep_for(park_time);
+    // middle still caches 0 while right is 1
+    std::atomic<int> read{0};
+    std::jthread const reading{[&both, &read] {
+      read.store((*both)(), std::memory_order_relaxed);
+    }};
+    std::this_thread::sleep_for(park_time);
+    gate.release();
+    check(wait_until(
+        [&read] { return read.load(std::memory_order_relaxed) != 0; }));
+    check(read.load(std::memory_order_relaxed) == 1 && (*both)() == 1);
+  });
+  // a commit holds up no computation reading other values while it
+  // invalidates dependents
+  tester.run(u8"compute/transaction/unrelated", [] {
+    auto const target{Compute_value<int>::create(0)};
+    auto other{Compute_value<int>::create(0)};
+    while (compute::detail::commit_stripe(*other) ==
+           compute::detail::commit_stripe(*target)) {
+      other = Compute_value<int>::create(0);
+    }
+    std::binary_semaphore entered{0};
+    std::binary_semaphore gate{0};
+    std::atomic<bool> blocked{false};
+    auto const blocker{Function::create(
+        [&entered, &gate, &blocked](int value) {
+          if (!blocked.exchange(true)) {
+            entered.release();
+            gate.acquire();
+          }
+          return value;
+        },
+        target)};
+    std::jthread const computing{[&blocker] {
+      static_cast<void>((*blocker)());
+    }};
+    entered.acquire();
+    std::jthread const committing{[&target] {
+      Compute_transaction transaction{};
+      transaction.stage(*target, 1);
+      transaction.commit();
+    }};
+    std::this_thread::sleep_for(park_time);
+    auto const function{Function::create(plus_one, other)};
+    std::atomic<int> read{0};
+    std::jthread const reading{[&function, &read] {
+      read.store((*function)(), std::memory_order_relaxed);
+    }};
+    auto const unblocked{wait_until(
+        [&read] { return read.load(std::memory_order_relaxed) != 0; })};
+    gate.release();
+    check(unblocked && read.load(std::memory_order_relaxed) == 1);
+  });
+  // a lock-free reader seeing one write of a commit sees the others too
+  tester.run(u8"compute/transaction/snapshot_reader", [] {
+    auto const options{util::Enum_bitset{} | Compute_option::snapshot};
+    auto const left{Compute_value<int>::create(options, 0)};
+    auto const right{Compute_value<int>::create(options, 0)};
+    constexpr static auto commits{2000};
+    std::atomic<bool> torn{false};
+    std::atomic<bool> done{false};
+    std::jthread reading{[&left, &right, &torn, &done] {
+      while (!done.load(std::memory_order_relaxed)) {
+        auto const left_value{(*left)()};
+        if ((*right)() < left_value) {
+          torn.store(true, std::memory_order_relaxed);
+        }
+      }
+    }};
+    for (auto commit{1}; commit <= commits; ++commit) {
+      Compute_transaction transaction{};
+      transaction.stage(*left, commit);
+      transaction.stage(*right, commit);
+      transaction.commit();
+    }
+    done.store(true, std::memory_order_relaxed);
+    reading.join();
+    check(!torn.load(std::memory_order_relaxed));
+  });
+}
+} // namespace detail
+
+void compute_tests(Tester &tester) {
+  detail::async_tests(tester);
+  detail::clone_tests(tester);
+  detail::collection_tests(tester);
+  detail::evaluator_tests(tester);
+  detail::expression_tests(tester);
+  detail::function_tests(tester);
+  detail::graph_tests(tester);
+  detail::handle_tests(tester);
+  detail::inline_function_tests(tester);
+  detail::lock_tests(tester);
+  detail::metrics_tests(tester);
+  detail::out_tests(tester);
+  detail::shared_value_tests(tester);
+  detail::snapshot_tests(tester);
+  detail::trace_tests(tester);
+  detail::transaction_tests(tester);
+}
+} // namespace artccel::core::test
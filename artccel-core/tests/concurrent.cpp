@@ -0,0 +1,462 @@
+#include <array>     // import std::array
+#include <atomic>    // import std::atomic, std::memory_order_relaxed
+#include <chrono>    // import std::chrono::steady_clock
+#include <cstddef>   // import std::size_t
+#include <cstdint>   // import std::uint_fast64_t
+#include <latch>     // import std::latch
+#include <mutex>     // import std::lock_guard
+#include <semaphore> // import std::binary_semaphore
+#include <span>      // import std::span
+#include <stdexcept> // import std::runtime_error
+#include <string>    // import std::string
+#include <thread>    // import std::jthread, std::this_thread::sleep_for, std::this_thread::yield
+#include <vector>    // import std::vector
+
+#include "harness.hpp" // interface
+
+#include <artccel/core/util/concurrent.hpp> // import util::Result_cell, util::Semiregular_once_flag, util::Snapshot_cell, util::Striped_shared_mutex, util::Task, util::Task_executor, util::Task_group
+
+namespace artccel::core::test {
+namespace detail {
+constexpr std::size_t thread_count{4};
+
+// every word equal, so that a torn read shows as a mismatch
+struct Words {
+  // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+  std::array<std::uint_fast64_t, 4> words_{};
+
+  explicit constexpr Words(std::uint_fast64_t value) noexcept {
+    words_.fill(value);
+  }
+  constexpr auto consistent [[nodiscard]] () const noexcept {
+    for (auto const word : words_) {
+      if (word != words_.front()) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+static void once_flag_tests(Tester &tester) {
+  tester.run(u8"concurrent/once_flag/once", [] {
+    util::Semiregular_once_flag flag{};
+    std::atomic<std::size_t> calls{0};
+    std::atomic<std::size_t> returned_early{0};
+    std::latch start{thread_count};
+    {
+      std::vector<std::jthread> callers{};
+      for (std::size_t thread{0}; thread < thread_count; ++thread) {
+        callers.emplace_back([&flag, &calls, &returned_early, &start] {
+          start.arrive_and_wait();
+          flag.call_once([&calls] {
+            std::this_thread::yield();
+            calls.fetch_add(1, std::memory_order_relaxed);
+          });
+          // whoever returns sees the call done
+          if (!flag.called()) {
+            returned_early.fetch_add(1, std::memory_order_relaxed);
+          }
+        });
+      }
+    }
+    check(calls.load(std::memory_order_relaxed) == 1 &&
+          returned_early.load(std::memory_order_relaxed) == 0);
+    util::Semiregular_once_flag const copy{flag};
+    check(copy.called() && !util::Semiregular_once_flag{}.called());
+  });
+  tester.run(u8"concurrent/once_flag/retry", [] {
+    util::Semiregular_once_flag flag{};
+    std::binary_semaphore entered{0};
+    std::binary_semaphore gate{0};
+    std::atomic<bool> threw{false};
+    std::atomic<bool> retried{false};
+    {
+      std::jthread const failing{[&flag, &entered, &gate, &threw] {
+        try {
+          flag.call_once([&entered, &gate] {
+            entered.release();
+            gate.acquire();
+            throw std::runtime_error{"call"};
+          });
+        } catch (std::runtime_error const &) {
+          threw.store(true, std::memory_order_relaxed);
+        }
+      }};
+      entered.acquire();
+      std::jthread const waiting{[&flag, &retried] {
+        flag.call_once(
+            [&retried] { retried.store(true, std::memory_order_relaxed); });
+      }};
+      std::this_thread::sleep_for(park_time);
+      gate.release();
+    }
+    check(threw.load(std::memory_order_relaxed) &&
+          retried.load(std::memory_order_relaxed) && flag.called());
+  });
+  tester.run(u8"concurrent/once_flag/reset", [] {
+    util::Semiregular_once_flag flag{};
+    std::binary_semaphore entered{0};
+    std::binary_semaphore gate{0};
+    std::atomic<bool> called{false};
+    std::jthread const running{[&flag, &entered, &gate] {
+      flag.call_once([&entered, &gate] {
+        entered.release();
+        gate.acquire();
+      });
+    }};
+    entered.acquire();
+    std::jthread const waiting{[&flag, &called] {
+      flag.call_once(
+          [&called] { called.store(true, std::memory_order_relaxed); });
+    }};
+    std::this_thread::sleep_for(park_time);
+    flag = {};
+    // the waiting caller calls again without waiting for the running one
+    auto const woken{wait_until(
+        [&called] { return called.load(std::memory_order_relaxed); })};
+    gate.release();
+    check(woken);
+  });
+  tester.run(u8"concurrent/once_flag/stale", [] {
+    util::Semiregular_once_flag flag{};
+    std::binary_semaphore entered{0};
+    std::binary_semaphore gate{0};
+    std::atomic<bool> threw{false};
+    {
+      std::jthread const running{[&flag, &entered, &gate, &threw] {
+        try {
+          flag.call_once([&entered, &gate] {
+            entered.release();
+            gate.acquire();
+            throw std::runtime_error{"call"};
+          });
+        } catch (std::runtime_error const &) {
+          threw.store(true, std::memory_order_relaxed);
+        }
+      }};
+      entered.acquire();
+      flag = {};
+      flag.call_once([] {});
+      gate.release();
+    }
+    // the call outlived by the assignment does not undo the later one
+    check(threw.load(std::memory_order_relaxed) && flag.called());
+    auto called{false};
+    flag.call_once([&called] { called = true; });
+    check(!called);
+  });
+}
+
+static void result_cell_tests(Tester &tester) {
+  tester.run(u8"concurrent/result_cell/seqlock", [] {
+    constexpr std::uint_fast64_t writes{100000};
+    util::Result_cell<Words> cell{};
+    check(!cell.ready() && !cell.load());
+    std::atomic<bool> done{false};
+    std::atomic<bool> torn{false};
+    {
+      std::vector<std::jthread> readers{};
+      for (std::size_t thread{0}; thread < thread_count; ++thread) {
+        readers.emplace_back([&cell, &done, &torn] {
+          std::uint_fast64_t last{0};
+          while (!done.load(std::memory_order_relaxed)) {
+            if (auto const words{cell.load()}) {
+              if (!words->consistent() || words->words_.front() < last) {
+                torn.store(true, std::memory_order_relaxed);
+              }
+              last = words->words_.front();
+            }
+          }
+        });
+      }
+      for (std::uint_fast64_t value{1}; value <= writes; ++value) {
+        if (value % 16U == 0U) {
+          cell.retract();
+        }
+        cell.publish(Words{value});
+      }
+      done.store(true, std::memory_order_relaxed);
+    }
+    check(!torn.load(std::memory_order_relaxed));
+    check(cell.ready() && cell.load()->words_.front() == writes);
+    cell.retract();
+    check(!cell.ready() && !cell.load());
+  });
+  tester.run(u8"concurrent/result_cell/epoch", [] {
+    constexpr std::size_t writes{20000};
+    util::Result_cell<std::string> cell{};
+    check(!cell.ready() && !cell.load());
+    std::atomic<bool> done{false};
+    std::atomic<bool> torn{false};
+    {
+      std::vector<std::jthread> readers{};
+      for (std::size_t thread{0}; thread < thread_count; ++thread) {
+        readers.emplace_back([&cell, &done, &torn] {
+          while (!done.load(std::memory_order_relaxed)) {
+            auto const value{cell.load()};
+            if (value && (value->size() != 64 ||
+                          value->find_first_not_of(value->front()) !=
+                              std::string::npos)) {
+              torn.store(true, std::memory_order_relaxed);
+            }
+          }
+        });
+      }
+      for (std::size_t value{1}; value <= writes; ++value) {
+        if (value % 16U == 0U) {
+          cell.retract();
+        }
+        cell.publish(std::string(64, static_cast<char>('0' + value % 10)));
+      }
+      done.store(true, std::memory_order_relaxed);
+    }
+    check(!torn.load(std::memory_order_relaxed));
+    check(cell.load() == std::string(64, static_cast<char>('0' + writes % 10)));
+    cell.retract();
+    check(!cell.ready() && !cell.load());
+  });
+}
+
+static void snapshot_cell_tests(Tester &tester) {
+  tester.run(u8"concurrent/snapshot_cell/seqlock", [] {
+    constexpr std::uint_fast64_t writes{100000};
+    util::Snapshot_cell<Words> cell{Words{0}};
+    std::atomic<bool> done{false};
+    std::atomic<bool> torn{false};
+    {
+      std::vector<std::jthread> readers{};
+      for (std::size_t thread{0}; thread < thread_count; ++thread) {
+        readers.emplace_back([&cell, &done, &torn] {
+          std::uint_fast64_t last{0};
+          while (!done.load(std::memory_order_relaxed)) {
+            auto const words{cell.load()};
+            // a single writer, so reads never go back either
+            if (!words.consistent() || words.words_.front() < last) {
+              torn.store(true, std::memory_order_relaxed);
+            }
+            last = words.words_.front();
+          }
+        });
+      }
+      for (std::uint_fast64_t value{1}; value <= writes; ++value) {
+        cell.store(Words{value});
+      }
+      done.store(true, std::memory_order_relaxed);
+    }
+    check(!torn.load(std::memory_order_relaxed));
+    check(cell.load().words_.front() == writes);
+  });
+  tester.run(u8"concurrent/snapshot_cell/pointer", [] {
+    constexpr std::size_t writes{20000};
+    util::Snapshot_cell<std::string> cell{std::string(64, '0')};
+    std::atomic<bool> done{false};
+    std::atomic<bool> torn{false};
+    {
+      std::vector<std::jthread> readers{};
+      for (std::size_t thread{0}; thread < thread_count; ++thread) {
+        readers.emplace_back([&cell, &done, &torn] {
+          while (!done.load(std::memory_order_relaxed)) {
+            auto const value{cell.load()};
+            if (value.size() != 64 ||
+                value.find_first_not_of(value.front()) != std::string::npos) {
+              torn.store(true, std::memory_order_relaxed);
+            }
+          }
+        });
+      }
+      for (std::size_t value{1}; value <= writes; ++value) {
+        cell.store(std::string(64, static_cast<char>('0' + value % 10)));
+      }
+      done.store(true, std::memory_order_relaxed);
+    }
+    check(!torn.load(std::memory_order_relaxed));
+    check(cell.load() == std::string(64, static_cast<char>('0' + writes % 10)));
+  });
+}
+
+static void striped_mutex_tests(Tester &tester) {
+  tester.run(u8"concurrent/striped_mutex/exclusion", [] {
+    constexpr std::uint_fast64_t writes{2000};
+    util::Striped_shared_mutex mutex{};
+    Words words{0}; // guarded by mutex
+    std::atomic<std::size_t> readers_inside{0};
+    std::atomic<bool> writer_inside{false};
+    std::atomic<bool> done{false};
+    std::atomic<bool> overlapped{false};
+    std::atomic<bool> torn{false};
+    {
+      std::vector<std::jthread> readers{};
+      for (std::size_t thread{0}; thread < thread_count; ++thread) {
+        readers.emplace_back([&mutex, &words, &readers_inside, &writer_inside,
+                              &done, &overlapped, &torn, thread] {
+          while (!done.load(std::memory_order_relaxed)) {
+            // half of the readers take turns with the timed lock
+            if (thread % 2 == 0) {
+              mutex.lock_shared();
+            } else if (!mutex.try_lock_shared_for(park_time)) {
+              continue;
+            }
+            readers_inside.fetch_add(1, std::memory_order_relaxed);
+            if (writer_inside.load(std::memory_order_relaxed)) {
+              overlapped.store(true, std::memory_order_relaxed);
+            }
+            if (!words.consistent()) {
+              torn.store(true, std::memory_order_relaxed);
+            }
+            readers_inside.fetch_sub(1, std::memory_order_relaxed);
+            mutex.unlock_shared();
+          }
+        });
+      }
+      for (std::uint_fast64_t value{1}; value <= writes; ++value) {
+        std::lock_guard const guard{mutex};
+        writer_inside.store(true, std::memory_order_relaxed);
+        if (readers_inside.load(std::memory_order_relaxed) != 0) {
+          overlapped.store(true, std::memory_order_relaxed);
+        }
+        words = Words{value};
+        writer_inside.store(false, std::memory_order_relaxed);
+      }
+      done.store(true, std::memory_order_relaxed);
+    }
+    check(!overlapped.load(std::memory_order_relaxed) &&
+          !torn.load(std::memory_order_relaxed));
+    check(words.words_.front() == writes);
+  });
+  tester.run(u8"concurrent/striped_mutex/timeout", [] {
+    util::Striped_shared_mutex mutex{};
+    std::atomic<bool> locked{true};
+    std::atomic<bool> waited{false};
+    mutex.lock();
+    {
+      std::jthread const reader{[&mutex, &locked, &waited] {
+        auto const start{std::chrono::steady_clock::now()};
+        locked.store(mutex.try_lock_shared_until(start + park_time),
+                     std::memory_order_relaxed);
+        waited.store(std::chrono::steady_clock::now() - start >= park_time,
+                     std::memory_order_relaxed);
+      }};
+    }
+    mutex.unlock();
+    check(!locked.load(std::memory_order_relaxed) &&
+          waited.load(std::memory_order_relaxed));
+    // a reader held keeps a writer out until its time is up, and no longer
+    check(mutex.try_lock_shared_for(park_time));
+    {
+      std::jthread const writer{[&mutex, &locked] {
+        locked.store(mutex.try_lock_for(park_time), std::memory_order_relaxed);
+      }};
+    }
+    check(!locked.load(std::memory_order_relaxed));
+    mutex.unlock_shared();
+    check(mutex.try_lock());
+    mutex.unlock();
+  });
+}
+
+// adds its value to a sum, resubmitting itself through group while rounds
+// remain, so that workers submit too
+class Summing_task final : public util::Task {
+private:
+  util::Task_group *group_{nullptr};
+  std::atomic<std::size_t> *sum_{nullptr};
+  std::size_t value_{0};
+  std::size_t rounds_{0};
+
+public:
+  void bind(util::Task_group &group, std::atomic<std::size_t> &sum,
+            std::size_t value, std::size_t rounds) noexcept {
+    group_ = &group;
+    sum_ = &sum;
+    value_ = value;
+    rounds_ = rounds;
+  }
+  void run() override {
+    sum_->fetch_add(value_, std::memory_order_relaxed);
+    if (--rounds_ != 0) {
+      group_->submit(*this);
+    }
+  }
+};
+
+static void task_executor_tests(Tester &tester) {
+  tester.run(u8"concurrent/executor/sum", [] {
+    constexpr std::size_t count{1000};
+    util::Task_executor executor{thread_count};
+    std::atomic<std::size_t> sum{0};
+    util::Task_group group{executor};
+    for (std::size_t value{0}; value < count; ++value) {
+      // half of the tasks are submitted by workers
+      group.submit([&group, &sum, value] {
+        sum.fetch_add(value, std::memory_order_relaxed);
+        group.submit([&sum, value] {
+          sum.fetch_add(value + count, std::memory_order_relaxed);
+        });
+      });
+    }
+    group.wait();
+    check(sum.load(std::memory_order_relaxed) == count * (2 * count - 1));
+  });
+  tester.run(u8"concurrent/executor/batch", [] {
+    constexpr std::size_t count{1000};
+    constexpr std::size_t rounds{3};
+    util::Task_executor executor{thread_count};
+    std::atomic<std::size_t> sum{0};
+    std::vector<Summing_task> tasks(count);
+    std::vector<util::Task *> batch{};
+    util::Task_group group{executor};
+    for (std::size_t value{0}; value < count; ++value) {
+      tasks[value].bind(group, sum, value, rounds);
+      batch.emplace_back(&tasks[value]);
+    }
+    group.submit(std::span<util::Task *const>{batch});
+    group.wait();
+    check(sum.load(std::memory_order_relaxed) ==
+          rounds * count * (count - 1) / 2);
+    // the tasks are reused once run
+    tasks.front().bind(group, sum, count, 1);
+    group.submit(tasks.front());
+    group.wait();
+    check(sum.load(std::memory_order_relaxed) ==
+          rounds * count * (count - 1) / 2 + count);
+  });
+  tester.run(u8"concurrent/executor/throw", [] {
+    util::Task_executor executor{thread_count};
+    std::atomic<std::size_t> runs{0};
+    util::Task_group group{executor};
+    for (std::size_t index{0}; index < thread_count; ++index) {
+      group.submit([&runs] { runs.fetch_add(1, std::memory_order_relaxed); });
+    }
+    group.submit([] { throw std::runtime_error{"executor"}; });
+    check_throws<std::runtime_error>([&group] { group.wait(); });
+    check(runs.load(std::memory_order_relaxed) == thread_count);
+  });
+  tester.run(u8"concurrent/executor/wake", [] {
+    util::Task_executor executor{1};
+    std::atomic<bool> ran{false};
+    // the worker has nothing to do, and sleeps
+    std::this_thread::sleep_for(park_time);
+    executor.submit([&ran] { ran.store(true, std::memory_order_relaxed); });
+    check(wait_until([&ran] { return ran.load(std::memory_order_relaxed); }));
+  });
+  tester.run(u8"concurrent/executor/inline", [] {
+    util::Task_executor executor{0};
+    std::size_t runs{0};
+    executor.submit([&runs] { ++runs; });
+    executor.submit([&runs] { ++runs; });
+    check(executor.concurrency() == 0 && runs == 0);
+    check(executor.run_one() && executor.run_one() && !executor.run_one());
+    check(runs == 2);
+  });
+}
+} // namespace detail
+
+void concurrent_tests(Tester &tester) {
+  detail::once_flag_tests(tester);
+  detail::result_cell_tests(tester);
+  detail::snapshot_cell_tests(tester);
+  detail::striped_mutex_tests(tester);
+  detail::task_executor_tests(tester);
+}
+} // namespace artccel::core::test
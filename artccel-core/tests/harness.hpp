@@ -0,0 +1,83 @@
+#pragma once
+#ifndef GUARD_2B8E5D19_A47C_4E03_9F61_C3D07A2E84B6
+#define GUARD_2B8E5D19_A47C_4E03_9F61_C3D07A2E84B6
+
+#include <chrono> // import std::chrono::milliseconds, std::chrono::seconds, std::chrono::steady_clock
+#include <concepts>         // import std::invocable, std::predicate
+#include <cstddef>          // import std::size_t
+#include <exception>        // import std::exception
+#include <source_location>  // import std::source_location
+#include <stdexcept>        // import std::logic_error
+#include <string>           // import std::string, std::to_string
+#include <string_view>      // import std::u8string_view
+#include <thread>           // import std::this_thread::yield
+
+namespace artccel::core::test {
+struct Check_failure;
+class Tester;
+
+struct Check_failure : std::logic_error {
+  using std::logic_error::logic_error;
+};
+
+// throws Check_failure naming the call site unless condition holds
+inline void check(bool condition, std::source_location location =
+                                      std::source_location::current()) {
+  if (!condition) {
+    throw Check_failure{std::string{location.file_name()} + ':' +
+                        std::to_string(location.line()) + ": check failed"};
+  }
+}
+// throws Check_failure unless func throws Exception
+template <typename Exception, std::invocable Func>
+void check_throws(Func &&func, std::source_location location =
+                                   std::source_location::current()) {
+  try {
+    func();
+  } catch (Exception const &) {
+    return;
+  }
+  check(false, location);
+}
+
+// long enough for another thread to block, in all likelihood
+constexpr std::chrono::milliseconds park_time{50};
+// polls done until it holds or a generous deadline passes, so that a missed
+// wake-up fails instead of hanging the check
+template <std::predicate Predicate>
+auto wait_until [[nodiscard]] (Predicate const &done) -> bool {
+  auto const deadline{std::chrono::steady_clock::now() +
+                      std::chrono::seconds{10}};
+  while (!done() && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::yield();
+  }
+  return done();
+}
+
+class Tester {
+private:
+  std::size_t failures_{0};
+
+public:
+  // a test fails by throwing, the others still run
+  template <std::invocable Test>
+  void run(std::u8string_view name, Test const &test) {
+    try {
+      test();
+    } catch (std::exception const &exc) {
+      ++failures_;
+      report(name, exc.what());
+    }
+  }
+  auto failures [[nodiscard]] () const noexcept { return failures_; }
+
+private:
+  static void report(std::u8string_view name, char const *what);
+};
+
+void compute_tests(Tester &tester);
+void concurrent_tests(Tester &tester);
+void queue_tests(Tester &tester);
+} // namespace artccel::core::test
+
+#endif
@@ -1,12 +1,27 @@
-#include <cstdlib> // import EXIT_SUCCESS
-#include <memory>  // import std::make_shared
+#include <cstdlib>     // import EXIT_FAILURE, EXIT_SUCCESS
+#include <iostream>    // import std::cerr, std::flush
+#include <memory>      // import std::make_shared
+#include <string_view> // import std::u8string_view
 
 #pragma warning(push)
 #pragma warning(disable : 4626 4820)
 #include <gsl/gsl> // import gsl::wzstring, gsl::zstring
 #pragma warning(pop)
 
+#include "harness.hpp" // interface
+
 #include <artccel/core/main_hooks.hpp> // import Main_program, Raw_arguments, artccel::core::f::safe_main
+#include <artccel/core/util/encoding.hpp> // import util::literals::encoding::operator""_as_utf8_compat, util::operators::utf8_compat::ostream::operator<<
+
+namespace artccel::core::test {
+using util::literals::encoding::operator""_as_utf8_compat;
+using util::operators::utf8_compat::ostream::operator<<;
+
+void Tester::report(std::u8string_view name, char const *what) {
+  std::cerr << name << u8": "_as_utf8_compat << what
+            << u8'\n'_as_utf8_compat << std::flush;
+}
+} // namespace artccel::core::test
 
 namespace detail {
 // NOLINTNEXTLINE(google-build-using-namespace)
@@ -16,7 +31,11 @@ static auto main_0(artccel::core::Raw_arguments arguments) -> int {
   auto const program_dtor_excs{std::make_shared<
       typename Main_program::destructor_exceptions_out_type>()};
   Main_program const program [[maybe_unused]]{arguments, program_dtor_excs};
-  return EXIT_SUCCESS;
+  test::Tester tester{};
+  test::compute_tests(tester);
+  test::concurrent_tests(tester);
+  test::queue_tests(tester);
+  return tester.failures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 } // namespace detail
 
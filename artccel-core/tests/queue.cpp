@@ -0,0 +1,159 @@
+#include <algorithm> // import std::min
+#include <array>     // import std::array
+#include <atomic>    // import std::atomic, std::memory_order_relaxed
+#include <cstddef>   // import std::size_t
+#include <span>      // import std::span
+#include <thread>    // import std::jthread, std::this_thread::sleep_for
+#include <vector>    // import std::vector
+
+#include "harness.hpp" // interface
+
+#include <artccel/core/util/queue.hpp> // import util::Mpmc_queue, util::Spsc_ring
+
+namespace artccel::core::test {
+namespace detail {
+constexpr std::size_t producer_count{4};
+constexpr std::size_t consumer_count{4};
+
+static void spsc_ring_tests(Tester &tester) {
+  tester.run(u8"queue/spsc/order", [] {
+    constexpr std::size_t count{200000};
+    // small, so that both sides block often
+    util::Spsc_ring<std::size_t> ring{8};
+    std::size_t expected{0};
+    auto ordered{true};
+    {
+      std::jthread const producer{[&ring] {
+        for (std::size_t value{0}; value < count;) {
+          if (value % 2 == 0) {
+            ring.push(value++);
+            continue;
+          }
+          std::array<std::size_t, 5> batch{};
+          auto const size{std::min(batch.size(), count - value)};
+          for (std::size_t index{0}; index < size; ++index) {
+            batch[index] = value++;
+          }
+          ring.push_all(std::span{batch}.first(size));
+        }
+      }};
+      auto const consume{[&expected, &ordered](std::size_t value) {
+        if (value != expected) {
+          ordered = false;
+        }
+        ++expected;
+      }};
+      while (expected < count) {
+        if (expected % 2 == 0) {
+          consume(ring.pop());
+        } else {
+          static_cast<void>(ring.pop_some(4, consume));
+        }
+      }
+    }
+    check(ordered && !ring.try_pop());
+  });
+  tester.run(u8"queue/spsc/wake", [] {
+    util::Spsc_ring<int> ring{2};
+    std::atomic<bool> popped{false};
+    {
+      std::jthread const consumer{[&ring, &popped] {
+        static_cast<void>(ring.pop());
+        popped.store(true, std::memory_order_relaxed);
+      }};
+      std::this_thread::sleep_for(park_time);
+      ring.push(1);
+      check(wait_until(
+          [&popped] { return popped.load(std::memory_order_relaxed); }));
+    }
+    check(ring.try_push(2) && ring.try_push(3) && !ring.try_push(4));
+    std::atomic<bool> pushed{false};
+    std::jthread const producer{[&ring, &pushed] {
+      ring.push(4);
+      pushed.store(true, std::memory_order_relaxed);
+    }};
+    std::this_thread::sleep_for(park_time);
+    check(ring.try_pop() == 2);
+    check(
+        wait_until([&pushed] { return pushed.load(std::memory_order_relaxed); }));
+  });
+}
+
+static void mpmc_queue_tests(Tester &tester) {
+  tester.run(u8"queue/mpmc/sum", [] {
+    constexpr std::size_t per_producer{50000};
+    constexpr std::size_t total{per_producer * producer_count};
+    static_assert(total % consumer_count == 0);
+    util::Mpmc_queue<std::size_t> queue{16};
+    std::atomic<std::size_t> sum{0};
+    std::atomic<bool> ordered{true};
+    {
+      std::vector<std::jthread> threads{};
+      for (std::size_t producer{0}; producer < producer_count; ++producer) {
+        threads.emplace_back([&queue, producer] {
+          for (std::size_t index{0}; index < per_producer; ++index) {
+            queue.push(producer * per_producer + index);
+          }
+        });
+      }
+      for (std::size_t consumer{0}; consumer < consumer_count; ++consumer) {
+        threads.emplace_back([&queue, &sum, &ordered] {
+          // values of one producer arrive in the order pushed, to any one
+          // consumer
+          std::array<std::size_t, producer_count> next{};
+          std::size_t local{0};
+          for (std::size_t count{0}; count < total / consumer_count; ++count) {
+            auto const value{queue.pop()};
+            auto const producer{value / per_producer};
+            auto const index{value % per_producer};
+            if (index < next[producer]) {
+              ordered.store(false, std::memory_order_relaxed);
+            }
+            next[producer] = index + 1;
+            local += value;
+          }
+          sum.fetch_add(local, std::memory_order_relaxed);
+        });
+      }
+    }
+    check(sum.load(std::memory_order_relaxed) == total * (total - 1) / 2);
+    check(ordered.load(std::memory_order_relaxed) && !queue.try_pop());
+  });
+  tester.run(u8"queue/mpmc/wake", [] {
+    util::Mpmc_queue<int> queue{2};
+    std::atomic<std::size_t> popped{0};
+    {
+      std::vector<std::jthread> consumers{};
+      for (std::size_t consumer{0}; consumer < consumer_count; ++consumer) {
+        consumers.emplace_back([&queue, &popped] {
+          static_cast<void>(queue.pop());
+          popped.fetch_add(1, std::memory_order_relaxed);
+        });
+      }
+      std::this_thread::sleep_for(park_time);
+      for (std::size_t consumer{0}; consumer < consumer_count; ++consumer) {
+        queue.push(1);
+      }
+      check(wait_until([&popped] {
+        return popped.load(std::memory_order_relaxed) == consumer_count;
+      }));
+    }
+    check(queue.try_push(2) && queue.try_push(3) && !queue.try_push(4));
+    std::atomic<bool> pushed{false};
+    std::jthread const producer{[&queue, &pushed] {
+      queue.push(4);
+      pushed.store(true, std::memory_order_relaxed);
+    }};
+    std::this_thread::sleep_for(park_time);
+    check(queue.try_pop() == 2);
+    check(
+        wait_until([&pushed] { return pushed.load(std::memory_order_relaxed); }));
+  });
+}
+} // namespace detail
+
+void queue_tests(Tester &tester) {
+  detail::spsc_ring_tests(tester);
+  detail::mpmc_queue_tests(tester);
+}
+} // namespace artccel::core::test
@@ -17,6 +17,7 @@ set(ARTCCEL_EXPORT_NAMESPACE "artccel::" CACHE STRING "Namespace of exported tar
 
 # build
 option(ARTCCEL_INTERPROCEDURAL_OPTIMIZATION "Enable interprocedural optimization if available" true)
+option(ARTCCEL_METRICS "Collect runtime metrics of compute nodes and instrumented locks" false)
 option(ARTCCEL_PROFILE_COMPILATION "Profile compilation time" false)
 option(ARTCCEL_SANITIZE_ADDRESS "Enable address sanitizer" false)
 option(ARTCCEL_SANITIZE_MEMORY "Enable memory sanitizer" false)